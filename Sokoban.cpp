@@ -5,19 +5,20 @@
 #include <cmath>
 #include <fstream>
 #include <iostream>
-#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <utility>
+#include <vector>
+#include "SokobanAssets.hpp"
+#include "SokobanAudio.hpp"
 #include "SokobanConstants.hpp"
 
 namespace SB {
 
-    Sokoban::Sokoban() {
-        loadSound(SOUND_BACKGROUND);
-        loadSound(SOUND_WIN);
-
-        m_font.loadFromFile(FONT_ROBOTO_FILENAME);
+    Sokoban::Sokoban() : m_font(SokobanAssets::instance().font(FONT_ROBOTO_FILENAME)),
+                         m_undoTree(m_arena.resource()), m_jumpPath(m_arena.resource()) {
+        m_deadlockTable.loadFromFile(DEADLOCK_TABLE_FILENAME);
     }
 
     Sokoban::Sokoban(const std::string& filename) : Sokoban() {
@@ -29,29 +30,44 @@ namespace SB {
         ifstream >> *this;
     }
 
+    void Sokoban::load(SokobanLevel level, SokobanLowerBound lowerBound) {
+        m_level = std::move(level);
+
+        // Empty the history so that the previous level's arena can be released with the grids
+        m_undoTree.release();
+        m_jumpPath = std::pmr::vector<int>{ m_arena.resource() };
+        loadTileCharGrid(m_level.width(), m_level.height(), m_level.tileCharGrid());
+        m_lowerBound = std::move(lowerBound);
+        reset();
+    }
+
+    bool Sokoban::loadDeadlockTable(const std::string& filename) {
+        return m_deadlockTable.loadFromFile(filename);
+    }
+
     void Sokoban::movePlayer(const Direction& direction) {
         // If the player has won the game, it can't move anymore
         if (isWon()) {
             return;
         }
 
-        const State state = { m_playerOrientation, m_playerLoc, m_tileCharGrid, m_score };
+        UndoNode edge{};
+        edge.direction = direction;
+        edge.orientationBefore = m_playerOrientation;
+        edge.playerLocBefore = m_playerLoc;
+        edge.scoreBefore = m_score;
+        edge.isFrozenBefore = m_isFrozen;
 
         // Change the player's orientation
         m_playerOrientation = direction;
 
-        // Find the coordinate of the block to move to
-        const auto nextLoc{ getNextLoc(m_playerLoc, direction) };
-
-        // If the next location is out of the map, stay on the spot
-        const auto nextLocIndex = getIndex(nextLoc);
-        if (nextLoc.x < 0 || nextLoc.x >= m_width || nextLocIndex < 0 ||
-            nextLocIndex >= m_width * m_height) {
-            return;
-        }
+        // Find the index of the block to move to. The board is walled in, so the step from the
+        // player never leaves the grid.
+        const auto offset = m_offsets[static_cast<int>(direction)];
+        const auto nextIndex = getIndex(m_playerLoc) + offset;
 
         // Get the texture of the next block
-        const auto nextBlock = getTileChar(nextLoc);
+        const auto nextBlock = tileCharAt(nextIndex);
 
         // If the coordinate corresponds to a wall block or a box storage, stay on the spot
         if (nextBlock == TileChar::Wall) {
@@ -60,38 +76,49 @@ namespace SB {
 
         // If the coordinate corresponds to an box block, try to push the box to the other side
         if (nextBlock == TileChar::Box || nextBlock == TileChar::BoxStorage) {
-            const auto canMoveBox = moveBox(nextLoc, direction);
+            const auto canMoveBox = moveBox(nextIndex, direction);
             if (!canMoveBox) {
                 return;
             }
+
+            // Record the two tiles the push changed
+            const auto boxIndex = nextIndex + offset;
+            const auto boxBlock = tileCharAt(boxIndex);
+            edge.deltaCount = 2;
+            edge.deltas[0] = { nextIndex, nextBlock, tileCharAt(nextIndex) };
+            edge.deltas[1] = { boxIndex,
+                               boxBlock == TileChar::BoxStorage ? TileChar::Storage : TileChar::Empty,
+                               boxBlock };
         }
 
         // Save the current move
-        m_stateStack.push(state);
+        edge.scoreAfter = m_score;
+        edge.isFrozenAfter = m_isFrozen;
+        m_undoTree.record(edge);
 
         // Update player location
-        m_playerLoc = nextLoc;
+        m_playerLoc = getNextLoc(m_playerLoc, direction);
+        log(edge.deltaCount > 0 ? TelemetryEventType::Push : TelemetryEventType::Move, direction);
     }
 
     void Sokoban::reset() {
-        // Reset m_hasWon and m_stateStack
+        // Reset m_hasWon and the move history
         m_hasWon = false;
-        while (!m_stateStack.empty()) {
-            m_stateStack.pop();
-        }
+        m_undoTree.clear();
 
-        // Perform a shallow copy for the tile char grid
-        m_tileCharGrid = m_initialTileCharGrid;
+        // Copy the initial tile char grid into the current one, which keeps its memory
+        resetTileCharGrid();
 
         // Traverse the tile grid
         auto boxCount{ 0 };
         auto storageCount{ 0 };
         auto boxStorageCount{ 0 };
-        traverseTileCharGrid([&](auto coordinate, auto tileChar) {
-            m_tileGrid.push_back(getTile(tileChar));
+        auto playerLoc = m_playerLoc;
+        auto hasPlayer = false;
+        tileCharView().forEachCell([&](const sf::Vector2i coordinate, const TileChar tileChar) {
             if (tileChar == TileChar::Player) {
-                m_playerLoc = coordinate;
-                setTileChar(coordinate, TileChar::Empty);
+                playerLoc = coordinate;
+                hasPlayer = true;
             }
             else if (tileChar == TileChar::Box) {
                 ++boxCount;
@@ -102,9 +129,11 @@ namespace SB {
             else if (tileChar == TileChar::BoxStorage) {
                 ++boxStorageCount;
             }
-
-            return false;
             });
+        if (hasPlayer) {
+            m_playerLoc = playerLoc;
+            setTileChar(m_playerLoc, TileChar::Empty);
+        }
 
         // Set the score and max score
         m_score = boxStorageCount;
@@ -113,41 +142,99 @@ namespace SB {
         // Reset the player's orientation
         m_playerOrientation = DEFAULT_ORIENTATION;
 
+        // Match the boxes to the storages from scratch, and look for boxes frozen from the start
+        m_lowerBound.reset(m_level.initialBoxes());
+        checkDeadlocks();
+
         // Reset the time
         m_elapsedTimeInMicroseconds = 0;
 
-        // Reset the background music
-        if (m_soundMap.find(SOUND_BACKGROUND) != m_soundMap.end()) {
-            m_soundMap.at(SOUND_BACKGROUND).first->play();
-        }
+        // Restart the background music
+        SokobanAudio::instance().playMusic(SOUND_BACKGROUND_FILENAMES);
+        log(TelemetryEventType::Reset, m_playerOrientation);
     }
 
     void Sokoban::undo() {
-        if (isWon() || m_stateStack.size() == 0) {
+        if (isWon() || m_undoTree.current() == SokobanUndoTree::ROOT) {
             return;
         }
 
-        const auto [playerOrientation, playerLoc, tileCharGrid, score] = m_stateStack.top();
-        m_stateStack.pop();
+        const auto& node = m_undoTree.node(m_undoTree.current());
+        applyEdge(node, false);
+        m_undoTree.setCurrent(node.parent);
+        log(TelemetryEventType::Undo, node.direction);
+    }
 
-        m_playerOrientation = playerOrientation;
-        m_playerLoc = playerLoc;
-        m_tileCharGrid = tileCharGrid;
+    void Sokoban::jumpTo(const int nodeId) {
+        const auto ancestor = m_undoTree.commonAncestor(m_undoTree.current(), nodeId);
 
-        m_tileGrid.clear();
-        traverseTileCharGrid([&](auto coordinate, auto tileChar) {
-            m_tileGrid.push_back(getTile(tileChar));
-            if (tileChar == TileChar::Player) {
-                m_playerLoc = coordinate;
-                setTileChar(coordinate, TileChar::Empty);
+        // Walk up from the current node to the common ancestor, reverting each edge
+        for (auto id = m_undoTree.current(); id != ancestor; id = m_undoTree.node(id).parent) {
+            applyEdge(m_undoTree.node(id), false);
+        }
+
+        // Walk down from the common ancestor to the target, replaying each edge. The path is
+        // collected bottom-up, so it is replayed in reverse.
+        m_jumpPath.clear();
+        for (auto id = nodeId; id != ancestor; id = m_undoTree.node(id).parent) {
+            m_jumpPath.push_back(id);
+        }
+        for (auto it = m_jumpPath.rbegin(); it != m_jumpPath.rend(); ++it) {
+            applyEdge(m_undoTree.node(*it), true);
+        }
+
+        m_undoTree.setCurrent(nodeId);
+        m_hasWon = m_hasWon && isWon();
+        log(TelemetryEventType::Jump, m_playerOrientation);
+    }
+
+    const SokobanUndoTree& Sokoban::undoTree() const { return m_undoTree; }
+
+    const SokobanLevel& Sokoban::level() const { return m_level; }
+
+    SearchState Sokoban::searchState() const {
+        // Cells are visited row by row, so the boxes come out in ascending order
+        SearchState state{ {}, m_level.toIndex(m_playerLoc) };
+        tileCharView().forEachCell([&](const sf::Vector2i coordinate, const TileChar tileChar) {
+            if (tileChar == TileChar::Box || tileChar == TileChar::BoxStorage) {
+                state.boxes.push_back(m_level.toIndex(coordinate));
             }
+        });
 
-            return false;
-            });
+        return state;
+    }
+
+    void Sokoban::restore(const SearchState& state) {
+        m_undoTree.clear();
+
+        // Lift the boxes and the player off the initial grid and put them where the state has them
+        resetTileCharGrid();
+        setTileCharAt(m_level.initialPlayer(), TileChar::Empty);
+        for (const auto box : m_level.initialBoxes()) {
+            setTileCharAt(box, m_level.isGoal(box) ? TileChar::Storage : TileChar::Empty);
+        }
+        m_score = 0;
+        for (const auto box : state.boxes) {
+            const auto isGoal = m_level.isGoal(box);
+            setTileCharAt(box, isGoal ? TileChar::BoxStorage : TileChar::Box);
+            m_score += isGoal ? 1 : 0;
+        }
+        m_playerLoc = m_level.toCoordinate(state.player);
+        m_playerOrientation = DEFAULT_ORIENTATION;
 
-        m_score = score;
+        m_lowerBound.reset(state.boxes);
+        m_hasWon = isWon();
+        checkDeadlocks();
     }
 
+    int Sokoban::lowerBound() const { return m_lowerBound.value(); }
+
+    bool Sokoban::isDeadlocked() const {
+        return m_isFrozen || m_lowerBound.value() == SokobanLowerBound::UNREACHABLE;
+    }
+
+    void Sokoban::setTelemetry(SokobanTelemetry* telemetry) { m_telemetry = telemetry; }
+
     void Sokoban::update(const int64_t& dt) {
         if (!isWon()) {
             // If the player has won, don't update the elapsed time
@@ -157,61 +244,58 @@ namespace SB {
         // Check if the player wins the game
         if (!m_hasWon && isWon()) {
             m_hasWon = true;
+            log(TelemetryEventType::Win, m_playerOrientation);
 
             // Stop the background music
-            if (m_soundMap.find(SOUND_BACKGROUND) != m_soundMap.end()) {
-                m_soundMap.at(SOUND_BACKGROUND).first->stop();
-            }
+            SokobanAudio::instance().stopMusic();
 
             // Reset the player's orientation
             m_playerOrientation = DEFAULT_ORIENTATION;
 
             // Play the win sound effect
-            if (m_soundMap.find(SOUND_WIN) != m_soundMap.end()) {
-                m_soundMap.at(SOUND_WIN).first->play();
-            }
+            SokobanAudio::instance().playEffect(SOUND_WIN);
         }
     }
 
-    std::ifstream& operator>>(std::ifstream& ifstream, Sokoban& sokoban) {
-        sokoban.m_initialTileCharGrid.clear();
-
-        // The first line consists of height and width; ignore the rest of the line
-        ifstream >> sokoban.m_height >> sokoban.m_width;
-        ifstream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-
-        // Continue the read the following lines
-        for (int row{ 0 }; row < sokoban.m_height; ++row) {
-            std::string line;
-            getline(ifstream, line);
-            for (int col{ 0 }; col < sokoban.m_width; ++col) {
-                sokoban.m_initialTileCharGrid.push_back(static_cast<TileChar>(line.at(col)));
-            }
+    void Sokoban::log(const TelemetryEventType type, const Direction direction) {
+        if (m_telemetry == nullptr) {
+            return;
         }
 
-        sokoban.reset();
+        TelemetryEvent event;
+        event.elapsedMicroseconds = m_elapsedTimeInMicroseconds;
+        event.type = type;
+        event.direction = direction;
+        event.x = static_cast<int16_t>(m_playerLoc.x);
+        event.y = static_cast<int16_t>(m_playerLoc.y);
+        event.score = static_cast<int16_t>(m_score);
+        m_telemetry->record(event);
+    }
+
+    std::ifstream& operator>>(std::ifstream& ifstream, Sokoban& sokoban) {
+        SokobanLevel level;
+        ifstream >> level;
+        SokobanLowerBound lowerBound{ level };
+        sokoban.load(std::move(level), std::move(lowerBound));
 
         return ifstream;
     }
 
     std::ofstream& operator<<(std::ofstream& ofstream, const Sokoban& sokoban) {
-        ofstream << sokoban.height() << sokoban.width();
+        ofstream << sokoban.height() << " " << sokoban.width();
 
+        const auto view = sokoban.tileCharView();
         const auto player_loc = sokoban.m_playerLoc;
-        sokoban.traverseTileCharGrid([&](auto coordinate, auto tileChar) {
-            if (coordinate.x == 0) {
-                ofstream << std::endl;
+        for (int y{ 0 }; y < view.height(); ++y) {
+            const auto row = view.row(y);
+            std::string line(row.size(), 0);
+            std::transform(row.begin(), row.end(), line.begin(),
+                [](const TileChar tileChar) { return static_cast<char>(tileChar); });
+            if (y == player_loc.y) {
+                line[player_loc.x] = static_cast<char>(TileChar::Player);
             }
-
-            if (coordinate == player_loc) {
-                ofstream << static_cast<char>(TileChar::Player);
-            }
-            else {
-                ofstream << static_cast<char>(tileChar);
-            }
-
-            return false;
-            });
+            ofstream << std::endl << line;
+        }
 
         return ofstream;
     }
@@ -248,28 +332,24 @@ namespace SB {
         return nextLoc;
     }
 
-    bool Sokoban::moveBox(const sf::Vector2i& fromCoordinate, const Direction& direction) {
-        const auto toCoordinate{ getNextLoc(fromCoordinate, direction) };
-
-        // If the destination coordinate is out of the map, return false
-        const auto toCoordinateIndex = getIndex(toCoordinate);
-        if (toCoordinate.x < 0 || toCoordinate.x >= m_width || toCoordinateIndex < 0 ||
-            toCoordinateIndex >= m_width * m_height) {
-            return false;
-        }
+    bool Sokoban::moveBox(const int from, const Direction& direction) {
+        // A box is never on the border, so the cell beyond it is always in the grid
+        const auto to = from + m_offsets[static_cast<int>(direction)];
 
-        const auto currentBlock{ getTileChar(fromCoordinate) };
-        const auto nextBlock{ getTileChar(toCoordinate) };
+        const auto currentBlock{ tileCharAt(from) };
+        const auto nextBlock{ tileCharAt(to) };
         const auto isCurrentBlockBoxStorage = currentBlock == TileChar::BoxStorage;
 
         if (nextBlock == TileChar::Empty) {
             // Swap the blocks at the initial coordiante and the destination coordinate
-            setTileChar(fromCoordinate, isCurrentBlockBoxStorage ? TileChar::Storage : TileChar::Empty);
-            setTileChar(toCoordinate, TileChar::Box);
+            setTileCharAt(from, isCurrentBlockBoxStorage ? TileChar::Storage : TileChar::Empty);
+            setTileCharAt(to, TileChar::Box);
 
             if (isCurrentBlockBoxStorage)
                 --m_score;
 
+            m_lowerBound.moveBox(from, to);
+            m_isFrozen = m_isFrozen || isFrozenAround(to);
             return true;
         }
 
@@ -277,33 +357,75 @@ namespace SB {
             // The block at the initial coordiante should become an empty block (or a storage block if
             // the current block is a box-storage block); the block at the destination coordinate should
             // become a box-storage block
-            setTileChar(fromCoordinate, isCurrentBlockBoxStorage ? TileChar::Storage : TileChar::Empty);
-            setTileChar(toCoordinate, TileChar::BoxStorage);
+            setTileCharAt(from, isCurrentBlockBoxStorage ? TileChar::Storage : TileChar::Empty);
+            setTileCharAt(to, TileChar::BoxStorage);
 
             // Score increments by 1
             if (!isCurrentBlockBoxStorage)
                 ++m_score;
 
+            m_lowerBound.moveBox(from, to);
+            m_isFrozen = m_isFrozen || isFrozenAround(to);
             return true;
         }
 
         return false;
     }
 
-    void Sokoban::loadSound(const std::string& soundFilename) {
-        const auto soundBuffer{ std::make_shared<sf::SoundBuffer>() };
-        const auto sound{ std::make_shared<sf::Sound>() };
-        if (soundBuffer->loadFromFile(soundFilename)) {
-            sound->setBuffer(*soundBuffer);
-            m_soundMap[soundFilename] = std::make_pair(sound, soundBuffer);
+    void Sokoban::applyEdge(const UndoNode& node, const bool forward) {
+        for (int i{ 0 }; i < node.deltaCount; ++i) {
+            const auto& [index, before, after] = node.deltas[i];
+            setTileCharAt(index, forward ? after : before);
+        }
+
+        // A push moved a box from the first delta's cell to the second's
+        if (node.deltaCount == 2) {
+            const auto from = node.deltas[forward ? 0 : 1].index;
+            const auto to = node.deltas[forward ? 1 : 0].index;
+            m_lowerBound.moveBox(from, to);
+        }
+
+        if (forward) {
+            m_playerOrientation = node.direction;
+            m_playerLoc = getNextLoc(node.playerLocBefore, node.direction);
+            m_score = node.scoreAfter;
+            m_isFrozen = node.isFrozenAfter;
         }
+        else {
+            m_playerOrientation = node.orientationBefore;
+            m_playerLoc = node.playerLocBefore;
+            m_score = node.scoreBefore;
+            m_isFrozen = node.isFrozenBefore;
+        }
+    }
+
+    bool Sokoban::isFrozenAround(const int index) const {
+        // Surplus boxes may be left anywhere, so only more frozen boxes than that is a deadlock
+        const auto boxCount = static_cast<int>(m_level.initialBoxes().size());
+        const auto goalCount = static_cast<int>(m_level.goals().size());
+        const auto frozenBoxCount = m_deadlockTable.frozenBoxCount(m_level,
+            index, [this](const int cell) {
+                const auto tileChar = tileCharAt(cell);
+                return tileChar == TileChar::Box || tileChar == TileChar::BoxStorage;
+            });
+
+        return frozenBoxCount > std::max(boxCount - goalCount, 0);
+    }
+
+    void Sokoban::checkDeadlocks() {
+        m_isFrozen = false;
+        tileCharView().forEachCell([&](const sf::Vector2i coordinate, const TileChar tileChar) {
+            if (!m_isFrozen && (tileChar == TileChar::Box || tileChar == TileChar::BoxStorage)) {
+                m_isFrozen = isFrozenAround(m_level.toIndex(coordinate));
+            }
+        });
     }
 
     void Sokoban::drawResultScreen(sf::RenderTarget& target, sf::RenderStates states) const {
         // Draw "You win!" in the center of the screen
         sf::Text winText;
         winText.setString("You win!");
-        winText.setFont(m_font);
+        winText.setFont(*m_font);
         winText.setFillColor(sf::Color(255, 140, 0));
         winText.setCharacterSize(15 * m_width);
         winText.setOutlineColor(sf::Color::White);
@@ -319,7 +441,7 @@ namespace SB {
         target.draw(winText);
 
         // Final score
-        const auto moveScore = m_width * m_height - m_stateStack.size();
+        const auto moveScore = m_width * m_height - m_undoTree.node(m_undoTree.current()).depth;
         const auto timeInSeconds = static_cast<double>(m_elapsedTimeInMicroseconds) / 1000000.0;
         const auto timeScore = std::exp(1 - timeInSeconds / std::exp(2));
         const auto finalScore = static_cast<int>(std::floor(moveScore * timeScore * m_score));
@@ -327,7 +449,7 @@ namespace SB {
         // Draw the score down below the "You win!"
         sf::Text scoreText;
         scoreText.setString("Score: " + std::to_string(finalScore));
-        scoreText.setFont(m_font);
+        scoreText.setFont(*m_font);
         scoreText.setFillColor(sf::Color::Black);
         scoreText.setCharacterSize(3 * m_width);
         scoreText.setOutlineColor(sf::Color::White);
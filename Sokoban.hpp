@@ -5,31 +5,25 @@
 
 #include <functional>
 #include <memory>
-#include <stack>
+#include <memory_resource>
 #include <string>
-#include <unordered_map>
 #include <utility>
 #include <vector>
-#include <SFML/Audio.hpp>
 #include <SFML/Graphics.hpp>
 #include "SokobanConstants.hpp"
+#include "SokobanDeadlockTable.hpp"
 #include "SokobanElapsedTime.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanLowerBound.hpp"
 #include "SokobanPlayer.hpp"
 #include "SokobanScore.hpp"
+#include "SokobanSearch.hpp"
+#include "SokobanTelemetry.hpp"
 #include "SokobanTileGrid.hpp"
+#include "SokobanUndoTree.hpp"
 
 namespace SB {
 
-    /**
-     * @brief Game state.
-     */
-    struct State {
-        Direction playerOrientation;
-        sf::Vector2i playerLoc;
-        std::vector<TileChar> tileCharGrid;
-        int score;
-    };
-
     /**
      * @brief This class implements all gameplay.
      */
@@ -49,6 +43,22 @@ namespace SB {
          */
         explicit Sokoban(const std::string& filename);
 
+        /**
+         * @brief Replaces the level being played, e.g. with one parsed on another thread, and resets
+         * the game. The textures, fonts and sounds are kept.
+         * @param level The new level.
+         * @param lowerBound The lower bound tables of the new level.
+         */
+        void load(SokobanLevel level, SokobanLowerBound lowerBound);
+
+        /**
+         * @brief Maps a deadlock table other than `DEADLOCK_TABLE_FILENAME`, e.g. one built for a
+         * test. It is used from the next push or reset on.
+         * @param filename The table file, as written by `SokobanDeadlockTable::saveToFile`.
+         * @return False if the table can't be read; the table mapped before is kept then.
+         */
+        bool loadDeadlockTable(const std::string& filename);
+
         /**
          * @brief Changes the player's location for one tile with the given direction.
          * @param direction The direction for the player to move.
@@ -65,6 +75,58 @@ namespace SB {
          */
         void undo();
 
+        /**
+         * @brief Moves the game to any node of the undo tree. The board is restored by undoing edges
+         * up to the common ancestor and replaying edges down to the target, so the cost is
+         * proportional to the depth of the two nodes rather than the size of the board.
+         * @param nodeId The id of the target node.
+         * @throws std::out_of_range if the id does not name a node.
+         */
+        void jumpTo(int nodeId);
+
+        /**
+         * @brief Returns the move history. Use it to list branches and pick a node for `jumpTo`.
+         */
+        [[nodiscard]] const SokobanUndoTree& undoTree() const;
+
+        /**
+         * @brief Returns the static layout of the loaded level.
+         */
+        [[nodiscard]] const SokobanLevel& level() const;
+
+        /**
+         * @brief Returns the current position as the solver sees it, e.g. to search from it on
+         * another thread.
+         */
+        [[nodiscard]] SearchState searchState() const;
+
+        /**
+         * @brief Puts the boxes and the player of the level where a position has them, e.g. to show
+         * a replay. The move history is cleared and the player faces the default way; the elapsed
+         * time runs on. A won position shows the result screen without the win sound.
+         * @param state The position, reached from the level's initial one.
+         */
+        void restore(const SearchState& state);
+
+        /**
+         * @brief Returns a lower bound on the number of pushes still needed to win, or
+         * `SokobanLowerBound::UNREACHABLE` if the position can no longer be won.
+         */
+        [[nodiscard]] int lowerBound() const;
+
+        /**
+         * @brief Returns true if the position can no longer be won: either some storage can't be
+         * reached by any box, or some box froze more boxes off storages than the level can spare.
+         * The second check needs the deadlock table (`DEADLOCK_TABLE_FILENAME`).
+         */
+        [[nodiscard]] bool isDeadlocked() const;
+
+        /**
+         * @brief Sends every move, push, undo, jump, reset and win to a telemetry sink from now on.
+         * @param telemetry The sink, which must outlive the game, or nullptr to stop sending.
+         */
+        void setTelemetry(SokobanTelemetry* telemetry);
+
         /**
          * @brief Updates the game in a game frame.
          * @param dt The delta time in microseconds between this frame and the previous frame.
@@ -97,20 +159,40 @@ namespace SB {
             getNextLoc(const sf::Vector2i& currentLoc, const Direction& orientation);
 
         /**
-         * @brief Moves a box towards a specified direction. Note that the block at the from coordinate
+         * @brief Moves a box towards a specified direction. Note that the block at the from index
          * must be a box. The box that has already been stowed properly can be moved, and when it is
          * moved out from the storage, the score decrement.
-         * @param fromCoordinate The initial coordinate.
+         * @param from The index of the box in the padded grid.
          * @param direction The direction to move the box.
          * @return true if the box can be moved; false otherwise.
          */
-        bool moveBox(const sf::Vector2i& fromCoordinate, const Direction& direction);
+        bool moveBox(int from, const Direction& direction);
+
+        /**
+         * @brief Applies the edge that leads into a node of the undo tree.
+         * @param node The node whose incoming edge to apply.
+         * @param forward True to replay the move; false to revert it.
+         */
+        void applyEdge(const UndoNode& node, bool forward);
 
         /**
-         * @brief Loads a sound file.
-         * @param soundFilename The name of the sound file.
+         * @brief Queries the deadlock table around a box and returns true if it froze more boxes off
+         * storages than the level can spare.
+         * @param index The index of the box in the padded grid.
          */
-        void loadSound(const std::string& soundFilename);
+        [[nodiscard]] bool isFrozenAround(int index) const;
+
+        /**
+         * @brief Recomputes the deadlock flag around every box, after the board was set up from
+         * scratch by a reset or a restore. Undos and jumps take the flag from the undo tree.
+         */
+        void checkDeadlocks();
+
+        /**
+         * @brief Sends an event with the current player tile, score and time to the telemetry sink,
+         * if there is one.
+         */
+        void log(TelemetryEventType type, Direction direction);
 
         /**
          * @brief Draws the result screen: triump message and final score.
@@ -123,23 +205,46 @@ namespace SB {
         bool m_hasWon = false;
 
         /**
-         * @brief The game sound effects, including background music. The keys of this map are sound
-         * filenames.
+         * @brief The font for the triumph message. It is shared and empty until it has loaded.
+         */
+        std::shared_ptr<sf::Font> m_font;
+
+        /**
+         * @brief The static layout of the loaded level.
+         */
+        SokobanLevel m_level;
+
+        /**
+         * @brief The push lower bound, kept up to date on every box move.
+         */
+        SokobanLowerBound m_lowerBound;
+
+        /**
+         * @brief The memory-mapped deadlock pattern table.
+         */
+        SokobanDeadlockTable m_deadlockTable;
+
+        /**
+         * @brief If boxes are frozen off storages beyond the level's surplus. A frozen box never
+         * moves again, so pushes only ever set the flag; undos and jumps restore it from the edges
+         * of the undo tree.
+         */
+        bool m_isFrozen = false;
+
+        /**
+         * @brief The move history.
          */
-        std::unordered_map<
-            std::string,
-            std::pair<std::shared_ptr<sf::Sound>, std::shared_ptr<sf::SoundBuffer>>>
-            m_soundMap;
+        SokobanUndoTree m_undoTree;
 
         /**
-         * @brief The font for the triumph message.
+         * @brief Scratch space for `jumpTo`, kept in the arena so that jumps don't allocate.
          */
-        sf::Font m_font;
+        std::pmr::vector<int> m_jumpPath;
 
         /**
-         * @brief The stack of states.
+         * @brief The telemetry sink, or nullptr.
          */
-        std::stack<State> m_stateStack;
+        SokobanTelemetry* m_telemetry = nullptr;
     };
 
 }  // namespace SB
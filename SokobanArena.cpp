@@ -0,0 +1,17 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanArena.hpp"
+#include <memory_resource>
+
+namespace SB {
+
+    SokobanArena::SokobanArena() : m_buffer(INITIAL_SIZE), m_pool(&m_buffer) {}
+
+    std::pmr::memory_resource* SokobanArena::resource() { return &m_pool; }
+
+    void SokobanArena::release() {
+        m_pool.release();
+        m_buffer.release();
+    }
+
+}  // namespace SB
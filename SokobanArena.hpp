@@ -0,0 +1,58 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANARENA_HPP
+#define SOKOBANARENA_HPP
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace SB {
+
+    /**
+     * @brief The memory of one level. Containers that live as long as a level (the tile grids and
+     * the move history) allocate from a pool on top of a monotonic buffer, so blocks freed while
+     * playing are reused instead of going back to the heap, and the buffer grows in a few large
+     * chunks. Switching levels releases everything in one step.
+     */
+    class SokobanArena {
+    public:
+        /**
+         * @brief The size of the first chunk; enough for the grids and a long history of a typical
+         * level.
+         */
+        static constexpr size_t INITIAL_SIZE = 256 * 1024;
+
+        /**
+         * @brief Creates an empty arena. Nothing is allocated until the first request.
+         */
+        SokobanArena();
+
+        SokobanArena(const SokobanArena&) = delete;
+        SokobanArena& operator=(const SokobanArena&) = delete;
+
+        /**
+         * @brief Returns the resource containers should allocate from.
+         */
+        [[nodiscard]] std::pmr::memory_resource* resource();
+
+        /**
+         * @brief Returns all memory to the heap. Every container using the arena must have been
+         * emptied (and shrunk) first.
+         */
+        void release();
+
+    private:
+        /**
+         * @brief Hands out chunks from the heap and never frees them one by one.
+         */
+        std::pmr::monotonic_buffer_resource m_buffer;
+
+        /**
+         * @brief Recycles freed blocks by size, on top of `m_buffer`.
+         */
+        std::pmr::unsynchronized_pool_resource m_pool;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,170 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanAssets.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SokobanConstants.hpp"
+#include "SokobanParallel.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The most threads that decode assets; the files are few and small.
+         */
+        constexpr unsigned MAX_WORKERS = 4;
+
+    }  // namespace
+
+    SokobanAssets& SokobanAssets::instance() {
+        static SokobanAssets assets;
+        return assets;
+    }
+
+    SokobanAssets::~SokobanAssets() {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_isStopping = true;
+        }
+        m_condition.notify_all();
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    void SokobanAssets::setEnabled(const bool isEnabled) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        m_isEnabled = isEnabled;
+    }
+
+    std::shared_ptr<sf::Texture> SokobanAssets::texture(const std::string& filename,
+        const sf::Color& placeholder) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_isEnabled) {
+            return std::make_shared<sf::Texture>();
+        }
+
+        auto& texture = m_textures[filename];
+        if (texture == nullptr) {
+            // The placeholder has the size of a tile, so sprites keep their texture rect
+            sf::Image image;
+            image.create(TILE_WIDTH, TILE_HEIGHT, placeholder);
+            texture = std::make_shared<sf::Texture>();
+            texture->loadFromImage(image);
+            enqueue(filename, false);
+        }
+
+        return texture;
+    }
+
+    std::shared_ptr<sf::Font> SokobanAssets::font(const std::string& filename) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_isEnabled) {
+            return std::make_shared<sf::Font>();
+        }
+
+        auto& font = m_fonts[filename];
+        if (font == nullptr) {
+            font = std::make_shared<sf::Font>();
+            enqueue(filename, true);
+        }
+
+        return font;
+    }
+
+    int SokobanAssets::update() {
+        std::vector<std::unique_ptr<Job>> done;
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            done.swap(m_done);
+        }
+
+        // Uploading touches the graphics context, so it happens here rather than on a worker
+        int swapped{ 0 };
+        for (auto& job : done) {
+            if (!job->isLoaded) {
+                continue;
+            }
+
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            if (job->isFont) {
+                auto& bytes = m_fontBytes[job->filename];
+                bytes = std::move(job->bytes);
+                m_fonts.at(job->filename)->loadFromMemory(bytes.data(), bytes.size());
+            } else {
+                m_textures.at(job->filename)->loadFromImage(job->image);
+            }
+            ++swapped;
+        }
+
+        return swapped;
+    }
+
+    void SokobanAssets::wait() {
+        {
+            std::unique_lock<std::mutex> lock{ m_mutex };
+            m_condition.wait(lock, [this] { return m_queue.empty() && m_loading == 0; });
+        }
+        update();
+    }
+
+    bool SokobanAssets::isReady() const {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_queue.empty() && m_loading == 0 && m_done.empty();
+    }
+
+    void SokobanAssets::enqueue(const std::string& filename, const bool isFont) {
+        auto job = std::make_unique<Job>();
+        job->filename = filename;
+        job->isFont = isFont;
+        m_queue.push_back(std::move(job));
+
+        const auto busy = static_cast<size_t>(m_loading) + m_queue.size();
+        const auto limit = std::min<size_t>(MAX_WORKERS, defaultThreadCount());
+        if (m_workers.size() < std::min(busy, limit)) {
+            m_workers.emplace_back(&SokobanAssets::work, this);
+        }
+        m_condition.notify_all();
+    }
+
+    void SokobanAssets::work() {
+        for (;;) {
+            std::unique_ptr<Job> job;
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_condition.wait(lock, [this] { return m_isStopping || !m_queue.empty(); });
+                if (m_isStopping) {
+                    return;
+                }
+
+                job = std::move(m_queue.front());
+                m_queue.pop_front();
+                ++m_loading;
+            }
+
+            // Reading and decoding need no graphics context, so they run here
+            if (job->isFont) {
+                std::ifstream file{ job->filename, std::ios::binary };
+                job->bytes.assign(std::istreambuf_iterator<char>{ file }, {});
+                job->isLoaded = file.is_open() && !job->bytes.empty();
+            } else {
+                job->isLoaded = job->image.loadFromFile(job->filename);
+            }
+
+            {
+                const std::lock_guard<std::mutex> lock{ m_mutex };
+                m_done.push_back(std::move(job));
+                --m_loading;
+            }
+            m_condition.notify_all();
+        }
+    }
+
+}  // namespace SB
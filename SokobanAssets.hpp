@@ -0,0 +1,152 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANASSETS_HPP
+#define SOKOBANASSETS_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <SFML/Graphics.hpp>
+
+namespace SB {
+
+    /**
+     * @brief The textures and fonts shared by every game in the process, decoded in the background.
+     *
+     * Asking for an asset returns at once. A texture starts as a flat placeholder of one tile and a
+     * font starts empty, so it draws nothing. Worker threads read and decode the files; `update()`,
+     * called from the thread that draws, copies each decoded asset into the object handed out before,
+     * so sprites and texts that point to it show the real asset from the next frame on. An asset that
+     * fails to load keeps its placeholder.
+     *
+     * Front ends without a window turn loading off; assets asked for then stay empty, and nothing
+     * touches the graphics context.
+     */
+    class SokobanAssets {
+    public:
+        /**
+         * @brief Returns the shared assets.
+         */
+        static SokobanAssets& instance();
+
+        SokobanAssets(const SokobanAssets&) = delete;
+        SokobanAssets& operator=(const SokobanAssets&) = delete;
+
+        /**
+         * @brief Stops the workers once the files they are decoding are done.
+         */
+        ~SokobanAssets();
+
+        /**
+         * @brief Turns loading on or off. It applies to assets asked for afterwards.
+         */
+        void setEnabled(bool isEnabled);
+
+        /**
+         * @brief Returns a texture, starting to load it if this is the first request for it.
+         * @param filename The image file.
+         * @param placeholder The color of the placeholder shown until the image is loaded.
+         */
+        std::shared_ptr<sf::Texture> texture(const std::string& filename,
+            const sf::Color& placeholder);
+
+        /**
+         * @brief Returns a font, starting to load it if this is the first request for it.
+         * @param filename The font file.
+         */
+        std::shared_ptr<sf::Font> font(const std::string& filename);
+
+        /**
+         * @brief Swaps decoded assets in for their placeholders. Call it from the drawing thread.
+         * @return The number of assets swapped in.
+         */
+        int update();
+
+        /**
+         * @brief Blocks until every requested asset is decoded, then swaps them in.
+         */
+        void wait();
+
+        /**
+         * @brief Returns true if no requested asset is still loading or waiting for `update()`.
+         */
+        [[nodiscard]] bool isReady() const;
+
+    private:
+        /**
+         * @brief A file being loaded and, once it is, its contents.
+         */
+        struct Job {
+            std::string filename;
+            bool isFont = false;
+            bool isLoaded = false;
+            sf::Image image;
+            std::vector<char> bytes;
+        };
+
+        SokobanAssets() = default;
+
+        /**
+         * @brief Queues a file and starts a worker if there are fewer than the thread count allows.
+         */
+        void enqueue(const std::string& filename, bool isFont);
+
+        /**
+         * @brief Decodes queued files until the queue is empty or the assets are destroyed.
+         */
+        void work();
+
+        /**
+         * @brief Guards everything below.
+         */
+        mutable std::mutex m_mutex;
+
+        /**
+         * @brief Signaled when a job is queued, a job is done, or the workers should stop.
+         */
+        std::condition_variable m_condition;
+
+        std::unordered_map<std::string, std::shared_ptr<sf::Texture>> m_textures;
+
+        /**
+         * @brief The fonts and the file contents they read from, which must outlive them.
+         */
+        std::unordered_map<std::string, std::shared_ptr<sf::Font>> m_fonts;
+        std::unordered_map<std::string, std::vector<char>> m_fontBytes;
+
+        /**
+         * @brief Files waiting for a worker.
+         */
+        std::deque<std::unique_ptr<Job>> m_queue;
+
+        /**
+         * @brief Files decoded and waiting for `update()`.
+         */
+        std::vector<std::unique_ptr<Job>> m_done;
+
+        /**
+         * @brief The number of files a worker is decoding.
+         */
+        int m_loading = 0;
+
+        /**
+         * @brief If assets are loaded.
+         */
+        bool m_isEnabled = true;
+
+        /**
+         * @brief Set when the workers should stop.
+         */
+        bool m_isStopping = false;
+
+        std::vector<std::thread> m_workers;
+    };
+
+}  // namespace SB
+
+#endif
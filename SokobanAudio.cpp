@@ -0,0 +1,88 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanAudio.hpp"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    SokobanAudio& SokobanAudio::instance() {
+        static SokobanAudio audio;
+        return audio;
+    }
+
+    void SokobanAudio::setEnabled(const bool isEnabled) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        m_isEnabled = isEnabled;
+        if (!isEnabled) {
+            if (m_music != nullptr) {
+                m_music->stop();
+            }
+            for (auto& [filename, effect] : m_effects) {
+                effect->sound.stop();
+            }
+        }
+    }
+
+    bool SokobanAudio::isEnabled() const {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_isEnabled;
+    }
+
+    void SokobanAudio::playMusic(const std::vector<std::string>& filenames) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_isEnabled) {
+            return;
+        }
+
+        // Keep the stream open across resets and sessions; only reopen for other files
+        if (m_music == nullptr || filenames != m_musicFilenames) {
+            m_music = std::make_unique<sf::Music>();
+            m_musicFilenames = filenames;
+            m_isMusicOpen = false;
+            for (const auto& filename : filenames) {
+                if (m_music->openFromFile(filename)) {
+                    m_isMusicOpen = true;
+                    break;
+                }
+            }
+        }
+        if (!m_isMusicOpen) {
+            return;
+        }
+
+        m_music->setLoop(true);
+        m_music->stop();
+        m_music->play();
+    }
+
+    void SokobanAudio::stopMusic() {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (m_music != nullptr) {
+            m_music->stop();
+        }
+    }
+
+    void SokobanAudio::playEffect(const std::string& filename) {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_isEnabled) {
+            return;
+        }
+
+        auto& effect = m_effects[filename];
+        if (effect == nullptr) {
+            effect = std::make_unique<Effect>();
+            effect->isLoaded = effect->buffer.loadFromFile(filename);
+            if (effect->isLoaded) {
+                effect->sound.setBuffer(effect->buffer);
+            }
+        }
+
+        if (effect->isLoaded) {
+            effect->sound.play();
+        }
+    }
+
+}  // namespace SB
@@ -0,0 +1,105 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANAUDIO_HPP
+#define SOKOBANAUDIO_HPP
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SFML/Audio.hpp>
+
+namespace SB {
+
+    /**
+     * @brief The mixer shared by every game session in the process. Music is streamed from disk
+     * through `sf::Music`, so only a small decode buffer is resident; sound effects are decoded into
+     * a buffer the first time they play and kept for later plays. Audio can be switched off for
+     * headless runs, in which case no file is opened at all.
+     */
+    class SokobanAudio {
+    public:
+        /**
+         * @brief Returns the shared mixer.
+         */
+        static SokobanAudio& instance();
+
+        SokobanAudio(const SokobanAudio&) = delete;
+        SokobanAudio& operator=(const SokobanAudio&) = delete;
+
+        /**
+         * @brief Turns audio on or off. Turning it off stops everything that is playing.
+         */
+        void setEnabled(bool isEnabled);
+
+        /**
+         * @brief Returns true if audio is on.
+         */
+        [[nodiscard]] bool isEnabled() const;
+
+        /**
+         * @brief Starts streaming music in a loop, from the beginning. The first of the given files
+         * that opens is used, so a compressed file can be listed before an uncompressed fallback.
+         * @param filenames The candidate music files.
+         */
+        void playMusic(const std::vector<std::string>& filenames);
+
+        /**
+         * @brief Stops the music.
+         */
+        void stopMusic();
+
+        /**
+         * @brief Plays a sound effect, loading it on first use. A file that fails to load is not
+         * tried again.
+         * @param filename The sound file.
+         */
+        void playEffect(const std::string& filename);
+
+    private:
+        /**
+         * @brief A decoded sound effect and the sound that plays it.
+         */
+        struct Effect {
+            sf::SoundBuffer buffer;
+            sf::Sound sound;
+            bool isLoaded = false;
+        };
+
+        SokobanAudio() = default;
+
+        /**
+         * @brief Guards everything below; sessions may live on different threads.
+         */
+        mutable std::mutex m_mutex;
+
+        /**
+         * @brief If audio is on.
+         */
+        bool m_isEnabled = true;
+
+        /**
+         * @brief The music stream, opened on first use.
+         */
+        std::unique_ptr<sf::Music> m_music;
+
+        /**
+         * @brief The candidate files the music stream was opened with.
+         */
+        std::vector<std::string> m_musicFilenames;
+
+        /**
+         * @brief If one of the candidates opened.
+         */
+        bool m_isMusicOpen = false;
+
+        /**
+         * @brief The sound effects played so far, by filename.
+         */
+        std::unordered_map<std::string, std::unique_ptr<Effect>> m_effects;
+    };
+
+}  // namespace SB
+
+#endif
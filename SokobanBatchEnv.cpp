@@ -0,0 +1,264 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanBatchEnv.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "SokobanParallel.hpp"
+
+namespace SB {
+
+    SokobanBatchEnv::SokobanBatchEnv(const SokobanLevel& level, const int count,
+        const unsigned threadCount, const int minBoardsPerThread)
+        : m_count(count), m_width(level.width()), m_height(level.height()), m_size(level.size()),
+          m_walls(level.size()), m_storages(level.size()), m_tiles(level.size(), -1),
+          m_initialBoxes(level.size(), 0), m_initialPlayer(level.initialPlayer()),
+          m_threadCount(threadCount == 0 ? defaultThreadCount() : threadCount) {
+        if (count < 0) {
+            throw std::invalid_argument("Board count must not be negative");
+        }
+        if (minBoardsPerThread < 1) {
+            throw std::invalid_argument("Boards per thread must be at least 1");
+        }
+
+        for (const auto direction : SokobanLevel::DIRECTIONS) {
+            m_offsets[static_cast<int>(direction)] = level.offset(direction);
+        }
+
+        const auto area = m_width * m_height;
+        m_fixedPlanes.assign(2 * static_cast<size_t>(area), 0);
+        for (int index{ 0 }; index < m_size; ++index) {
+            m_walls[index] = level.isWall(index);
+            m_storages[index] = level.isGoal(index);
+        }
+        for (int y{ 0 }; y < m_height; ++y) {
+            for (int x{ 0 }; x < m_width; ++x) {
+                const auto index = level.toIndex({ x, y });
+                const auto tile = y * m_width + x;
+                m_tiles[index] = tile;
+                m_fixedPlanes[tile] = m_walls[index];
+                m_fixedPlanes[area + tile] = m_storages[index];
+            }
+        }
+
+        // The score and the most it can reach are counted as Sokoban counts them
+        for (const auto box : level.initialBoxes()) {
+            m_initialBoxes[box] = 1;
+            m_initialScore += m_storages[box];
+        }
+        m_maxScore = static_cast<int>(std::min(level.goals().size(), level.initialBoxes().size()));
+
+        m_boxes.resize(static_cast<size_t>(count) * m_size);
+        m_players.resize(count);
+        m_scores.resize(count);
+        m_isStale.resize(count);
+        reset();
+
+        // Only as many threads as have enough boards to be worth waking
+        m_threadCount = std::clamp(static_cast<unsigned>(count / minBoardsPerThread), 1u,
+            m_threadCount);
+        for (unsigned thread{ 1 }; thread < m_threadCount; ++thread) {
+            m_workers.emplace_back(&SokobanBatchEnv::work, this, thread);
+        }
+    }
+
+    SokobanBatchEnv::~SokobanBatchEnv() {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_isStopping = true;
+        }
+        m_condition.notify_all();
+
+        for (auto& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    int SokobanBatchEnv::count() const { return m_count; }
+
+    unsigned SokobanBatchEnv::threadCount() const { return m_threadCount; }
+
+    size_t SokobanBatchEnv::observationSize() const {
+        return static_cast<size_t>(PLANE_COUNT) * m_width * m_height;
+    }
+
+    void SokobanBatchEnv::reset() {
+        for (int board{ 0 }; board < m_count; ++board) {
+            reset(board);
+        }
+    }
+
+    void SokobanBatchEnv::reset(const int board) {
+        std::copy(m_initialBoxes.begin(), m_initialBoxes.end(),
+            m_boxes.begin() + static_cast<size_t>(board) * m_size);
+        m_players[board] = m_initialPlayer;
+        m_scores[board] = m_initialScore;
+        m_isStale[board] = 1;
+    }
+
+    void SokobanBatchEnv::step(const uint8_t* actions, float* rewards, uint8_t* dones,
+        uint8_t* observations) {
+        m_actions = actions;
+        m_rewards = rewards;
+        m_dones = dones;
+        m_observations = observations;
+        m_isIncremental = observations != nullptr && observations == m_observed;
+        runShares();
+
+        // Without observations, the buffer last written falls behind the boards
+        m_observed = observations;
+        if (observations != nullptr) {
+            std::fill(m_isStale.begin(), m_isStale.end(), 0);
+        }
+    }
+
+    void SokobanBatchEnv::observe(uint8_t* observations) {
+        for (int board{ 0 }; board < m_count; ++board) {
+            writeObservation(board, observations + board * observationSize());
+        }
+        m_observed = observations;
+        std::fill(m_isStale.begin(), m_isStale.end(), 0);
+    }
+
+    int SokobanBatchEnv::player(const int board) const { return m_players[board]; }
+
+    bool SokobanBatchEnv::isBox(const int board, const int index) const {
+        return m_boxes[static_cast<size_t>(board) * m_size + index] != 0;
+    }
+
+    int SokobanBatchEnv::score(const int board) const { return m_scores[board]; }
+
+    bool SokobanBatchEnv::isDone(const int board) const { return m_scores[board] == m_maxScore; }
+
+    void SokobanBatchEnv::stepRange(const int first, const int last) {
+        const auto area = m_width * m_height;
+        const auto* const walls = m_walls.data();
+        const auto* const storages = m_storages.data();
+        const auto* const tiles = m_tiles.data();
+
+        for (auto board = first; board < last; ++board) {
+            auto* const boxes = m_boxes.data() + static_cast<size_t>(board) * m_size;
+            auto& player = m_players[board];
+            auto& score = m_scores[board];
+            const auto action = m_actions[board];
+            const auto from = player;
+            auto reward = 0;
+            auto box = -1;
+
+            if (score != m_maxScore && action < m_offsets.size()) {
+                // The border is walled, so neither the step nor the push leaves the grid
+                const auto offset = m_offsets[action];
+                const auto next = from + offset;
+                if (!walls[next]) {
+                    if (!boxes[next]) {
+                        player = next;
+                    }
+                    else if (!walls[next + offset] && !boxes[next + offset]) {
+                        box = next;
+                        boxes[next] = 0;
+                        boxes[next + offset] = 1;
+                        reward = storages[next + offset] - storages[next];
+                        score += reward;
+                        player = next;
+                    }
+                }
+            }
+
+            m_rewards[board] = static_cast<float>(reward);
+            m_dones[board] = score == m_maxScore;
+            if (m_observations == nullptr) {
+                continue;
+            }
+
+            auto* const observation =
+                m_observations + static_cast<size_t>(board) * PLANE_COUNT * area;
+            if (!m_isIncremental || m_isStale[board]) {
+                writeObservation(board, observation);
+                continue;
+            }
+            if (player != from) {
+                auto* const playerPlane = observation + static_cast<int>(Plane::Player) * area;
+                playerPlane[tiles[from]] = 0;
+                playerPlane[tiles[player]] = 1;
+            }
+            if (box >= 0) {
+                auto* const boxPlane = observation + static_cast<int>(Plane::Box) * area;
+                boxPlane[tiles[box]] = 0;
+                boxPlane[tiles[box + (player - from)]] = 1;
+            }
+        }
+    }
+
+    void SokobanBatchEnv::writeObservation(const int board, uint8_t* observation) const {
+        const auto area = m_width * m_height;
+        std::memcpy(observation, m_fixedPlanes.data(), m_fixedPlanes.size());
+
+        const auto* const boxes = m_boxes.data() + static_cast<size_t>(board) * m_size;
+        auto* const boxPlane = observation + static_cast<int>(Plane::Box) * area;
+        for (int index{ 0 }; index < m_size; ++index) {
+            if (m_tiles[index] >= 0) {
+                boxPlane[m_tiles[index]] = boxes[index];
+            }
+        }
+
+        auto* const playerPlane = observation + static_cast<int>(Plane::Player) * area;
+        std::fill(playerPlane, playerPlane + area, 0);
+        playerPlane[m_tiles[m_players[board]]] = 1;
+    }
+
+    void SokobanBatchEnv::runShares() {
+        if (m_workers.empty()) {
+            stepRange(0, m_count);
+            return;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            ++m_generation;
+            m_pending = static_cast<unsigned>(m_workers.size());
+        }
+        m_condition.notify_all();
+
+        int first{ 0 };
+        int last{ 0 };
+        share(0, first, last);
+        stepRange(first, last);
+
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_condition.wait(lock, [this] { return m_pending == 0; });
+    }
+
+    void SokobanBatchEnv::share(const unsigned thread, int& first, int& last) const {
+        const auto count = static_cast<int64_t>(m_count);
+        first = static_cast<int>(count * thread / m_threadCount);
+        last = static_cast<int>(count * (thread + 1) / m_threadCount);
+    }
+
+    void SokobanBatchEnv::work(const unsigned thread) {
+        uint64_t generation{ 0 };
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_condition.wait(lock, [&] { return m_isStopping || m_generation != generation; });
+                if (m_isStopping) {
+                    return;
+                }
+                generation = m_generation;
+            }
+
+            int first{ 0 };
+            int last{ 0 };
+            share(thread, first, last);
+            stepRange(first, last);
+
+            {
+                const std::lock_guard<std::mutex> lock{ m_mutex };
+                --m_pending;
+            }
+            m_condition.notify_all();
+        }
+    }
+
+}  // namespace SB
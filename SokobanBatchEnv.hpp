@@ -0,0 +1,229 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANBATCHENV_HPP
+#define SOKOBANBATCHENV_HPP
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Many copies of one level stepped together, for training agents. Nothing is drawn and no
+     * sound is played, so a board is only its box flags, its player cell and its score.
+     *
+     * The boards are stored as structures of arrays: the box flags of all boards in one array, board
+     * after board, and the players and the scores in arrays of their own, while the walls and the
+     * storages are shared. `step()` moves every board by one action and writes the rewards, the done
+     * flags and the observations into buffers the caller owns. Large batches are split between
+     * worker threads that live as long as the environment.
+     */
+    class SokobanBatchEnv {
+    public:
+        /**
+         * @brief The planes of an observation, in order. Each is one byte per tile, row by row,
+         * without the border: 1 where the tile has the feature, 0 elsewhere.
+         */
+        enum class Plane { Wall, Storage, Box, Player };
+
+        /**
+         * @brief The number of planes of an observation.
+         */
+        static constexpr int PLANE_COUNT = 4;
+
+        /**
+         * @brief The fewest boards worth handing to a thread of their own by default; below that,
+         * waking the thread costs more than stepping the boards.
+         */
+        static constexpr int MIN_BOARDS_PER_THREAD = 4096;
+
+        /**
+         * @brief Creates the boards, all at the initial position of the level.
+         * @param level The level.
+         * @param count The number of boards.
+         * @param threadCount The number of threads that step the boards; 0 means
+         * `defaultThreadCount()`. Fewer are used when the boards are too few to share.
+         * @param minBoardsPerThread The fewest boards a thread is given.
+         * @throws std::invalid_argument if the count is negative or the minimum less than 1.
+         */
+        SokobanBatchEnv(const SokobanLevel& level, int count, unsigned threadCount = 0,
+            int minBoardsPerThread = MIN_BOARDS_PER_THREAD);
+
+        SokobanBatchEnv(const SokobanBatchEnv&) = delete;
+        SokobanBatchEnv& operator=(const SokobanBatchEnv&) = delete;
+
+        /**
+         * @brief Stops the worker threads.
+         */
+        ~SokobanBatchEnv();
+
+        /**
+         * @brief Returns the number of boards.
+         */
+        [[nodiscard]] int count() const;
+
+        /**
+         * @brief Returns the number of threads that step the boards, including the caller's.
+         */
+        [[nodiscard]] unsigned threadCount() const;
+
+        /**
+         * @brief Returns the number of bytes of one board's observation: `PLANE_COUNT` planes of
+         * width * height bytes.
+         */
+        [[nodiscard]] size_t observationSize() const;
+
+        /**
+         * @brief Returns every board to the initial position.
+         */
+        void reset();
+
+        /**
+         * @brief Returns one board to the initial position, e.g. once it is done.
+         */
+        void reset(int board);
+
+        /**
+         * @brief Moves the player of every board by one tile, pushing a box as `Sokoban::movePlayer`
+         * does. A board that is done stays as it is.
+         * @param actions One per board: 0 to 3 for the directions in the order of `Direction`; any
+         * other value leaves the board as it is.
+         * @param rewards One per board: the change of the score, i.e. +1 for a box pushed onto a
+         * storage and -1 for a box pushed off one.
+         * @param dones One per board: 1 if the board is won.
+         * @param observations `observationSize()` bytes per board, or null to skip them. When it is
+         * the buffer given to the previous `step()` or `observe()`, only the tiles that changed since
+         * are written; the caller must not have modified it.
+         */
+        void step(const uint8_t* actions, float* rewards, uint8_t* dones, uint8_t* observations);
+
+        /**
+         * @brief Writes the observations of every board.
+         * @param observations `observationSize()` bytes per board.
+         */
+        void observe(uint8_t* observations);
+
+        /**
+         * @brief Returns the player cell of a board, as an index of the level's bordered grid.
+         */
+        [[nodiscard]] int player(int board) const;
+
+        /**
+         * @brief Returns true if a cell of a board holds a box.
+         */
+        [[nodiscard]] bool isBox(int board, int index) const;
+
+        /**
+         * @brief Returns the number of boxes on storages of a board.
+         */
+        [[nodiscard]] int score(int board) const;
+
+        /**
+         * @brief Returns true if a board is won.
+         */
+        [[nodiscard]] bool isDone(int board) const;
+
+    private:
+        /**
+         * @brief Steps the boards [first, last) with the arguments of the running `step()`.
+         */
+        void stepRange(int first, int last);
+
+        /**
+         * @brief Writes the whole observation of a board.
+         */
+        void writeObservation(int board, uint8_t* observation) const;
+
+        /**
+         * @brief Runs `stepRange` on the share of each thread, the caller's included, and returns
+         * when all are done.
+         */
+        void runShares();
+
+        /**
+         * @brief The share of the boards a thread steps.
+         */
+        void share(unsigned thread, int& first, int& last) const;
+
+        /**
+         * @brief Waits for each `step()` and steps a share of the boards.
+         */
+        void work(unsigned thread);
+
+        int m_count;
+        int m_width;
+        int m_height;
+        int m_size;
+        std::array<int, 4> m_offsets{};
+
+        /**
+         * @brief The most boxes on storages, as `Sokoban` counts it; a board with this score is won.
+         */
+        int m_maxScore = 0;
+
+        /**
+         * @brief One flag per cell of the bordered grid, shared by the boards.
+         */
+        std::vector<uint8_t> m_walls;
+        std::vector<uint8_t> m_storages;
+
+        /**
+         * @brief The tile of each cell of the bordered grid in an observation plane, or -1 for the
+         * border.
+         */
+        std::vector<int> m_tiles;
+
+        /**
+         * @brief The wall and storage planes, which are the same for every board.
+         */
+        std::vector<uint8_t> m_fixedPlanes;
+
+        /**
+         * @brief The initial box flags of one board.
+         */
+        std::vector<uint8_t> m_initialBoxes;
+        int m_initialPlayer;
+        int m_initialScore = 0;
+
+        /**
+         * @brief The box flags of every board, `m_size` per board.
+         */
+        std::vector<uint8_t> m_boxes;
+        std::vector<int> m_players;
+        std::vector<int> m_scores;
+
+        /**
+         * @brief One flag per board whose observation must be written in full, e.g. after a reset.
+         */
+        std::vector<uint8_t> m_isStale;
+
+        /**
+         * @brief The buffer the observations were last written into.
+         */
+        const uint8_t* m_observed = nullptr;
+
+        // The arguments of the running step()
+        const uint8_t* m_actions = nullptr;
+        float* m_rewards = nullptr;
+        uint8_t* m_dones = nullptr;
+        uint8_t* m_observations = nullptr;
+        bool m_isIncremental = false;
+
+        unsigned m_threadCount;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        uint64_t m_generation = 0;
+        unsigned m_pending = 0;
+        bool m_isStopping = false;
+        std::vector<std::thread> m_workers;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,168 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanCampaign.hpp"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief Returns a level list after checking it.
+         * @throws std::invalid_argument if the list is empty.
+         */
+        std::vector<std::string> checkFilenames(std::vector<std::string> filenames) {
+            if (filenames.empty()) {
+                throw std::invalid_argument("A campaign needs at least one level");
+            }
+            return filenames;
+        }
+
+    }  // namespace
+
+    SokobanCampaign::SokobanCampaign(std::vector<std::string> filenames)
+        : m_filenames(checkFilenames(std::move(filenames))), m_preparing(0),
+          m_worker(&SokobanCampaign::work, this) {}
+
+    SokobanCampaign::~SokobanCampaign() {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_isStopping = true;
+        }
+        m_condition.notify_all();
+        m_worker.join();
+    }
+
+    int SokobanCampaign::size() const { return static_cast<int>(m_filenames.size()); }
+
+    int SokobanCampaign::index() const { return m_index; }
+
+    const std::string& SokobanCampaign::filename(const int index) const {
+        return m_filenames.at(index);
+    }
+
+    int SokobanCampaign::nextIndex() const { return m_preparing; }
+
+    bool SokobanCampaign::hasNext() const { return m_preparing >= 0; }
+
+    bool SokobanCampaign::isNextReady() const {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        return m_preparing >= 0 && m_isPrepared;
+    }
+
+    void SokobanCampaign::start(Sokoban& sokoban) { take(sokoban); }
+
+    bool SokobanCampaign::advance(Sokoban& sokoban) {
+        if (!hasNext()) {
+            return false;
+        }
+
+        take(sokoban);
+        return true;
+    }
+
+    bool SokobanCampaign::skip() {
+        if (!hasNext()) {
+            return false;
+        }
+
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_preparing = m_preparing + 1 < size() ? m_preparing + 1 : -1;
+            m_isPrepared = false;
+            m_error = nullptr;
+        }
+        m_condition.notify_all();
+        return hasNext();
+    }
+
+    void SokobanCampaign::take(Sokoban& sokoban) {
+        std::unique_lock<std::mutex> lock{ m_mutex };
+        m_condition.wait(lock, [this] { return m_isPrepared; });
+
+        // A level that failed stays prepared with its error, so that it is not read again
+        if (m_error) {
+            std::rethrow_exception(m_error);
+        }
+
+        m_isPrepared = false;
+        auto level = std::move(m_level);
+        auto lowerBound = std::move(m_lowerBound);
+        m_index = m_preparing;
+        m_preparing = m_index + 1 < size() ? m_index + 1 : -1;
+        lock.unlock();
+        m_condition.notify_all();
+
+        sokoban.load(std::move(level), std::move(lowerBound));
+    }
+
+    void SokobanCampaign::work() {
+        while (true) {
+            int index{ 0 };
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_condition.wait(lock,
+                    [this] { return m_isStopping || (m_preparing >= 0 && !m_isPrepared); });
+                if (m_isStopping) {
+                    return;
+                }
+                index = m_preparing;
+            }
+
+            SokobanLevel level;
+            SokobanLowerBound lowerBound;
+            std::exception_ptr error;
+            try {
+                std::ifstream ifstream{ m_filenames[index] };
+                if (!ifstream.is_open()) {
+                    throw std::invalid_argument("File not found: " + m_filenames[index]);
+                }
+                ifstream >> level;
+                lowerBound = SokobanLowerBound(level);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            // A level skipped in the meantime is thrown away
+            {
+                const std::lock_guard<std::mutex> lock{ m_mutex };
+                if (m_preparing != index) {
+                    continue;
+                }
+                m_level = std::move(level);
+                m_lowerBound = std::move(lowerBound);
+                m_error = error;
+                m_isPrepared = true;
+            }
+            m_condition.notify_all();
+        }
+    }
+
+    std::vector<std::string> readLevelList(const std::string& filename) {
+        std::ifstream ifstream{ filename };
+        if (!ifstream.is_open()) {
+            throw std::invalid_argument("File not found: " + filename);
+        }
+
+        const auto directory = std::filesystem::path{ filename }.parent_path();
+        std::vector<std::string> filenames;
+        std::string line;
+        while (std::getline(ifstream, line)) {
+            const auto start = line.find_first_not_of(" \t\r");
+            if (start == std::string::npos || line[start] == '#') {
+                continue;
+            }
+            const std::filesystem::path path{ line.substr(start, line.find_last_not_of(" \t\r") -
+                start + 1) };
+            filenames.push_back((path.is_absolute() ? path : directory / path).string());
+        }
+
+        return filenames;
+    }
+
+}  // namespace SB
@@ -0,0 +1,146 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANCAMPAIGN_HPP
+#define SOKOBANCAMPAIGN_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Sokoban.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanLowerBound.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Plays a list of levels one after another in the same game.
+     *
+     * A worker thread parses the level after the current one, and builds its lower bound tables,
+     * while the current one is played. `advance` then only swaps the prepared level into the game;
+     * the game keeps its window, and the textures, fonts and sounds it shares with every other game.
+     * A level that fails to load throws from the call that would have swapped it in, and keeps
+     * throwing until `skip` moves past it.
+     */
+    class SokobanCampaign {
+    public:
+        /**
+         * @brief Starts preparing the first level.
+         * @param filenames The level files (.lvl), in the order they are played.
+         * @throws std::invalid_argument if the list is empty.
+         */
+        explicit SokobanCampaign(std::vector<std::string> filenames);
+
+        SokobanCampaign(const SokobanCampaign&) = delete;
+        SokobanCampaign& operator=(const SokobanCampaign&) = delete;
+
+        /**
+         * @brief Waits for the level being prepared and joins the worker thread.
+         */
+        ~SokobanCampaign();
+
+        /**
+         * @brief Returns the number of levels.
+         */
+        [[nodiscard]] int size() const;
+
+        /**
+         * @brief Returns the 0-based number of the level being played; -1 before `start`.
+         */
+        [[nodiscard]] int index() const;
+
+        /**
+         * @brief Returns the file of a level.
+         */
+        [[nodiscard]] const std::string& filename(int index) const;
+
+        /**
+         * @brief Returns the 0-based number of the level `advance` loads; -1 if there is none.
+         */
+        [[nodiscard]] int nextIndex() const;
+
+        /**
+         * @brief Returns true if a level follows the one being played.
+         */
+        [[nodiscard]] bool hasNext() const;
+
+        /**
+         * @brief Returns true if the next level is prepared, or failed to load, so that `advance`
+         * returns at once. Never waits for the worker thread.
+         */
+        [[nodiscard]] bool isNextReady() const;
+
+        /**
+         * @brief Loads the first level into a game, waiting for it if it is still being prepared.
+         * @throws What loading the level threw, e.g. std::invalid_argument if the file is not
+         * found; the level is not read again, and the next call throws the same until `skip`.
+         */
+        void start(Sokoban& sokoban);
+
+        /**
+         * @brief Loads the next level into a game, e.g. after a win. This takes no longer than a
+         * frame if the level was prepared in the meantime.
+         * @return False if the last level is being played; the game is left as it is then.
+         * @throws What loading the level threw; the next call throws the same until `skip`.
+         */
+        bool advance(Sokoban& sokoban);
+
+        /**
+         * @brief Drops the next level, e.g. after it failed to load, and starts preparing the one
+         * after it. The game is left as it is.
+         * @return False if no level is left to load.
+         */
+        bool skip();
+
+    private:
+        /**
+         * @brief Waits for the level `m_preparing` and loads it into a game, then starts preparing
+         * the one after it.
+         */
+        void take(Sokoban& sokoban);
+
+        /**
+         * @brief Prepares the requested levels until the campaign is destroyed.
+         */
+        void work();
+
+        const std::vector<std::string> m_filenames;
+        int m_index = -1;
+
+        /**
+         * @brief Guards the members below up to the worker thread.
+         */
+        mutable std::mutex m_mutex;
+        std::condition_variable m_condition;
+
+        /**
+         * @brief The level the worker prepares, or -1 if none; `m_isPrepared` is set once it is.
+         * Only the game's thread writes `m_preparing`, so that thread reads it without the lock.
+         */
+        int m_preparing = -1;
+        bool m_isPrepared = false;
+
+        /**
+         * @brief The prepared level, or the error that stopped it.
+         */
+        SokobanLevel m_level;
+        SokobanLowerBound m_lowerBound;
+        std::exception_ptr m_error;
+
+        bool m_isStopping = false;
+
+        std::thread m_worker;
+    };
+
+    /**
+     * @brief Reads a level list: one level file per line, relative to the list's directory unless
+     * absolute. Blank lines and lines starting with '#' are skipped.
+     * @throws std::invalid_argument if the list file is not found.
+     */
+    [[nodiscard]] std::vector<std::string> readLevelList(const std::string& filename);
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,183 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanCanonical.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SokobanSolution.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief Returns the cell a cell of a width x height grid moves to under a symmetry.
+         */
+        sf::Vector2i transformCell(sf::Vector2i cell, int width, int height, const int symmetry) {
+            if (symmetry >= 4) {
+                cell.x = width - 1 - cell.x;
+            }
+            for (int turn{ 0 }; turn < symmetry % 4; ++turn) {
+                cell = { height - 1 - cell.y, cell.x };
+                std::swap(width, height);
+            }
+
+            return cell;
+        }
+
+        /**
+         * @brief Returns the 64-bit FNV-1a hash of a byte string.
+         */
+        uint64_t fnv1a(const std::string& bytes) {
+            uint64_t hash{ 14695981039346656037ull };
+            for (const auto byte : bytes) {
+                hash ^= static_cast<unsigned char>(byte);
+                hash *= 1099511628211ull;
+            }
+
+            return hash;
+        }
+
+    }  // namespace
+
+    CanonicalLevel canonicalize(const SokobanLevel& level) {
+        // Flood the floor from the player, through boxes, which can always be pushed out of the way
+        // as far as the player's reach is concerned
+        std::vector<char> isKept(level.size(), 0);
+        std::vector<int> queue{ level.initialPlayer() };
+        isKept[level.initialPlayer()] = 1;
+        for (size_t head{ 0 }; head < queue.size(); ++head) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto next = queue[head] + level.offset(direction);
+                if (!level.isWall(next) && !isKept[next]) {
+                    isKept[next] = 1;
+                    queue.push_back(next);
+                }
+            }
+        }
+        for (const auto& cells : { level.goals(), level.initialBoxes() }) {
+            for (const auto cell : cells) {
+                isKept[cell] = 1;
+            }
+        }
+
+        // Trim to the cells kept
+        sf::Vector2i low{ level.width(), level.height() };
+        sf::Vector2i high{ -1, -1 };
+        for (int y{ 0 }; y < level.height(); ++y) {
+            for (int x{ 0 }; x < level.width(); ++x) {
+                if (isKept[level.toIndex({ x, y })]) {
+                    low = { std::min(low.x, x), std::min(low.y, y) };
+                    high = { std::max(high.x, x), std::max(high.y, y) };
+                }
+            }
+        }
+        const auto width = std::max(high.x - low.x + 1, 0);
+        const auto height = std::max(high.y - low.y + 1, 0);
+        std::vector<TileChar> trimmed(static_cast<size_t>(width) * height, TileChar::Wall);
+        for (int y{ 0 }; y < height; ++y) {
+            for (int x{ 0 }; x < width; ++x) {
+                const sf::Vector2i cell{ low.x + x, low.y + y };
+                if (isKept[level.toIndex(cell)]) {
+                    trimmed[y * width + x] = level.tileCharGrid()[cell.y * level.width() + cell.x];
+                }
+            }
+        }
+
+        // Pick the image that comes first, its size included
+        CanonicalLevel canonical;
+        std::string best;
+        std::string image;
+        for (int symmetry{ 0 }; symmetry < SYMMETRY_COUNT; ++symmetry) {
+            const auto isTurned = symmetry % 2 == 1;
+            const auto imageWidth = isTurned ? height : width;
+            const auto imageHeight = isTurned ? width : height;
+            image = std::to_string(imageHeight) + " " + std::to_string(imageWidth) + "\n";
+            const auto header = image.size();
+            image.resize(header + trimmed.size());
+            for (int y{ 0 }; y < height; ++y) {
+                for (int x{ 0 }; x < width; ++x) {
+                    const auto cell = transformCell({ x, y }, width, height, symmetry);
+                    image[header + cell.y * imageWidth + cell.x] =
+                        static_cast<char>(trimmed[y * width + x]);
+                }
+            }
+
+            if (symmetry == 0 || image < best) {
+                best = image;
+                canonical.width = imageWidth;
+                canonical.height = imageHeight;
+                canonical.symmetry = symmetry;
+            }
+        }
+
+        const auto header = best.find('\n') + 1;
+        canonical.tileCharGrid.resize(best.size() - header);
+        std::transform(best.begin() + static_cast<std::ptrdiff_t>(header), best.end(),
+            canonical.tileCharGrid.begin(), [](const char tileChar) {
+                return static_cast<TileChar>(tileChar);
+            });
+        canonical.hash = fnv1a(best);
+        return canonical;
+    }
+
+    Direction transform(const Direction direction, const int symmetry) {
+        sf::Vector2i step{ 0, 0 };
+        switch (direction) {
+        case Direction::Up:
+            step.y = -1;
+            break;
+        case Direction::Down:
+            step.y = 1;
+            break;
+        case Direction::Left:
+            step.x = -1;
+            break;
+        case Direction::Right:
+            step.x = 1;
+            break;
+        }
+
+        if (symmetry >= 4) {
+            step.x = -step.x;
+        }
+        for (int turn{ 0 }; turn < symmetry % 4; ++turn) {
+            step = { -step.y, step.x };
+        }
+
+        if (step.y != 0) {
+            return step.y < 0 ? Direction::Up : Direction::Down;
+        }
+        return step.x < 0 ? Direction::Left : Direction::Right;
+    }
+
+    std::string transform(const std::string& solution, const int symmetry, const bool isInverse) {
+        // Tabulate the four directions, inverting the table if asked
+        std::array<Direction, 4> table{};
+        for (const auto direction : SokobanLevel::DIRECTIONS) {
+            const auto image = transform(direction, symmetry);
+            if (isInverse) {
+                table[static_cast<int>(image)] = direction;
+            }
+            else {
+                table[static_cast<int>(direction)] = image;
+            }
+        }
+
+        std::string transformed;
+        transformed.reserve(solution.size());
+        for (const auto lurd : solution) {
+            if (std::isspace(static_cast<unsigned char>(lurd))) {
+                continue;
+            }
+            const auto isPush = std::isupper(static_cast<unsigned char>(lurd)) != 0;
+            transformed.push_back(toLurd(table[static_cast<int>(fromLurd(lurd))], isPush));
+        }
+
+        return transformed;
+    }
+
+}  // namespace SB
@@ -0,0 +1,67 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANCANONICAL_HPP
+#define SOKOBANCANONICAL_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SokobanConstants.hpp"
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief The number of symmetries of a board: four rotations, each with and without a mirror.
+     */
+    inline constexpr int SYMMETRY_COUNT = 8;
+
+    /**
+     * @brief A level in canonical form: the same for every mirrored or rotated copy of a level, and
+     * for copies that differ only in the walls and floor the player can never reach.
+     */
+    struct CanonicalLevel {
+        int width = 0;
+        int height = 0;
+
+        /**
+         * @brief The tile chars in row-major order.
+         */
+        std::vector<TileChar> tileCharGrid;
+
+        /**
+         * @brief The symmetry that turns the original level into this one; see `transform`.
+         */
+        int symmetry = 0;
+
+        /**
+         * @brief A hash of the canonical tiles, stable across runs and machines.
+         */
+        uint64_t hash = 0;
+    };
+
+    /**
+     * @brief Returns the canonical form of a level. Cells the player can't reach, even by pushing
+     * boxes out of the way, turn into walls unless they hold a box or a storage, and the walls
+     * around the rest are trimmed away. Of the eight symmetric images of what is left, the one whose
+     * tiles come first in byte order is canonical.
+     */
+    [[nodiscard]] CanonicalLevel canonicalize(const SokobanLevel& level);
+
+    /**
+     * @brief Returns the direction a direction becomes under a symmetry. Symmetry s mirrors the
+     * board left to right if s >= 4, then turns it clockwise s % 4 quarter turns.
+     */
+    [[nodiscard]] Direction transform(Direction direction, int symmetry);
+
+    /**
+     * @brief Returns a LURD solution with every move put through a symmetry, or through its inverse.
+     * A solution of a canonical level plays the original level after `transform(solution,
+     * canonical.symmetry, true)`.
+     */
+    [[nodiscard]] std::string transform(const std::string& solution, int symmetry,
+        bool isInverse = false);
+
+}  // namespace SB
+
+#endif
@@ -4,6 +4,7 @@
 #define SOKOBANCONSTANTS_H
 
 #include <string>
+#include <vector>
 
 /**
  * @brief Sokoban game constants. Include but not limit to the following:
@@ -54,6 +55,12 @@ namespace SB {
     // Sound directory
     inline const std::string SOUND_DIR = ASSETS_DIR + "sound/";
 
+    // Deadlock pattern table, built by the deadlockdb program
+    inline const std::string DEADLOCK_TABLE_FILENAME = ASSETS_DIR + "deadlock.tbl";
+
+    // Solutions of the levels solved before, keyed by canonical level hash
+    inline const std::string SOLUTION_CACHE_FILENAME = ASSETS_DIR + "solutions.cache";
+
     // Tiles filenames
     inline const std::string TILE_ENVIRONMENT_03_FILENAME = TILESET_DIR + "environment_03.png";
     inline const std::string TILE_BLOCK_06_FILENAME = TILESET_DIR + "block_06.png";
@@ -69,9 +76,12 @@ namespace SB {
     inline const std::string FONT_DIGITAL7_FILENAME = FONT_DIR + "digital-7.mono.ttf";
     inline const std::string FONT_ROBOTO_FILENAME = FONT_DIR + "roboto-regular.ttf";
 
-    // Sound filenames
+    // Sound filenames. The background music is streamed, so the compressed file is tried first.
+    inline const std::string SOUND_BACKGROUND_OGG = SOUND_DIR + "background.ogg";
     inline const std::string SOUND_BACKGROUND = SOUND_DIR + "background.wav";
     inline const std::string SOUND_WIN = SOUND_DIR + "win.wav";
+    inline const std::vector<std::string> SOUND_BACKGROUND_FILENAMES{ SOUND_BACKGROUND_OGG,
+                                                                     SOUND_BACKGROUND };
 
     /**
      * @brief Enumerates four cardinal directions: Up, Down, Left, and Right. This enumeration follows
@@ -0,0 +1,173 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanDeadlockTable.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The header at the start of a table file.
+         */
+        struct TableHeader {
+            char magic[4];
+            uint32_t version;
+            uint32_t patternCount;
+            uint32_t bitsPerEntry;
+        };
+
+        constexpr char TABLE_MAGIC[4] = { 'S', 'B', 'D', 'T' };
+        constexpr uint32_t TABLE_VERSION = 1;
+        constexpr uint32_t BITS_PER_ENTRY = 2;
+        constexpr size_t TABLE_BYTES =
+            SokobanDeadlockTable::PATTERN_COUNT * BITS_PER_ENTRY / 8;
+
+    }  // namespace
+
+    SokobanDeadlockTable::~SokobanDeadlockTable() {
+        if (m_mapping != nullptr) {
+            munmap(m_mapping, m_mappingSize);
+        }
+    }
+
+    bool SokobanDeadlockTable::loadFromFile(const std::string& filename) {
+        const auto fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat fileStat {};
+        const auto expectedSize = sizeof(TableHeader) + TABLE_BYTES;
+        if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) != expectedSize) {
+            close(fd);
+            return false;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        const auto mapping = mmap(nullptr, expectedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+
+        TableHeader header{};
+        std::memcpy(&header, mapping, sizeof(header));
+        if (std::memcmp(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0 ||
+            header.version != TABLE_VERSION || header.patternCount != PATTERN_COUNT ||
+            header.bitsPerEntry != BITS_PER_ENTRY) {
+            munmap(mapping, expectedSize);
+            return false;
+        }
+
+        if (m_mapping != nullptr) {
+            munmap(m_mapping, m_mappingSize);
+        }
+
+        m_mapping = mapping;
+        m_mappingSize = expectedSize;
+        m_entries = static_cast<const uint8_t*>(mapping) + sizeof(TableHeader);
+
+        return true;
+    }
+
+    bool SokobanDeadlockTable::saveToFile(const std::string& filename) {
+        std::vector<uint8_t> entries(TABLE_BYTES, 0);
+        for (int pattern{ 0 }; pattern < PATTERN_COUNT; ++pattern) {
+            const auto value = static_cast<uint8_t>(evaluate(pattern));
+            entries[pattern / 4] |= static_cast<uint8_t>(value << (pattern % 4 * 2));
+        }
+
+        TableHeader header{};
+        std::memcpy(header.magic, TABLE_MAGIC, sizeof(TABLE_MAGIC));
+        header.version = TABLE_VERSION;
+        header.patternCount = PATTERN_COUNT;
+        header.bitsPerEntry = BITS_PER_ENTRY;
+
+        std::ofstream ofstream{ filename, std::ios::binary };
+        ofstream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofstream.write(reinterpret_cast<const char*>(entries.data()),
+            static_cast<std::streamsize>(entries.size()));
+
+        return static_cast<bool>(ofstream);
+    }
+
+    bool SokobanDeadlockTable::isLoaded() const { return m_entries != nullptr; }
+
+    int SokobanDeadlockTable::evaluate(const int pattern) {
+        // Cells are numbered 0 to 8 in row-major order; cell 4 is the center
+        std::array<int, 9> states{};
+        for (int cell{ 0 }; cell < 9; ++cell) {
+            states[cell] = (pattern >> (cell * 2)) & 3;
+        }
+
+        const auto isBox = [&](const int cell) {
+            return states[cell] == Box || states[cell] == BoxStorage;
+        };
+
+        // Only patterns centered on a box are ever queried
+        if (!isBox(4)) {
+            return 0;
+        }
+
+        // Greatest fixed point: assume every box is frozen, then release any box that has both
+        // neighbors free along some axis. Cells outside the neighborhood count as free.
+        std::array<bool, 9> frozen{};
+        for (int cell{ 0 }; cell < 9; ++cell) {
+            frozen[cell] = isBox(cell);
+        }
+
+        const auto isBlocking = [&](const int row, const int col) {
+            if (row < 0 || row > 2 || col < 0 || col > 2) {
+                return false;
+            }
+
+            const auto cell = row * 3 + col;
+            return states[cell] == Wall || frozen[cell];
+        };
+
+        auto changed = true;
+        while (changed) {
+            changed = false;
+            for (int cell{ 0 }; cell < 9; ++cell) {
+                if (!frozen[cell]) {
+                    continue;
+                }
+
+                const auto row = cell / 3;
+                const auto col = cell % 3;
+                const auto canMoveHorizontally =
+                    !isBlocking(row, col - 1) && !isBlocking(row, col + 1);
+                const auto canMoveVertically =
+                    !isBlocking(row - 1, col) && !isBlocking(row + 1, col);
+                if (canMoveHorizontally || canMoveVertically) {
+                    frozen[cell] = false;
+                    changed = true;
+                }
+            }
+        }
+
+        auto frozenBoxes = 0;
+        for (int cell{ 0 }; cell < 9; ++cell) {
+            if (frozen[cell] && states[cell] == Box) {
+                ++frozenBoxes;
+            }
+        }
+
+        return std::min(frozenBoxes, 3);
+    }
+
+    int SokobanDeadlockTable::lookup(const int pattern) const {
+        return (m_entries[pattern / 4] >> (pattern % 4 * 2)) & 3;
+    }
+
+}  // namespace SB
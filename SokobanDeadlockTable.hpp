@@ -0,0 +1,130 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANDEADLOCKTABLE_HPP
+#define SOKOBANDEADLOCKTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief A precomputed table of freeze deadlocks in the 3x3 neighborhood of a box. Each of the
+     * nine cells is a floor, a wall, a box or a box on a storage, so a neighborhood is an 18-bit
+     * pattern. For every pattern the table stores how many boxes off storages can never move again
+     * (capped at 3), assuming that everything outside the neighborhood is free. The table is built
+     * offline by the `deadlockdb` program and memory-mapped at load time, so nothing is computed per
+     * run.
+     */
+    class SokobanDeadlockTable {
+    public:
+        /**
+         * @brief The number of distinct 3x3 patterns.
+         */
+        static constexpr int PATTERN_COUNT = 1 << 18;
+
+        /**
+         * @brief Creates an empty table. Queries return 0 until a table is loaded.
+         */
+        SokobanDeadlockTable() = default;
+
+        SokobanDeadlockTable(const SokobanDeadlockTable&) = delete;
+        SokobanDeadlockTable& operator=(const SokobanDeadlockTable&) = delete;
+
+        /**
+         * @brief Unmaps the table file.
+         */
+        ~SokobanDeadlockTable();
+
+        /**
+         * @brief Memory-maps a table file built by `saveToFile`.
+         * @param filename The table filename.
+         * @return True if the file exists and has a valid header; false otherwise.
+         */
+        bool loadFromFile(const std::string& filename);
+
+        /**
+         * @brief Computes every pattern and writes the table to a file.
+         * @param filename The table filename.
+         * @return True if the file was written; false otherwise.
+         */
+        static bool saveToFile(const std::string& filename);
+
+        /**
+         * @brief Returns true if a table is loaded.
+         */
+        [[nodiscard]] bool isLoaded() const;
+
+        /**
+         * @brief Returns the number of frozen boxes off storages (0 to 3) around a box.
+         * @param level The level, for walls and storages.
+         * @param index The cell of the box that has just moved.
+         * @param isBox A predicate that tells whether a cell holds a box.
+         */
+        template <typename IsBox>
+        [[nodiscard]] int frozenBoxCount(const SokobanLevel& level, const int index,
+            IsBox&& isBox) const {
+            if (m_entries == nullptr) {
+                return 0;
+            }
+
+            auto pattern = 0;
+            auto shift = 0;
+            for (int row{ -1 }; row <= 1; ++row) {
+                for (int col{ -1 }; col <= 1; ++col, shift += 2) {
+                    const auto cell = index + row * level.stride() + col;
+                    pattern |= encodeCell(level.isWall(cell), isBox(cell), level.isGoal(cell)) << shift;
+                }
+            }
+
+            return lookup(pattern);
+        }
+
+    private:
+        /**
+         * @brief The 2-bit cell states of a pattern.
+         */
+        enum CellState { Floor = 0, Wall = 1, Box = 2, BoxStorage = 3 };
+
+        /**
+         * @brief Returns the 2-bit state of a cell.
+         */
+        [[nodiscard]] static int encodeCell(bool isWall, bool isBox, bool isGoal) {
+            if (isWall) {
+                return Wall;
+            }
+
+            return isBox ? (isGoal ? BoxStorage : Box) : Floor;
+        }
+
+        /**
+         * @brief Computes the number of frozen boxes off storages in a pattern.
+         */
+        [[nodiscard]] static int evaluate(int pattern);
+
+        /**
+         * @brief Returns the stored value of a pattern.
+         */
+        [[nodiscard]] int lookup(int pattern) const;
+
+        /**
+         * @brief The mapped file; nullptr if no table is loaded.
+         */
+        void* m_mapping = nullptr;
+
+        /**
+         * @brief The size of the mapped file in bytes.
+         */
+        size_t m_mappingSize = 0;
+
+        /**
+         * @brief The packed 2-bit entries inside the mapping.
+         */
+        const uint8_t* m_entries = nullptr;
+    };
+
+}  // namespace SB
+
+#endif
@@ -2,11 +2,13 @@
 
 #include "SokobanElapsedTime.hpp"
 #include <string>
+#include "SokobanAssets.hpp"
 #include "SokobanConstants.hpp"
 
 namespace SB {
 
-    SokobanElapsedTime::SokobanElapsedTime() { m_font.loadFromFile(FONT_DIGITAL7_FILENAME); }
+    SokobanElapsedTime::SokobanElapsedTime()
+        : m_font(SokobanAssets::instance().font(FONT_DIGITAL7_FILENAME)) {}
 
     void SokobanElapsedTime::draw(sf::RenderTarget& target, sf::RenderStates states) const {
         const unsigned seconds = m_elapsedTimeInMicroseconds / 1000000u;
@@ -20,7 +22,7 @@ namespace SB {
         const std::string stringToPrint = hourStr + ":" + minuteStr + ":" + secondStr;
 
         sf::Text text;
-        text.setFont(m_font);
+        text.setFont(*m_font);
         text.setString(stringToPrint);
         text.setCharacterSize(28);
         text.setFillColor(sf::Color::Black);
@@ -3,6 +3,7 @@
 #ifndef SOKOBANELAPSEDTIME_H
 #define SOKOBANELAPSEDTIME_H
 
+#include <memory>
 #include <SFML/Graphics.hpp>
 
 namespace SB {
@@ -35,9 +36,9 @@ namespace SB {
         int64_t m_elapsedTimeInMicroseconds = 0;
 
         /**
-         * @brief The font for the displayed text.
+         * @brief The font for the displayed text. It is shared and empty until it has loaded.
          */
-        sf::Font m_font;
+        std::shared_ptr<sf::Font> m_font;
     };
 
 }  // namespace SB
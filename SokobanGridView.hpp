@@ -0,0 +1,135 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANGRIDVIEW_HPP
+#define SOKOBANGRIDVIEW_HPP
+
+#include <span>
+#include <SFML/System.hpp>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief A non-owning view of a row-major grid of cells. Rows may be `stride` cells apart, wider
+     * than the grid, so a view can show the inside of a grid with a padded border.
+     *
+     * The view is three ints and a pointer, and every member is inline, so a traversal through it
+     * compiles to a plain loop over memory: no bounds check, no exception path and no indirect call
+     * per cell. Callers make sure coordinates are inside the grid; `contains()` checks one.
+     * @tparam T The cell type; const for a read-only view.
+     */
+    template <typename T>
+    class SokobanGridView {
+    public:
+        /**
+         * @brief Creates a view of `width * height` cells starting at `cells`.
+         */
+        constexpr SokobanGridView(T* cells, const int width, const int height)
+            : SokobanGridView(cells, width, height, width) {}
+
+        /**
+         * @brief Creates a view of `height` rows of `width` cells, each row starting `stride` cells
+         * after the previous one.
+         */
+        constexpr SokobanGridView(T* cells, const int width, const int height, const int stride)
+            : m_cells(cells), m_width(width), m_height(height), m_stride(stride) {}
+
+        [[nodiscard]] constexpr int width() const { return m_width; }
+
+        [[nodiscard]] constexpr int height() const { return m_height; }
+
+        [[nodiscard]] constexpr int stride() const { return m_stride; }
+
+        /**
+         * @brief Returns the number of cells.
+         */
+        [[nodiscard]] constexpr int size() const { return m_width * m_height; }
+
+        /**
+         * @brief Returns true if a coordinate is inside the grid.
+         */
+        [[nodiscard]] constexpr bool contains(const sf::Vector2i& coordinate) const {
+            return coordinate.x >= 0 && coordinate.x < m_width && coordinate.y >= 0 &&
+                coordinate.y < m_height;
+        }
+
+        /**
+         * @brief Returns the index of a coordinate, counted from the first cell of the view.
+         */
+        [[nodiscard]] constexpr int index(const sf::Vector2i& coordinate) const {
+            return coordinate.x + coordinate.y * m_stride;
+        }
+
+        /**
+         * @brief Returns the coordinate of an index inside the grid.
+         */
+        [[nodiscard]] constexpr sf::Vector2i coordinate(const int index) const {
+            return { index % m_stride, index / m_stride };
+        }
+
+        /**
+         * @brief Returns what to add to an index to step one cell in a direction.
+         */
+        [[nodiscard]] constexpr int offset(const Direction direction) const {
+            switch (direction) {
+            case Direction::Up:
+                return -m_stride;
+            case Direction::Down:
+                return m_stride;
+            case Direction::Left:
+                return -1;
+            default:
+                return 1;
+            }
+        }
+
+        /**
+         * @brief Returns the cell at an index.
+         */
+        [[nodiscard]] constexpr T& operator[](const int index) const { return m_cells[index]; }
+
+        /**
+         * @brief Returns the cell at a coordinate.
+         */
+        [[nodiscard]] constexpr T& operator[](const sf::Vector2i& coordinate) const {
+            return m_cells[index(coordinate)];
+        }
+
+        /**
+         * @brief Returns the neighbor of a cell in a direction. The neighbor must be inside the grid
+         * or its padding.
+         */
+        [[nodiscard]] constexpr T& neighbor(const int index, const Direction direction) const {
+            return m_cells[index + offset(direction)];
+        }
+
+        /**
+         * @brief Returns a row of cells.
+         */
+        [[nodiscard]] constexpr std::span<T> row(const int y) const {
+            return { m_cells + y * m_stride, static_cast<size_t>(m_width) };
+        }
+
+        /**
+         * @brief Calls `function(coordinate, cell)` for every cell in row-major order.
+         */
+        template <typename Function>
+        constexpr void forEachCell(Function&& function) const {
+            for (int y{ 0 }; y < m_height; ++y) {
+                auto* const row = m_cells + y * m_stride;
+                for (int x{ 0 }; x < m_width; ++x) {
+                    function(sf::Vector2i{ x, y }, row[x]);
+                }
+            }
+        }
+
+    private:
+        T* m_cells;
+        int m_width;
+        int m_height;
+        int m_stride;
+    };
+
+}  // namespace SB
+
+#endif
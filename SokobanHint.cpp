@@ -0,0 +1,109 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanHint.hpp"
+#include <cctype>
+#include <mutex>
+#include <utility>
+#include "SokobanSolution.hpp"
+
+namespace SB {
+
+    SokobanHintEngine::SokobanHintEngine(const SolverOptions& options)
+        : m_options(options), m_worker(&SokobanHintEngine::work, this) {}
+
+    SokobanHintEngine::~SokobanHintEngine() {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_isStopping = true;
+            m_cancel = true;
+        }
+        m_condition.notify_all();
+        m_worker.join();
+    }
+
+    void SokobanHintEngine::request(const Sokoban& sokoban) {
+        request(sokoban.level(), sokoban.searchState());
+    }
+
+    void SokobanHintEngine::request(const SokobanLevel& level, const SearchState& state) {
+        {
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_level = level;
+            m_state = state;
+            m_hasRequest = true;
+            ++m_generation;
+            m_cancel = true;
+            m_isReady = false;
+        }
+        m_condition.notify_all();
+    }
+
+    void SokobanHintEngine::cancel() {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        m_hasRequest = false;
+        ++m_generation;
+        m_cancel = true;
+        m_isReady = false;
+    }
+
+    bool SokobanHintEngine::poll(Hint& hint) {
+        if (!m_isReady.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (!m_isReady) {
+            return false;
+        }
+        hint = m_hint;
+        m_isReady = false;
+        return true;
+    }
+
+    bool SokobanHintEngine::isSearching() const { return m_isSearching; }
+
+    void SokobanHintEngine::work() {
+        while (true) {
+            SokobanLevel level;
+            SearchState state{};
+            uint64_t generation{ 0 };
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                m_condition.wait(lock, [this] { return m_isStopping || m_hasRequest; });
+                if (m_isStopping) {
+                    return;
+                }
+                level = std::move(m_level);
+                state = std::move(m_state);
+                m_hasRequest = false;
+                generation = m_generation;
+                m_cancel = false;
+                m_isSearching = true;
+            }
+
+            // The solver is set up here too, so not even its tables cost the frame loop anything
+            auto options{ m_options };
+            options.cancel = &m_cancel;
+            const auto result = SokobanSolver{ level, options }.solve(state);
+
+            Hint hint;
+            if (result.isSolved) {
+                hint.isSolvable = true;
+                hint.pushes = result.pushes;
+                hint.moves = result.moves;
+                if (!result.solution.empty()) {
+                    hint.direction = fromLurd(result.solution.front());
+                    hint.isPush = std::isupper(static_cast<unsigned char>(result.solution.front()));
+                }
+            }
+
+            const std::lock_guard<std::mutex> lock{ m_mutex };
+            m_isSearching = false;
+            if (generation == m_generation) {
+                m_hint = hint;
+                m_isReady.store(true, std::memory_order_release);
+            }
+        }
+    }
+
+}  // namespace SB
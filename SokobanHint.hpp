@@ -0,0 +1,140 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANHINT_HPP
+#define SOKOBANHINT_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "Sokoban.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanSearch.hpp"
+#include "SokobanSolver.hpp"
+
+namespace SB {
+
+    /**
+     * @brief The next step along a solution from the position a hint was asked for.
+     */
+    struct Hint {
+        /**
+         * @brief False if the search found no solution within its budget; nothing else is set then.
+         */
+        bool isSolvable = false;
+
+        Direction direction = Direction::Up;
+
+        /**
+         * @brief True if the step pushes a box.
+         */
+        bool isPush = false;
+
+        /**
+         * @brief The pushes and moves left along the solution, the step included.
+         */
+        int pushes = 0;
+        int moves = 0;
+    };
+
+    /**
+     * @brief Solves positions on a worker thread of its own so that a frame loop can ask for hints
+     * without waiting for them. The loop hands over a snapshot with `request` and checks `poll`
+     * once per frame, which costs an atomic load until the hint is ready. A new request or a
+     * `cancel` stops the search under way through `SolverOptions::cancel`, and a hint finished for
+     * an older snapshot is dropped rather than handed out.
+     */
+    class SokobanHintEngine {
+    public:
+        /**
+         * @brief Starts the worker thread.
+         * @param options The solver parameters of every search; `cancel` is set by the engine.
+         */
+        explicit SokobanHintEngine(const SolverOptions& options = {});
+
+        SokobanHintEngine(const SokobanHintEngine&) = delete;
+        SokobanHintEngine& operator=(const SokobanHintEngine&) = delete;
+
+        /**
+         * @brief Cancels the search under way and joins the worker thread.
+         */
+        ~SokobanHintEngine();
+
+        /**
+         * @brief Asks for a hint for the current position of a game, replacing any earlier request.
+         */
+        void request(const Sokoban& sokoban);
+
+        /**
+         * @brief Asks for a hint for a position of a level, replacing any earlier request.
+         */
+        void request(const SokobanLevel& level, const SearchState& state);
+
+        /**
+         * @brief Drops the request under way and the hint not yet polled, e.g. after a move.
+         */
+        void cancel();
+
+        /**
+         * @brief Takes the hint for the last request if it is ready.
+         * @return False if no hint is ready.
+         */
+        bool poll(Hint& hint);
+
+        /**
+         * @brief Returns true while the worker thread searches.
+         */
+        [[nodiscard]] bool isSearching() const;
+
+    private:
+        /**
+         * @brief Runs the searches until the engine is destroyed.
+         */
+        void work();
+
+        /**
+         * @brief The solver parameters, fixed before the worker starts.
+         */
+        const SolverOptions m_options;
+
+        /**
+         * @brief Guards the members below up to the atomics.
+         */
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+
+        /**
+         * @brief The snapshot waiting for the worker, if `m_hasRequest`.
+         */
+        SokobanLevel m_level;
+        SearchState m_state{};
+        bool m_hasRequest = false;
+
+        /**
+         * @brief Bumped by every request and cancel; a hint only counts if nothing bumped it since
+         * its search started.
+         */
+        uint64_t m_generation = 0;
+
+        /**
+         * @brief The hint `poll` hands out once `m_isReady` is set.
+         */
+        Hint m_hint;
+
+        bool m_isStopping = false;
+
+        /**
+         * @brief Stops the search under way.
+         */
+        std::atomic<bool> m_cancel{ false };
+
+        std::atomic<bool> m_isReady{ false };
+        std::atomic<bool> m_isSearching{ false };
+
+        std::thread m_worker;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,85 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanLevel.hpp"
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    SokobanLevel::SokobanLevel(const int width, const int height,
+        const std::vector<TileChar>& tileCharGrid)
+        : m_width(width), m_height(height), m_tileCharGrid(tileCharGrid) {
+        if (static_cast<int>(tileCharGrid.size()) != width * height) {
+            throw std::invalid_argument("Tile char grid does not match the level size");
+        }
+
+        m_offsets = { -stride(), stride(), -1, 1 };
+        m_walls.assign(size(), true);
+        m_goalFlags.assign(size(), false);
+
+        for (int row{ 0 }; row < height; ++row) {
+            for (int col{ 0 }; col < width; ++col) {
+                const auto tileChar = tileCharGrid[col + row * width];
+                const auto index = toIndex({ col, row });
+                m_walls[index] = tileChar == TileChar::Wall;
+
+                if (tileChar == TileChar::Storage || tileChar == TileChar::BoxStorage) {
+                    m_goalFlags[index] = true;
+                    m_goals.push_back(index);
+                }
+                if (tileChar == TileChar::Box || tileChar == TileChar::BoxStorage) {
+                    m_initialBoxes.push_back(index);
+                }
+                if (tileChar == TileChar::Player) {
+                    m_initialPlayer = index;
+                }
+            }
+        }
+    }
+
+    std::istream& operator>>(std::istream& istream, SokobanLevel& level) {
+        int height{ 0 };
+        int width{ 0 };
+        istream >> height >> width;
+        istream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+
+        std::vector<TileChar> tileCharGrid;
+        for (int row{ 0 }; row < height; ++row) {
+            std::string line;
+            getline(istream, line);
+            for (int col{ 0 }; col < width; ++col) {
+                tileCharGrid.push_back(static_cast<TileChar>(line.at(col)));
+            }
+        }
+
+        level = SokobanLevel(width, height, tileCharGrid);
+        return istream;
+    }
+
+    int SokobanLevel::width() const { return m_width; }
+
+    int SokobanLevel::height() const { return m_height; }
+
+    int SokobanLevel::stride() const { return m_width + 2; }
+
+    int SokobanLevel::size() const { return (m_width + 2) * (m_height + 2); }
+
+    int SokobanLevel::toIndex(const sf::Vector2i& coordinate) const {
+        return (coordinate.y + 1) * stride() + coordinate.x + 1;
+    }
+
+    sf::Vector2i SokobanLevel::toCoordinate(const int index) const {
+        return { index % stride() - 1, index / stride() - 1 };
+    }
+
+    const std::vector<int>& SokobanLevel::goals() const { return m_goals; }
+
+    const std::vector<int>& SokobanLevel::initialBoxes() const { return m_initialBoxes; }
+
+    int SokobanLevel::initialPlayer() const { return m_initialPlayer; }
+
+    const std::vector<TileChar>& SokobanLevel::tileCharGrid() const { return m_tileCharGrid; }
+
+}  // namespace SB
@@ -0,0 +1,164 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANLEVEL_HPP
+#define SOKOBANLEVEL_HPP
+
+#include <array>
+#include <istream>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief The static layout of a level: walls, storages and the initial positions of the boxes and
+     * the player. Cells are addressed by index into a grid that has a one-tile wall border around the
+     * map, so a neighbor is always `index + offset(direction)` and never falls outside the grid.
+     */
+    class SokobanLevel {
+    public:
+        /**
+         * @brief All four directions, in the order of the `Direction` enumeration.
+         */
+        static constexpr std::array<Direction, 4> DIRECTIONS{
+            Direction::Up, Direction::Down, Direction::Left, Direction::Right
+        };
+
+        /**
+         * @brief Creates an empty level.
+         */
+        SokobanLevel() = default;
+
+        /**
+         * @brief Creates a level from a tile char grid in row-major order, as read from a level file.
+         * @param width The number of tile columns.
+         * @param height The number of tile rows.
+         * @param tileCharGrid The tile characters; its size must be width * height.
+         */
+        SokobanLevel(int width, int height, const std::vector<TileChar>& tileCharGrid);
+
+        /**
+         * @brief Reads a level from a level file (.lvl). The first line holds the height and the
+         * width; the rest of that line is ignored.
+         */
+        friend std::istream& operator>>(std::istream& istream, SokobanLevel& level);
+
+        /**
+         * @brief Returns the number of tile columns, excluding the border.
+         */
+        [[nodiscard]] int width() const;
+
+        /**
+         * @brief Returns the number of tile rows, excluding the border.
+         */
+        [[nodiscard]] int height() const;
+
+        /**
+         * @brief Returns the number of cells per row of the bordered grid.
+         */
+        [[nodiscard]] int stride() const;
+
+        /**
+         * @brief Returns the number of cells of the bordered grid.
+         */
+        [[nodiscard]] int size() const;
+
+        /**
+         * @brief Returns the cell index of a map coordinate.
+         */
+        [[nodiscard]] int toIndex(const sf::Vector2i& coordinate) const;
+
+        /**
+         * @brief Returns the map coordinate of a cell index.
+         */
+        [[nodiscard]] sf::Vector2i toCoordinate(int index) const;
+
+        /**
+         * @brief Returns the index difference between a cell and its neighbor in a direction.
+         */
+        [[nodiscard]] int offset(Direction direction) const {
+            return m_offsets[static_cast<int>(direction)];
+        }
+
+        /**
+         * @brief Returns true if the cell is a wall or part of the border.
+         */
+        [[nodiscard]] bool isWall(const int index) const { return m_walls[index]; }
+
+        /**
+         * @brief Returns true if the cell is a storage (with or without a box on it initially).
+         */
+        [[nodiscard]] bool isGoal(const int index) const { return m_goalFlags[index]; }
+
+        /**
+         * @brief Returns the storage cells in ascending order.
+         */
+        [[nodiscard]] const std::vector<int>& goals() const;
+
+        /**
+         * @brief Returns the initial box cells in ascending order.
+         */
+        [[nodiscard]] const std::vector<int>& initialBoxes() const;
+
+        /**
+         * @brief Returns the initial player cell.
+         */
+        [[nodiscard]] int initialPlayer() const;
+
+        /**
+         * @brief Returns the tile char grid the level was created from, in row-major order without
+         * the border.
+         */
+        [[nodiscard]] const std::vector<TileChar>& tileCharGrid() const;
+
+    private:
+        /**
+         * @brief The number of tile columns, excluding the border.
+         */
+        int m_width = 0;
+
+        /**
+         * @brief The number of tile rows, excluding the border.
+         */
+        int m_height = 0;
+
+        /**
+         * @brief The tile char grid the level was created from.
+         */
+        std::vector<TileChar> m_tileCharGrid;
+
+        /**
+         * @brief Index differences for Up, Down, Left and Right.
+         */
+        std::array<int, 4> m_offsets{};
+
+        /**
+         * @brief One flag per cell of the bordered grid; set for walls and the border.
+         */
+        std::vector<bool> m_walls;
+
+        /**
+         * @brief One flag per cell of the bordered grid; set for storages.
+         */
+        std::vector<bool> m_goalFlags;
+
+        /**
+         * @brief The storage cells.
+         */
+        std::vector<int> m_goals;
+
+        /**
+         * @brief The initial box cells.
+         */
+        std::vector<int> m_initialBoxes;
+
+        /**
+         * @brief The initial player cell.
+         */
+        int m_initialPlayer = 0;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,329 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanLevelGenerator.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SokobanParallel.hpp"
+#include "SokobanSolution.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The state of one generation attempt. The grid has the outer wall as its border, so
+         * neighbors of floor cells never leave the grid.
+         */
+        class ReversePlay {
+        public:
+            ReversePlay(const int width, const int height, std::mt19937_64& random)
+                : m_width(width), m_height(height), m_random(random),
+                m_walls(width * height, true), m_goals(width * height, false),
+                m_boxes(width * height, false), m_distances(width * height),
+                m_parents(width * height) {
+                m_offsets = { -width, width, -1, 1 };
+            }
+
+            /**
+             * @brief Carves rooms and joins consecutive rooms with L-shaped corridors.
+             */
+            void carve() {
+                const auto roomCount = 2 + m_width * m_height / 80;
+                Point previous{ -1, -1 };
+                for (int room{ 0 }; room < roomCount; ++room) {
+                    const auto roomWidth = uniform(2, std::min(6, m_width - 2));
+                    const auto roomHeight = uniform(2, std::min(6, m_height - 2));
+                    const auto left = uniform(1, m_width - 1 - roomWidth);
+                    const auto top = uniform(1, m_height - 1 - roomHeight);
+                    for (int y{ top }; y < top + roomHeight; ++y) {
+                        for (int x{ left }; x < left + roomWidth; ++x) {
+                            m_walls[x + y * m_width] = false;
+                        }
+                    }
+
+                    const Point center{ left + roomWidth / 2, top + roomHeight / 2 };
+                    if (previous.x >= 0) {
+                        for (int x{ std::min(previous.x, center.x) };
+                            x <= std::max(previous.x, center.x); ++x) {
+                            m_walls[x + previous.y * m_width] = false;
+                        }
+                        for (int y{ std::min(previous.y, center.y) };
+                            y <= std::max(previous.y, center.y); ++y) {
+                            m_walls[center.x + y * m_width] = false;
+                        }
+                    }
+                    previous = center;
+                }
+            }
+
+            /**
+             * @brief Places the boxes on random storages and the player on a random floor cell.
+             * @return False if there isn't enough floor.
+             */
+            bool place(const int boxCount) {
+                std::vector<int> floor;
+                for (int index{ 0 }; index < m_width * m_height; ++index) {
+                    if (!m_walls[index]) {
+                        floor.push_back(index);
+                    }
+                }
+                if (static_cast<int>(floor.size()) < boxCount * 3 + 1) {
+                    return false;
+                }
+
+                std::shuffle(floor.begin(), floor.end(), m_random);
+                for (int box{ 0 }; box < boxCount; ++box) {
+                    m_goals[floor[box]] = true;
+                    m_boxes[floor[box]] = true;
+                }
+                m_player = floor[boxCount];
+                return true;
+            }
+
+            /**
+             * @brief Walks and pulls boxes for a number of steps, favoring repeated pulls of the same
+             * box in the same direction so boxes travel away from the storages.
+             */
+            void pull(const int steps) {
+                auto lastBox = -1;
+                auto lastDirection = 0;
+                for (int step{ 0 }; step < steps; ++step) {
+                    flood();
+
+                    // A pull moves the player from `to` to `to + offset` and the box onto `to`
+                    std::vector<std::pair<int, int>> pulls;
+                    auto repeat = -1;
+                    for (int box{ 0 }; box < m_width * m_height; ++box) {
+                        if (!m_boxes[box]) {
+                            continue;
+                        }
+
+                        for (int direction{ 0 }; direction < 4; ++direction) {
+                            const auto to = box + m_offsets[direction];
+                            const auto playerTo = to + m_offsets[direction];
+                            if (m_distances[to] < 0 || isBlocked(playerTo)) {
+                                continue;
+                            }
+
+                            if (box == lastBox && direction == lastDirection) {
+                                repeat = static_cast<int>(pulls.size());
+                            }
+                            pulls.emplace_back(box, direction);
+                        }
+                    }
+                    if (pulls.empty()) {
+                        return;
+                    }
+
+                    const auto choice = repeat >= 0 && uniform(0, 9) < 7
+                        ? repeat
+                        : uniform(0, static_cast<int>(pulls.size()) - 1);
+                    const auto [box, direction] = pulls[choice];
+                    const auto to = box + m_offsets[direction];
+
+                    walkTo(to);
+                    m_boxes[box] = false;
+                    m_boxes[to] = true;
+                    m_player = to + m_offsets[direction];
+                    m_reverseMoves.push_back(toLurd(static_cast<Direction>(direction), true));
+
+                    lastBox = to;
+                    lastDirection = direction;
+                }
+            }
+
+            /**
+             * @brief Moves the player off the storages, since a level file can't put the player on
+             * one.
+             * @return False if no reachable cell off the storages exists.
+             */
+            bool leaveStorage() {
+                if (!m_goals[m_player]) {
+                    return true;
+                }
+
+                flood();
+                auto best = -1;
+                for (int index{ 0 }; index < m_width * m_height; ++index) {
+                    if (m_distances[index] >= 0 && !m_goals[index] &&
+                        (best < 0 || m_distances[index] < m_distances[best])) {
+                        best = index;
+                    }
+                }
+                if (best < 0) {
+                    return false;
+                }
+
+                walkTo(best);
+                return true;
+            }
+
+            /**
+             * @brief Returns the level, or nothing if no box left its storage.
+             */
+            std::optional<GeneratedLevel> result(const uint64_t seed) const {
+                GeneratedLevel level{ seed, m_width, m_height, {}, {}, 0, 0 };
+                auto boxesOffStorage = 0;
+                for (int index{ 0 }; index < m_width * m_height; ++index) {
+                    auto tileChar = TileChar::Empty;
+                    if (m_walls[index]) {
+                        tileChar = TileChar::Wall;
+                    }
+                    else if (m_boxes[index]) {
+                        tileChar = m_goals[index] ? TileChar::BoxStorage : TileChar::Box;
+                        boxesOffStorage += m_goals[index] ? 0 : 1;
+                    }
+                    else if (m_goals[index]) {
+                        tileChar = TileChar::Storage;
+                    }
+                    else if (index == m_player) {
+                        tileChar = TileChar::Player;
+                    }
+                    level.tileCharGrid.push_back(tileChar);
+                }
+                if (boxesOffStorage == 0) {
+                    return std::nullopt;
+                }
+
+                // Playing the reverse moves backwards, with every direction flipped, solves the level
+                for (auto it = m_reverseMoves.rbegin(); it != m_reverseMoves.rend(); ++it) {
+                    const auto isPush = std::isupper(static_cast<unsigned char>(*it)) != 0;
+                    level.solution.push_back(toLurd(opposite(fromLurd(*it)), isPush));
+                    level.pushes += isPush ? 1 : 0;
+                }
+                level.moves = static_cast<int>(level.solution.size());
+
+                return level;
+            }
+
+        private:
+            /**
+             * @brief A tile coordinate.
+             */
+            struct Point {
+                int x;
+                int y;
+            };
+
+            int uniform(const int min, const int max) {
+                return std::uniform_int_distribution<int>(min, std::max(min, max))(m_random);
+            }
+
+            bool isBlocked(const int index) const { return m_walls[index] || m_boxes[index]; }
+
+            /**
+             * @brief Computes the walking distance and path parents from the player to every cell.
+             */
+            void flood() {
+                std::fill(m_distances.begin(), m_distances.end(), -1);
+                m_queue.clear();
+                m_queue.push_back(m_player);
+                m_distances[m_player] = 0;
+                for (size_t head{ 0 }; head < m_queue.size(); ++head) {
+                    const auto cell = m_queue[head];
+                    for (int direction{ 0 }; direction < 4; ++direction) {
+                        const auto next = cell + m_offsets[direction];
+                        if (!isBlocked(next) && m_distances[next] < 0) {
+                            m_distances[next] = m_distances[cell] + 1;
+                            m_parents[next] = direction;
+                            m_queue.push_back(next);
+                        }
+                    }
+                }
+            }
+
+            /**
+             * @brief Walks the player to a cell reached by the last flood fill.
+             */
+            void walkTo(const int target) {
+                std::string path;
+                for (auto cell = target; cell != m_player; cell -= m_offsets[m_parents[cell]]) {
+                    path.push_back(toLurd(static_cast<Direction>(m_parents[cell]), false));
+                }
+                m_reverseMoves.append(path.rbegin(), path.rend());
+                m_player = target;
+            }
+
+            int m_width;
+            int m_height;
+            std::mt19937_64& m_random;
+            std::array<int, 4> m_offsets{};
+            std::vector<bool> m_walls;
+            std::vector<bool> m_goals;
+            std::vector<bool> m_boxes;
+            std::vector<int> m_distances;
+            std::vector<int> m_parents;
+            std::vector<int> m_queue;
+            int m_player = 0;
+            std::string m_reverseMoves;
+        };
+
+    }  // namespace
+
+    std::ostream& operator<<(std::ostream& ostream, const GeneratedLevel& level) {
+        ostream << level.height << " " << level.width << " " << level.pushes << " " << level.moves;
+        for (int index{ 0 }; index < level.width * level.height; ++index) {
+            if (index % level.width == 0) {
+                ostream << std::endl;
+            }
+            ostream << static_cast<char>(level.tileCharGrid[index]);
+        }
+
+        return ostream << std::endl;
+    }
+
+    SokobanLevelGenerator::SokobanLevelGenerator(const GeneratorOptions& options)
+        : m_options(options) {}
+
+    std::optional<GeneratedLevel> SokobanLevelGenerator::generate(const uint64_t seed) const {
+        std::mt19937_64 random{ seed };
+        for (int attempt{ 0 }; attempt < m_options.attempts; ++attempt) {
+            const auto width =
+                std::uniform_int_distribution<int>(m_options.minSize, m_options.maxSize)(random);
+            const auto height =
+                std::uniform_int_distribution<int>(m_options.minSize, m_options.maxSize)(random);
+            const auto boxCount =
+                std::uniform_int_distribution<int>(m_options.minBoxes, m_options.maxBoxes)(random);
+
+            ReversePlay play{ width, height, random };
+            play.carve();
+            if (!play.place(boxCount)) {
+                continue;
+            }
+
+            play.pull(m_options.pullSteps);
+            if (!play.leaveStorage()) {
+                continue;
+            }
+
+            auto level = play.result(seed);
+            if (level.has_value() && level->pushes >= boxCount) {
+                return level;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    std::vector<GeneratedLevel> SokobanLevelGenerator::generateBatch(const uint64_t firstSeed,
+        const int count, const unsigned threadCount) const {
+        std::vector<std::optional<GeneratedLevel>> slots(count);
+        parallelFor(count, [&](const int i) { slots[i] = generate(firstSeed + i); }, threadCount);
+
+        std::vector<GeneratedLevel> levels;
+        for (auto& slot : slots) {
+            if (slot.has_value()) {
+                levels.push_back(std::move(*slot));
+            }
+        }
+
+        return levels;
+    }
+
+}  // namespace SB
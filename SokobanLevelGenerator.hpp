@@ -0,0 +1,87 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANLEVELGENERATOR_HPP
+#define SOKOBANLEVELGENERATOR_HPP
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Parameters of the level generator. Sizes include the outer wall.
+     */
+    struct GeneratorOptions {
+        int minSize = 10;
+        int maxSize = 30;
+        int minBoxes = 2;
+        int maxBoxes = 6;
+        int pullSteps = 400;
+        int attempts = 16;
+    };
+
+    /**
+     * @brief A generated level with the solution found while generating it.
+     */
+    struct GeneratedLevel {
+        uint64_t seed;
+        int width;
+        int height;
+        std::vector<TileChar> tileCharGrid;
+        std::string solution;
+        int pushes;
+        int moves;
+
+        /**
+         * @brief Writes the level in the level file (.lvl) format. The first line also carries the
+         * push and move counts of the solution, which `operator>>` ignores.
+         */
+        friend std::ostream& operator<<(std::ostream& ostream, const GeneratedLevel& level);
+    };
+
+    /**
+     * @brief Generates solvable levels. A layout is carved out of rooms joined by corridors, boxes are
+     * placed on the storages, and then the game is played backwards: the player walks around and
+     * pulls boxes away from the storages. Reversing that play gives a solution, so every level is
+     * solvable by construction, and its length rates the difficulty. The output for a seed depends on
+     * nothing else, so batches can be split across threads freely.
+     */
+    class SokobanLevelGenerator {
+    public:
+        /**
+         * @brief Creates a generator.
+         * @param options The generator parameters.
+         */
+        explicit SokobanLevelGenerator(const GeneratorOptions& options = {});
+
+        /**
+         * @brief Generates the level for a seed.
+         * @param seed The seed.
+         * @return The level, or nothing if every attempt produced a degenerate layout.
+         */
+        [[nodiscard]] std::optional<GeneratedLevel> generate(uint64_t seed) const;
+
+        /**
+         * @brief Generates the levels for seeds firstSeed, firstSeed + 1, ... in parallel.
+         * @param firstSeed The first seed.
+         * @param count The number of seeds.
+         * @param threadCount The number of threads; 0 means one per core.
+         * @return The generated levels, ordered by seed. Failed seeds are skipped.
+         */
+        [[nodiscard]] std::vector<GeneratedLevel> generateBatch(uint64_t firstSeed, int count,
+            unsigned threadCount = 0) const;
+
+    private:
+        /**
+         * @brief The generator parameters.
+         */
+        GeneratorOptions m_options;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,180 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanLowerBound.hpp"
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace SB {
+
+    SokobanLowerBound::SokobanLowerBound(const SokobanLevel& level)
+        : m_goalCount(static_cast<int>(level.goals().size())), m_cellCount(level.size()) {
+        m_distances.assign(static_cast<size_t>(m_cellCount) * m_goalCount, UNREACHABLE);
+
+        // For each storage, walk backwards with pulls: a box on `from` can be pushed to `to` if both
+        // `to` and the cell behind `from` (where the player stands) are not walls
+        std::deque<int> queue;
+        for (int goal{ 0 }; goal < m_goalCount; ++goal) {
+            const auto goalIndex = level.goals()[goal];
+            m_distances[static_cast<size_t>(goalIndex) * m_goalCount + goal] = 0;
+            queue.push_back(goalIndex);
+
+            while (!queue.empty()) {
+                const auto to = queue.front();
+                queue.pop_front();
+                const auto distance = m_distances[static_cast<size_t>(to) * m_goalCount + goal];
+
+                for (const auto direction : SokobanLevel::DIRECTIONS) {
+                    const auto from = to - level.offset(direction);
+                    const auto playerIndex = from - level.offset(direction);
+                    if (level.isWall(from) || level.isWall(playerIndex)) {
+                        continue;
+                    }
+
+                    auto& fromDistance = m_distances[static_cast<size_t>(from) * m_goalCount + goal];
+                    if (fromDistance == UNREACHABLE) {
+                        fromDistance = distance + 1;
+                        queue.push_back(from);
+                    }
+                }
+            }
+        }
+    }
+
+    void SokobanLowerBound::reset(const std::vector<int>& boxes) {
+        const auto boxCount = static_cast<int>(boxes.size());
+        m_size = std::max(boxCount, m_goalCount);
+
+        m_rowCells.assign(m_size + 1, -1);
+        m_cellRows.assign(m_cellCount, 0);
+        for (int row{ 1 }; row <= boxCount; ++row) {
+            m_rowCells[row] = boxes[row - 1];
+            m_cellRows[boxes[row - 1]] = row;
+        }
+
+        m_rowPotentials.assign(m_size + 1, 0);
+        m_columnPotentials.assign(m_size + 1, 0);
+        m_columnRows.assign(m_size + 1, 0);
+        m_minSlack.assign(m_size + 1, 0);
+        m_way.assign(m_size + 1, 0);
+        m_used.assign(m_size + 1, 0);
+
+        for (int row{ 1 }; row <= m_size; ++row) {
+            augment(row);
+        }
+
+        updateValue();
+    }
+
+    void SokobanLowerBound::moveBox(const int fromIndex, const int toIndex) {
+        const auto row = m_cellRows[fromIndex];
+        if (row == 0) {
+            return;
+        }
+
+        m_cellRows[fromIndex] = 0;
+        m_cellRows[toIndex] = row;
+        m_rowCells[row] = toIndex;
+
+        // Only this row's costs changed: free its column and re-match it with one augmenting path.
+        // The other rows' potentials are still feasible because their costs are unchanged.
+        for (int column{ 1 }; column <= m_size; ++column) {
+            if (m_columnRows[column] == row) {
+                m_columnRows[column] = 0;
+                break;
+            }
+        }
+
+        augment(row);
+        updateValue();
+    }
+
+    int SokobanLowerBound::value() const {
+        return m_value >= INFINITE_COST ? UNREACHABLE : static_cast<int>(m_value);
+    }
+
+    int SokobanLowerBound::distance(const int index, const int goal) const {
+        return m_distances[static_cast<size_t>(index) * m_goalCount + goal];
+    }
+
+    bool SokobanLowerBound::isDeadSquare(const int index) const {
+        for (int goal{ 0 }; goal < m_goalCount; ++goal) {
+            if (distance(index, goal) != UNREACHABLE) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int64_t SokobanLowerBound::cost(const int row, const int column) const {
+        const auto cell = m_rowCells[row];
+        if (cell < 0 || column > m_goalCount) {
+            return 0;
+        }
+
+        const auto pushes = distance(cell, column - 1);
+        return pushes == UNREACHABLE ? INFINITE_COST : pushes;
+    }
+
+    void SokobanLowerBound::augment(const int row) {
+        // Hungarian algorithm, one row at a time (shortest augmenting path with potentials). Column 0
+        // is a virtual column holding the row being matched.
+        constexpr auto infinity = std::numeric_limits<int64_t>::max();
+        std::fill(m_minSlack.begin(), m_minSlack.end(), infinity);
+        std::fill(m_used.begin(), m_used.end(), 0);
+
+        m_columnRows[0] = row;
+        auto column = 0;
+        do {
+            m_used[column] = 1;
+            const auto currentRow = m_columnRows[column];
+            auto delta = infinity;
+            auto nextColumn = 0;
+
+            for (int candidate{ 1 }; candidate <= m_size; ++candidate) {
+                if (m_used[candidate]) {
+                    continue;
+                }
+
+                const auto slack = cost(currentRow, candidate) - m_rowPotentials[currentRow] -
+                    m_columnPotentials[candidate];
+                if (slack < m_minSlack[candidate]) {
+                    m_minSlack[candidate] = slack;
+                    m_way[candidate] = column;
+                }
+                if (m_minSlack[candidate] < delta) {
+                    delta = m_minSlack[candidate];
+                    nextColumn = candidate;
+                }
+            }
+
+            for (int candidate{ 0 }; candidate <= m_size; ++candidate) {
+                if (m_used[candidate]) {
+                    m_rowPotentials[m_columnRows[candidate]] += delta;
+                    m_columnPotentials[candidate] -= delta;
+                }
+                else {
+                    m_minSlack[candidate] -= delta;
+                }
+            }
+
+            column = nextColumn;
+        } while (m_columnRows[column] != 0);
+
+        // Flip the augmenting path
+        do {
+            const auto previousColumn = m_way[column];
+            m_columnRows[column] = m_columnRows[previousColumn];
+            column = previousColumn;
+        } while (column != 0);
+    }
+
+    void SokobanLowerBound::updateValue() {
+        m_value = 0;
+        for (int column{ 1 }; column <= m_size; ++column) {
+            m_value += cost(m_columnRows[column], column);
+        }
+    }
+
+}  // namespace SB
@@ -0,0 +1,148 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANLOWERBOUND_HPP
+#define SOKOBANLOWERBOUND_HPP
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief An admissible estimate of the number of pushes still needed to win. Push distances from
+     * every cell to every storage are precomputed when the level is loaded (ignoring other boxes), and
+     * the estimate is the cost of a min-cost matching of boxes to storages, solved with the Hungarian
+     * algorithm. The matching is kept between calls: when a single box moves, only that box is
+     * re-matched with one augmenting path, which costs O(n^2) instead of the O(n^3) of a fresh solve.
+     */
+    class SokobanLowerBound {
+    public:
+        /**
+         * @brief The value returned when some storage can no longer be filled, i.e. the position is
+         * dead.
+         */
+        static constexpr int UNREACHABLE = std::numeric_limits<int>::max();
+
+        /**
+         * @brief Creates an estimator for an empty level.
+         */
+        SokobanLowerBound() = default;
+
+        /**
+         * @brief Creates an estimator for a level and precomputes the push distance tables.
+         * @param level The level to analyze.
+         */
+        explicit SokobanLowerBound(const SokobanLevel& level);
+
+        /**
+         * @brief Solves the matching from scratch for a set of box cells.
+         * @param boxes The cells of all boxes.
+         */
+        void reset(const std::vector<int>& boxes);
+
+        /**
+         * @brief Updates the matching after one box moved.
+         * @param fromIndex The cell the box moved from.
+         * @param toIndex The cell the box moved to.
+         */
+        void moveBox(int fromIndex, int toIndex);
+
+        /**
+         * @brief Returns the minimum number of pushes needed to fill as many storages as possible, or
+         * UNREACHABLE if that is impossible from the current position.
+         */
+        [[nodiscard]] int value() const;
+
+        /**
+         * @brief Returns the number of pushes needed to move a lone box from a cell to a storage, or
+         * UNREACHABLE if the storage cannot be reached.
+         * @param index The cell of the box.
+         * @param goal The position of the storage in `SokobanLevel::goals()`.
+         */
+        [[nodiscard]] int distance(int index, int goal) const;
+
+        /**
+         * @brief Returns true if a box on the cell can never reach any storage.
+         */
+        [[nodiscard]] bool isDeadSquare(int index) const;
+
+    private:
+        /**
+         * @brief The cost used in the matching for a box that cannot reach a storage. It is large
+         * enough that any matching using it exceeds every matching that does not.
+         */
+        static constexpr int64_t INFINITE_COST = int64_t{ 1 } << 32;
+
+        /**
+         * @brief Returns the matching cost of a row (box) and a column (storage), both 1-based. Rows
+         * and columns past the number of boxes or storages are dummies with cost 0.
+         */
+        [[nodiscard]] int64_t cost(int row, int column) const;
+
+        /**
+         * @brief Matches a row that is currently unmatched with one augmenting path, keeping the
+         * potentials of the other rows valid.
+         * @param row The 1-based row to match.
+         */
+        void augment(int row);
+
+        /**
+         * @brief Recomputes the cached total cost from the current assignment.
+         */
+        void updateValue();
+
+        /**
+         * @brief The number of storages.
+         */
+        int m_goalCount = 0;
+
+        /**
+         * @brief The number of cells in the level.
+         */
+        int m_cellCount = 0;
+
+        /**
+         * @brief Push distances, indexed by cell * m_goalCount + goal.
+         */
+        std::vector<int> m_distances;
+
+        /**
+         * @brief The size of the square cost matrix: max(boxes, storages).
+         */
+        int m_size = 0;
+
+        /**
+         * @brief The cell of the box in each 1-based row; -1 for dummy rows.
+         */
+        std::vector<int> m_rowCells;
+
+        /**
+         * @brief The 1-based row of the box on each cell; 0 if the cell holds no box.
+         */
+        std::vector<int> m_cellRows;
+
+        /**
+         * @brief Row potentials, column potentials and the row matched to each column (0 if none).
+         */
+        std::vector<int64_t> m_rowPotentials;
+        std::vector<int64_t> m_columnPotentials;
+        std::vector<int> m_columnRows;
+
+        /**
+         * @brief Scratch space for `augment`, kept to avoid allocating on every move.
+         */
+        std::vector<int64_t> m_minSlack;
+        std::vector<int> m_way;
+        std::vector<char> m_used;
+
+        /**
+         * @brief The cost of the current matching.
+         */
+        int64_t m_value = 0;
+    };
+
+}  // namespace SB
+
+#endif
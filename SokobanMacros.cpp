@@ -0,0 +1,326 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanMacros.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief Goal rooms larger than this are not analyzed; the macro is meant for small rooms.
+         */
+        constexpr int MAX_ROOM_CELLS = 400;
+
+        /**
+         * @brief Returns true if a direction moves along the vertical axis.
+         */
+        bool isVertical(const Direction direction) {
+            return direction == Direction::Up || direction == Direction::Down;
+        }
+
+    }  // namespace
+
+    SokobanMacros::SokobanMacros(const SokobanLevel& level)
+        : m_level(level), m_tunnelFlags(level.size(), 0), m_roomOfCell(level.size(), -1),
+        m_localOf(level.size(), -1) {
+        for (int index{ 0 }; index < level.size(); ++index) {
+            if (level.isWall(index)) {
+                continue;
+            }
+
+            const auto left = level.isWall(index + level.offset(Direction::Left));
+            const auto right = level.isWall(index + level.offset(Direction::Right));
+            const auto up = level.isWall(index + level.offset(Direction::Up));
+            const auto down = level.isWall(index + level.offset(Direction::Down));
+            m_tunnelFlags[index] = static_cast<char>((left && right ? 1 : 0) | (up && down ? 2 : 0));
+        }
+
+        findGoalRooms();
+    }
+
+    bool SokobanMacros::isTunnel(const int index, const Direction direction) const {
+        return (m_tunnelFlags[index] & (isVertical(direction) ? 1 : 2)) != 0;
+    }
+
+    int SokobanMacros::goalRoomCount() const { return static_cast<int>(m_rooms.size()); }
+
+    Push SokobanMacros::extend(const std::vector<char>& boxes, const Push& push) const {
+        auto result{ push };
+        const auto offset = m_level.offset(push.direction);
+        const auto isEntrance = [&](const int index) {
+            return std::any_of(m_rooms.begin(), m_rooms.end(), [&](const GoalRoom& room) {
+                return room.entrance == index && room.direction == push.direction;
+                });
+        };
+
+        // The player stands in the tunnel behind the box: keep pushing while the box is in it
+        if (isTunnel(push.box, push.direction)) {
+            while (isTunnel(result.target, push.direction) && !m_level.isGoal(result.target) &&
+                !isEntrance(result.target)) {
+                const auto next = result.target + offset;
+                if (m_level.isWall(next) || boxes[next]) {
+                    break;
+                }
+                result.target = next;
+            }
+        }
+
+        // A box on a room entrance goes straight to the next storage in the room's fill order, as
+        // long as the room holds exactly the boxes of that order so far
+        for (const auto& room : m_rooms) {
+            if (room.entrance != result.target || room.direction != push.direction) {
+                continue;
+            }
+
+            const auto filled = static_cast<int>(std::count_if(room.cells.begin(), room.cells.end(),
+                [&](const int cell) { return boxes[cell] != 0; }));
+            const auto inOrder = std::all_of(room.order.begin(), room.order.begin() + std::min(
+                filled, static_cast<int>(room.order.size())), [&](const int goal) {
+                    return boxes[goal] != 0;
+                });
+            if (inOrder && filled < static_cast<int>(room.order.size())) {
+                result.target = room.order[filled];
+                result.path = room.paths[filled];
+            }
+            break;
+        }
+
+        return result;
+    }
+
+    std::vector<Direction> SokobanMacros::expand(const Push& push) const {
+        std::vector<Direction> pushes;
+        const auto offset = m_level.offset(push.direction);
+        const auto straightEnd = push.path >= 0 ? m_rooms[m_roomOfCell[push.target]].entrance
+            : push.target;
+        for (auto cell = push.box; cell != straightEnd; cell += offset) {
+            pushes.push_back(push.direction);
+        }
+        if (push.path >= 0) {
+            const auto& path = m_paths[push.path];
+            pushes.insert(pushes.end(), path.begin(), path.end());
+        }
+
+        return pushes;
+    }
+
+    int SokobanMacros::pushCount(const Push& push) const {
+        const auto straightEnd = push.path >= 0 ? m_rooms[m_roomOfCell[push.target]].entrance
+            : push.target;
+        const auto straight = (straightEnd - push.box) / m_level.offset(push.direction);
+        return straight + (push.path >= 0 ? static_cast<int>(m_paths[push.path].size()) : 0);
+    }
+
+    Direction SokobanMacros::lastDirection(const Push& push) const {
+        return push.path >= 0 && !m_paths[push.path].empty() ? m_paths[push.path].back()
+            : push.direction;
+    }
+
+    void SokobanMacros::findGoalRooms() {
+        std::vector<char> isInitial(m_level.size(), 0);
+        for (const auto box : m_level.initialBoxes()) {
+            isInitial[box] = 1;
+        }
+        isInitial[m_level.initialPlayer()] = 1;
+
+        // Every corridor cell is a candidate entrance in both directions along the corridor. The
+        // side it leads to is a room if it is cut off from the other side, holds storages and holds
+        // neither boxes nor the player.
+        std::vector<GoalRoom> candidates;
+        std::vector<int> seen(m_level.size(), -1);
+        auto stamp = 0;
+        for (int entrance{ 0 }; entrance < m_level.size(); ++entrance) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                if (m_level.isWall(entrance) || !isTunnel(entrance, direction) ||
+                    m_level.isGoal(entrance)) {
+                    continue;
+                }
+
+                const auto inside = entrance + m_level.offset(direction);
+                const auto outside = entrance - m_level.offset(direction);
+                if (m_level.isWall(inside) || m_level.isWall(outside)) {
+                    continue;
+                }
+
+                ++stamp;
+                seen[entrance] = stamp;
+                seen[inside] = stamp;
+                std::vector<int> cells{ inside };
+                auto isRoom = true;
+                for (size_t head{ 0 }; isRoom && head < cells.size(); ++head) {
+                    const auto cell = cells[head];
+                    isRoom = cell != outside && !isInitial[cell] &&
+                        static_cast<int>(cells.size()) <= MAX_ROOM_CELLS;
+                    for (const auto next : SokobanLevel::DIRECTIONS) {
+                        const auto neighbor = cell + m_level.offset(next);
+                        if (!m_level.isWall(neighbor) && seen[neighbor] != stamp) {
+                            seen[neighbor] = stamp;
+                            cells.push_back(neighbor);
+                        }
+                    }
+                }
+
+                if (isRoom && std::any_of(cells.begin(), cells.end(),
+                    [&](const int cell) { return m_level.isGoal(cell); })) {
+                    candidates.push_back({ entrance, direction, cells, {}, {} });
+                }
+            }
+        }
+
+        // Prefer the innermost entrance: smaller rooms first, and each storage joins one room only
+        std::stable_sort(candidates.begin(), candidates.end(),
+            [](const GoalRoom& first, const GoalRoom& second) {
+                return first.cells.size() < second.cells.size();
+            });
+        for (auto& room : candidates) {
+            const auto isTaken = std::any_of(room.cells.begin(), room.cells.end(),
+                [&](const int cell) { return m_roomOfCell[cell] >= 0; });
+            if (isTaken || !planGoalRoom(room)) {
+                continue;
+            }
+
+            for (const auto cell : room.cells) {
+                m_roomOfCell[cell] = static_cast<int>(m_rooms.size());
+            }
+            m_rooms.push_back(room);
+        }
+    }
+
+    bool SokobanMacros::planGoalRoom(GoalRoom& room) {
+        // Number the room cells, then the entrance, then the cell outside it
+        m_roomCells = room.cells;
+        m_roomCells.push_back(room.entrance);
+        m_roomCells.push_back(room.entrance - m_level.offset(room.direction));
+        for (size_t local{ 0 }; local < m_roomCells.size(); ++local) {
+            m_localOf[m_roomCells[local]] = static_cast<int>(local);
+        }
+
+        const auto isPlanned = planFillOrder(room);
+        for (const auto cell : m_roomCells) {
+            m_localOf[cell] = -1;
+        }
+
+        return isPlanned;
+    }
+
+    bool SokobanMacros::planFillOrder(GoalRoom& room) {
+        std::vector<int> remaining;
+        for (const auto cell : room.cells) {
+            if (m_level.isGoal(cell)) {
+                remaining.push_back(cell);
+            }
+        }
+
+        // Fill the deepest storage first, but only if every other storage stays reachable
+        std::vector<char> boxes(m_level.size(), 0);
+        std::vector<std::vector<Direction>> paths;
+        while (!remaining.empty()) {
+            auto best = -1;
+            std::vector<Direction> bestPath;
+            for (const auto goal : remaining) {
+                std::vector<Direction> path;
+                if (!findRoomPath(room, boxes, goal, path) ||
+                    (best >= 0 && path.size() <= bestPath.size())) {
+                    continue;
+                }
+
+                boxes[goal] = 1;
+                std::vector<Direction> unused;
+                const auto keepsOthersReachable = std::all_of(remaining.begin(), remaining.end(),
+                    [&](const int other) {
+                        return other == goal || findRoomPath(room, boxes, other, unused);
+                    });
+                boxes[goal] = 0;
+
+                if (keepsOthersReachable) {
+                    best = goal;
+                    bestPath = path;
+                }
+            }
+            if (best < 0) {
+                return false;
+            }
+
+            boxes[best] = 1;
+            room.order.push_back(best);
+            paths.push_back(bestPath);
+            remaining.erase(std::find(remaining.begin(), remaining.end(), best));
+        }
+
+        for (auto& path : paths) {
+            room.paths.push_back(static_cast<int>(m_paths.size()));
+            m_paths.push_back(std::move(path));
+        }
+
+        return true;
+    }
+
+    bool SokobanMacros::findRoomPath(const GoalRoom& room, const std::vector<char>& boxes,
+        const int goal, std::vector<Direction>& pushes) const {
+        const auto outside = room.entrance - m_level.offset(room.direction);
+        const auto cellCount = static_cast<int>(m_roomCells.size());
+        const auto localOf = [&](const int cell) { return m_localOf[cell]; };
+
+        // Breadth-first search over (box, player) pairs with single player steps
+        struct Step {
+            int previous;
+            Direction direction;
+            bool isPush;
+        };
+        std::vector<int> visited(cellCount * cellCount, -1);
+        std::vector<Step> steps;
+        std::vector<std::pair<int, int>> queue;
+
+        const auto start = localOf(room.entrance) * cellCount + localOf(outside);
+        visited[start] = 0;
+        steps.push_back({ -1, room.direction, false });
+        queue.emplace_back(room.entrance, outside);
+
+        for (size_t head{ 0 }; head < queue.size(); ++head) {
+            const auto [box, player] = queue[head];
+            if (box == goal) {
+                pushes.clear();
+                for (auto step = static_cast<int>(head); steps[step].previous >= 0;
+                    step = steps[step].previous) {
+                    if (steps[step].isPush) {
+                        pushes.push_back(steps[step].direction);
+                    }
+                }
+                std::reverse(pushes.begin(), pushes.end());
+                return true;
+            }
+
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                auto nextPlayer = player + m_level.offset(direction);
+                auto nextBox = box;
+                const auto isPush = nextPlayer == box;
+                if (isPush) {
+                    nextBox = box + m_level.offset(direction);
+                    if (nextBox == outside) {
+                        continue;
+                    }
+                }
+
+                const auto target = isPush ? nextBox : nextPlayer;
+                const auto local = localOf(target);
+                if (local < 0 || m_level.isWall(target) || boxes[target]) {
+                    continue;
+                }
+
+                const auto state = localOf(nextBox) * cellCount + localOf(nextPlayer);
+                if (visited[state] >= 0) {
+                    continue;
+                }
+
+                visited[state] = static_cast<int>(queue.size());
+                steps.push_back({ static_cast<int>(head), direction, isPush });
+                queue.emplace_back(nextBox, nextPlayer);
+            }
+        }
+
+        return false;
+    }
+
+}  // namespace SB
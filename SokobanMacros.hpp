@@ -0,0 +1,147 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANMACROS_HPP
+#define SOKOBANMACROS_HPP
+
+#include <vector>
+#include "SokobanLevel.hpp"
+#include "SokobanSearch.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Macro moves computed from the static wall layout when a level loads.
+     *
+     * A tunnel is a run of cells that are one tile wide across the push axis. Once the player has
+     * followed a box into a tunnel, the only useful thing left to do is to keep pushing, so a push into
+     * a tunnel is extended until the box leaves it (or reaches a storage).
+     *
+     * A goal room is an area with storages that can only be entered through one corridor cell, its
+     * entrance. For each room a fill order is precomputed (deepest storage first, keeping the rest
+     * reachable) along with the push sequence that takes a box from the entrance to the next storage
+     * in that order. A box pushed onto the entrance is then moved straight to its storage.
+     */
+    class SokobanMacros {
+    public:
+        /**
+         * @brief Creates macros for an empty level.
+         */
+        SokobanMacros() = default;
+
+        /**
+         * @brief Finds the tunnels and goal rooms of a level.
+         * @param level The level to analyze.
+         */
+        explicit SokobanMacros(const SokobanLevel& level);
+
+        /**
+         * @brief Returns true if a cell is one tile wide across the axis of a direction.
+         */
+        [[nodiscard]] bool isTunnel(int index, Direction direction) const;
+
+        /**
+         * @brief Returns the number of goal rooms found.
+         */
+        [[nodiscard]] int goalRoomCount() const;
+
+        /**
+         * @brief Extends a single push into a macro push where one applies.
+         * @param boxes One flag per cell; set for cells holding a box before the push.
+         * @param push A single push (`target` is the cell next to `box`).
+         * @return The push itself, or a macro push with a farther target.
+         */
+        [[nodiscard]] Push extend(const std::vector<char>& boxes, const Push& push) const;
+
+        /**
+         * @brief Returns the direction of each single push that makes up a push.
+         */
+        [[nodiscard]] std::vector<Direction> expand(const Push& push) const;
+
+        /**
+         * @brief Returns the number of single pushes that make up a push.
+         */
+        [[nodiscard]] int pushCount(const Push& push) const;
+
+        /**
+         * @brief Returns the direction of the last single push of a push. The player ends up next
+         * to the box on the opposite side.
+         */
+        [[nodiscard]] Direction lastDirection(const Push& push) const;
+
+    private:
+        /**
+         * @brief A goal room with its fill order.
+         */
+        struct GoalRoom {
+            int entrance;
+            Direction direction;
+            std::vector<int> cells;
+            std::vector<int> order;
+            std::vector<int> paths;
+        };
+
+        /**
+         * @brief Finds goal rooms and their fill orders.
+         */
+        void findGoalRooms();
+
+        /**
+         * @brief Numbers the cells of a room and computes its fill order.
+         * @return False if no order fills every storage of the room.
+         */
+        bool planGoalRoom(GoalRoom& room);
+
+        /**
+         * @brief Computes the fill order of a room whose cells have been numbered.
+         * @return False if no order fills every storage of the room.
+         */
+        bool planFillOrder(GoalRoom& room);
+
+        /**
+         * @brief Finds the push sequence that takes a box from the entrance of a room to a storage,
+         * with boxes on the given cells. The room's cells must have been numbered.
+         * @return True and the pushes if the storage can be reached.
+         */
+        bool findRoomPath(const GoalRoom& room, const std::vector<char>& boxes, int goal,
+            std::vector<Direction>& pushes) const;
+
+        /**
+         * @brief The level.
+         */
+        SokobanLevel m_level;
+
+        /**
+         * @brief Per cell: bit 0 if one tile wide vertically (walls left and right), bit 1 if one
+         * tile wide horizontally (walls above and below).
+         */
+        std::vector<char> m_tunnelFlags;
+
+        /**
+         * @brief Per cell: the goal room the cell belongs to, or -1.
+         */
+        std::vector<int> m_roomOfCell;
+
+        /**
+         * @brief The goal rooms.
+         */
+        std::vector<GoalRoom> m_rooms;
+
+        /**
+         * @brief The push sequences of goal room macros.
+         */
+        std::vector<std::vector<Direction>> m_paths;
+
+        /**
+         * @brief The cells of the room being planned: its cells, its entrance and the cell outside.
+         */
+        std::vector<int> m_roomCells;
+
+        /**
+         * @brief Per cell: its number in `m_roomCells`, or -1.
+         */
+        std::vector<int> m_localOf;
+    };
+
+}  // namespace SB
+
+#endif
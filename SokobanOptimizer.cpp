@@ -0,0 +1,368 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanOptimizer.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <string_view>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "SokobanParallel.hpp"
+#include "SokobanSearch.hpp"
+#include "SokobanSolution.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The weight of the primary count in a cost; the secondary count breaks ties.
+         */
+        constexpr int64_t PRIMARY_WEIGHT = int64_t{ 1 } << 20;
+
+        /**
+         * @brief A window that can be replaced by cheaper moves.
+         */
+        struct Improvement {
+            int first;
+            int last;
+            std::string moves;
+            int64_t gain = 0;
+            uint64_t key = 0;
+        };
+
+        /**
+         * @brief Returns the moves of a solution without the whitespace around and between them.
+         */
+        std::string withoutSpaces(const std::string& solution) {
+            std::string moves;
+            std::copy_if(solution.begin(), solution.end(), std::back_inserter(moves),
+                [](const char lurd) { return std::isspace(static_cast<unsigned char>(lurd)) == 0; });
+            return moves;
+        }
+
+    }  // namespace
+
+    SokobanOptimizer::SokobanOptimizer(const OptimizerOptions& options) : m_options(options) {}
+
+    OptimizerResult SokobanOptimizer::optimize(const SokobanLevel& level,
+        const std::string& solution) const {
+        // Rewrite the solution with the case of each move telling whether it pushes
+        OptimizerResult result;
+        std::string current;
+        {
+            const auto moves = withoutSpaces(solution);
+            result.movesBefore = static_cast<int>(moves.size());
+            const auto positions = replay(level, moves);
+            for (size_t push{ 1 }; push < positions.size(); ++push) {
+                const auto& position = positions[push];
+                for (auto move = positions[push - 1].move; move < position.move; ++move) {
+                    current.push_back(toLurd(fromLurd(moves[move]), move + 1 == position.move));
+                }
+            }
+        }
+
+        const auto countPushes = [](const std::string& moves) {
+            return static_cast<int>(std::count_if(moves.begin(), moves.end(),
+                [](const char lurd) { return std::isupper(lurd) != 0; }));
+        };
+        result.pushesBefore = countPushes(current);
+
+        // Windows that had nothing cheaper, by start position and moves; later passes skip them
+        std::unordered_set<uint64_t> exhausted;
+        const auto windowKey = [](const Position& position, const std::string_view moves) {
+            auto key = playerHash(position.player) ^ std::hash<std::string_view>{}(moves);
+            for (const auto box : position.boxes) {
+                key ^= boxHash(box);
+            }
+            return key;
+        };
+
+        const auto window = std::max(m_options.windowPushes, 1);
+        for (;;) {
+            const auto positions = replay(level, current);
+            const auto pushCount = static_cast<int>(positions.size()) - 1;
+            const auto windowCount = std::max(pushCount - window, 0) + 1;
+
+            std::vector<Improvement> improvements(windowCount);
+            parallelFor(windowCount, [&](const int first) {
+                const auto last = std::min(first + window, pushCount);
+                const auto begin = positions[first].move;
+                const auto end = positions[last].move;
+
+                std::vector<int> movable;
+                for (auto push = first + 1; push <= last; ++push) {
+                    movable.push_back(positions[push].movedBox);
+                }
+                std::sort(movable.begin(), movable.end());
+                movable.erase(std::unique(movable.begin(), movable.end()), movable.end());
+
+                const auto segment = std::string_view{ current }.substr(begin, end - begin);
+                const auto key = windowKey(positions[first], segment);
+                if (exhausted.count(key) != 0) {
+                    return;
+                }
+
+                const auto limit = cost(segment);
+                const auto moves = searchWindow(level, positions[first], positions[last], movable,
+                    limit);
+                improvements[first] = { first, last, moves.value_or(""), 0, key };
+                if (moves.has_value()) {
+                    improvements[first].gain = limit - cost(*moves);
+                }
+                }, m_options.threads);
+
+            for (const auto& improvement : improvements) {
+                if (improvement.key != 0) {
+                    ++result.windowsSearched;
+                    if (improvement.gain <= 0) {
+                        exhausted.insert(improvement.key);
+                    }
+                }
+            }
+
+            // Apply the best improvements that don't overlap, from the largest gain down
+            std::sort(improvements.begin(), improvements.end(),
+                [](const Improvement& first, const Improvement& second) {
+                    return first.gain > second.gain;
+                });
+            std::vector<const Improvement*> applied;
+            for (const auto& improvement : improvements) {
+                if (improvement.gain <= 0) {
+                    break;
+                }
+
+                const auto overlaps = std::any_of(applied.begin(), applied.end(),
+                    [&](const Improvement* other) {
+                        return improvement.first < other->last && other->first < improvement.last;
+                    });
+                if (!overlaps) {
+                    applied.push_back(&improvement);
+                }
+            }
+            if (applied.empty()) {
+                break;
+            }
+            result.windowsImproved += static_cast<int64_t>(applied.size());
+
+            std::sort(applied.begin(), applied.end(),
+                [](const Improvement* first, const Improvement* second) {
+                    return first->first < second->first;
+                });
+            std::string next;
+            auto copied = 0;
+            for (const auto* improvement : applied) {
+                next.append(current, copied, positions[improvement->first].move - copied);
+                next.append(improvement->moves);
+                copied = positions[improvement->last].move;
+            }
+            next.append(current, copied, std::string::npos);
+            current = std::move(next);
+        }
+
+        result.solution = current;
+        result.moves = static_cast<int>(current.size());
+        result.pushes = countPushes(current);
+        return result;
+    }
+
+    OptimizerResult SokobanOptimizer::measure(const SokobanLevel& level,
+        const std::string& solution) {
+        const auto moves = withoutSpaces(solution);
+        OptimizerResult result;
+        result.movesBefore = static_cast<int>(moves.size());
+        result.pushesBefore = static_cast<int>(replay(level, moves).size()) - 1;
+        return result;
+    }
+
+    std::vector<SokobanOptimizer::Position> SokobanOptimizer::replay(const SokobanLevel& level,
+        const std::string& solution) {
+        auto boxes = level.initialBoxes();
+        std::vector<int> boxAt(level.size(), -1);
+        for (int box{ 0 }; box < static_cast<int>(boxes.size()); ++box) {
+            boxAt[boxes[box]] = box;
+        }
+
+        auto player = level.initialPlayer();
+        std::vector<Position> positions{ { boxes, player, 0, -1 } };
+        for (int move{ 0 }; move < static_cast<int>(solution.size()); ++move) {
+            const auto offset = level.offset(fromLurd(solution[move]));
+            const auto next = player + offset;
+            if (level.isWall(next)) {
+                throw std::invalid_argument("Solution walks into a wall");
+            }
+
+            player = next;
+            const auto box = boxAt[next];
+            if (box < 0) {
+                continue;
+            }
+
+            const auto beyond = next + offset;
+            if (level.isWall(beyond) || boxAt[beyond] >= 0) {
+                throw std::invalid_argument("Solution pushes a box into a wall or another box");
+            }
+            boxAt[next] = -1;
+            boxAt[beyond] = box;
+            boxes[box] = beyond;
+            positions.push_back({ boxes, player, move + 1, box });
+        }
+
+        const auto onGoals = std::count_if(boxes.begin(), boxes.end(),
+            [&](const int cell) { return level.isGoal(cell); });
+        if (static_cast<size_t>(onGoals) < std::min(boxes.size(), level.goals().size())) {
+            throw std::invalid_argument("Solution does not win the level");
+        }
+
+        return positions;
+    }
+
+    int64_t SokobanOptimizer::cost(const bool isPush) const {
+        if (m_options.objective == Objective::Moves) {
+            return PRIMARY_WEIGHT + (isPush ? 1 : 0);
+        }
+
+        return 1 + (isPush ? PRIMARY_WEIGHT : 0);
+    }
+
+    int64_t SokobanOptimizer::cost(const std::string_view moves) const {
+        int64_t total{ 0 };
+        for (const auto lurd : moves) {
+            total += cost(std::isupper(lurd) != 0);
+        }
+
+        return total;
+    }
+
+    std::optional<std::string> SokobanOptimizer::searchWindow(const SokobanLevel& level,
+        const Position& from, const Position& to, const std::vector<int>& movable,
+        const int64_t limit) const {
+        // Boxes that don't move in the window are walls for the search
+        std::vector<char> isFixed(level.size(), 0);
+        for (const auto box : from.boxes) {
+            isFixed[box] = 1;
+        }
+        std::vector<int> start;
+        std::vector<int> target;
+        for (const auto box : movable) {
+            isFixed[from.boxes[box]] = 0;
+            start.push_back(from.boxes[box]);
+            target.push_back(to.boxes[box]);
+        }
+        std::sort(start.begin(), start.end());
+        std::sort(target.begin(), target.end());
+
+        // Lower bound: every push moves one box one cell closer at best, every move the player
+        const auto stride = level.stride();
+        const auto distance = [stride](const int first, const int second) {
+            return std::abs(first % stride - second % stride) + std::abs(first / stride -
+                second / stride);
+        };
+        const auto estimate = [&](const int player, const int* boxes, const ptrdiff_t count) {
+            int64_t boxDistance{ 0 };
+            for (ptrdiff_t i{ 0 }; i < count; ++i) {
+                auto nearest = INT_MAX;
+                for (const auto cell : target) {
+                    nearest = std::min(nearest, distance(boxes[i], cell));
+                }
+                boxDistance += nearest;
+            }
+            const auto moveDistance = std::max<int64_t>(boxDistance, distance(player, to.player));
+            return m_options.objective == Objective::Moves ?
+                moveDistance * PRIMARY_WEIGHT + boxDistance :
+                boxDistance * PRIMARY_WEIGHT + moveDistance;
+        };
+
+        // A* over (player, movable boxes); box cells are pooled per node
+        struct Node {
+            int parent;
+            char lurd;
+            int player;
+            int64_t cost;
+        };
+        const auto boxCount = static_cast<ptrdiff_t>(start.size());
+        const auto keyOf = [](const int player, const int* boxes, const ptrdiff_t count) {
+            auto key = playerHash(player);
+            for (ptrdiff_t i{ 0 }; i < count; ++i) {
+                key ^= boxHash(boxes[i]);
+            }
+            return key;
+        };
+
+        std::vector<Node> nodes{ { -1, 0, from.player, 0 } };
+        std::vector<int> boxPool{ start };
+        std::unordered_map<uint64_t, int64_t> best{ { keyOf(from.player, start.data(), boxCount),
+                                                      0 } };
+        using Entry = std::pair<int64_t, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+        open.push({ estimate(from.player, start.data(), boxCount), 0 });
+
+        std::vector<int> boxes(boxCount);
+        while (!open.empty() && static_cast<int>(nodes.size()) < m_options.maxNodes) {
+            const auto [bound, id] = open.top();
+            open.pop();
+            if (bound >= limit) {
+                break;
+            }
+
+            const auto node = nodes[id];
+            const auto nodeCost = node.cost;
+            std::copy_n(boxPool.begin() + id * boxCount, boxCount, boxes.begin());
+            if (nodeCost > best[keyOf(node.player, boxes.data(), boxCount)]) {
+                continue;
+            }
+
+            if (node.player == to.player && boxes == target) {
+                std::string moves;
+                for (auto step = id; nodes[step].parent >= 0; step = nodes[step].parent) {
+                    moves.push_back(nodes[step].lurd);
+                }
+                std::reverse(moves.begin(), moves.end());
+                return moves;
+            }
+
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto offset = level.offset(direction);
+                const auto next = node.player + offset;
+                if (level.isWall(next) || isFixed[next]) {
+                    continue;
+                }
+
+                const auto pushed = std::find(boxes.begin(), boxes.end(), next);
+                const auto isPush = pushed != boxes.end();
+                if (isPush && (level.isWall(next + offset) || isFixed[next + offset] ||
+                    std::find(boxes.begin(), boxes.end(), next + offset) != boxes.end())) {
+                    continue;
+                }
+
+                const auto childCost = nodeCost + cost(isPush);
+                const auto childId = static_cast<int>(nodes.size());
+                boxPool.insert(boxPool.end(), boxes.begin(), boxes.end());
+                const auto childBoxes = boxPool.begin() + childId * boxCount;
+                if (isPush) {
+                    childBoxes[pushed - boxes.begin()] = next + offset;
+                    std::sort(childBoxes, childBoxes + boxCount);
+                }
+
+                const auto [found, isNew] = best.try_emplace(
+                    keyOf(next, &*childBoxes, boxCount), childCost);
+                if (!isNew && found->second <= childCost) {
+                    boxPool.resize(boxPool.size() - boxCount);
+                    continue;
+                }
+                found->second = childCost;
+
+                nodes.push_back({ id, toLurd(direction, isPush), next, childCost });
+                open.push({ childCost + estimate(next, &*childBoxes, boxCount), childId });
+            }
+        }
+
+        return std::nullopt;
+    }
+
+}  // namespace SB
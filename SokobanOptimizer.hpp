@@ -0,0 +1,149 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANOPTIMIZER_HPP
+#define SOKOBANOPTIMIZER_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief What a shorter solution means.
+     */
+    enum class Objective {
+        /**
+         * @brief Fewest moves, then fewest pushes.
+         */
+        Moves,
+
+        /**
+         * @brief Fewest pushes, then fewest moves.
+         */
+        Pushes
+    };
+
+    /**
+     * @brief Parameters of the optimizer.
+     */
+    struct OptimizerOptions {
+        Objective objective = Objective::Moves;
+
+        /**
+         * @brief The number of pushes a window spans.
+         */
+        int windowPushes = 10;
+
+        /**
+         * @brief The number of positions a window search may visit before it gives up.
+         */
+        int maxNodes = 20000;
+
+        /**
+         * @brief The number of threads windows are searched on; 0 means `defaultThreadCount()`.
+         */
+        unsigned threads = 0;
+    };
+
+    /**
+     * @brief The outcome of an optimization.
+     */
+    struct OptimizerResult {
+        std::string solution;
+        int movesBefore = 0;
+        int pushesBefore = 0;
+        int moves = 0;
+        int pushes = 0;
+        int64_t windowsSearched = 0;
+        int64_t windowsImproved = 0;
+    };
+
+    /**
+     * @brief Shortens solutions by re-searching windows along them.
+     *
+     * A window is the part of a solution between two positions a few pushes apart. The optimizer
+     * searches the moves between those two positions exactly, letting only the boxes that move in
+     * the window move, and replaces the window when it finds a cheaper path. All windows of a pass
+     * are searched in parallel; the best non-overlapping improvements are applied, and passes repeat
+     * until none is found, skipping windows already searched in vain. Moves after the last push are
+     * dropped.
+     */
+    class SokobanOptimizer {
+    public:
+        /**
+         * @brief Creates an optimizer.
+         * @param options The optimizer parameters.
+         */
+        explicit SokobanOptimizer(const OptimizerOptions& options = {});
+
+        /**
+         * @brief Shortens a solution of a level.
+         * @param level The level.
+         * @param solution A LURD solution that wins the level.
+         * @return The shorter solution, which also wins the level, and its counts.
+         * @throws std::invalid_argument if the solution walks into a wall, pushes a box into a wall
+         * or another box, or doesn't win the level.
+         */
+        [[nodiscard]] OptimizerResult optimize(const SokobanLevel& level,
+            const std::string& solution) const;
+
+        /**
+         * @brief Replays a solution of a level and counts its moves and pushes, as `optimize`
+         * reports them before shortening, e.g. to compare it with a stored result.
+         * @return The counts in `movesBefore` and `pushesBefore`; the other fields are left empty.
+         * @throws std::invalid_argument if the solution is not valid, as `optimize` does.
+         */
+        [[nodiscard]] static OptimizerResult measure(const SokobanLevel& level,
+            const std::string& solution);
+
+    private:
+        /**
+         * @brief A position after a push: the box cells by box, the player cell, and where the
+         * position is in the move list.
+         */
+        struct Position {
+            std::vector<int> boxes;
+            int player;
+            int move;
+            int movedBox;
+        };
+
+        /**
+         * @brief Replays a solution and returns the position after each push, the start first.
+         * @throws std::invalid_argument if the solution is not valid.
+         */
+        [[nodiscard]] static std::vector<Position> replay(const SokobanLevel& level,
+            const std::string& solution);
+
+        /**
+         * @brief Returns the cost of a move under the objective.
+         */
+        [[nodiscard]] int64_t cost(bool isPush) const;
+
+        /**
+         * @brief Returns the cost of a run of moves under the objective.
+         */
+        [[nodiscard]] int64_t cost(std::string_view moves) const;
+
+        /**
+         * @brief Searches the cheapest moves from one position to another, moving only some boxes.
+         * @param movable The boxes that may move.
+         * @return The moves, or nothing if none cheaper than `limit` were found.
+         */
+        [[nodiscard]] std::optional<std::string> searchWindow(const SokobanLevel& level,
+            const Position& from, const Position& to, const std::vector<int>& movable,
+            int64_t limit) const;
+
+        /**
+         * @brief The optimizer parameters.
+         */
+        OptimizerOptions m_options;
+    };
+
+}  // namespace SB
+
+#endif
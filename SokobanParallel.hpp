@@ -0,0 +1,54 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANPARALLEL_HPP
+#define SOKOBANPARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace SB {
+
+    /**
+     * @brief Returns the number of worker threads to use when the caller doesn't specify one.
+     */
+    inline unsigned defaultThreadCount() {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    /**
+     * @brief Calls `function(i)` for every i in [0, count) on a group of threads. Items are handed out
+     * one at a time, so uneven items balance out. Returns when every call has finished.
+     * @param count The number of items.
+     * @param function The function to call; it must be safe to call concurrently.
+     * @param threadCount The number of threads; 0 means `defaultThreadCount()`.
+     */
+    template <typename Function>
+    void parallelFor(const int count, Function&& function, unsigned threadCount = 0) {
+        if (threadCount == 0) {
+            threadCount = defaultThreadCount();
+        }
+        threadCount = std::min(threadCount, static_cast<unsigned>(std::max(count, 1)));
+
+        std::atomic<int> next{ 0 };
+        const auto work = [&]() {
+            for (auto i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                function(i);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned i{ 1 }; i < threadCount; ++i) {
+            threads.emplace_back(work);
+        }
+        work();
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+}  // namespace SB
+
+#endif
@@ -2,18 +2,18 @@
 
 #include "SokobanPlayer.hpp"
 #include <memory>
+#include "SokobanAssets.hpp"
 
 namespace SB {
 
     SokobanPlayer::SokobanPlayer() {
-        const auto playerUpTexture{ std::make_shared<sf::Texture>() };
-        const auto playerRightTexture{ std::make_shared<sf::Texture>() };
-        const auto playerDownTexture{ std::make_shared<sf::Texture>() };
-        const auto playerLeftTexture{ std::make_shared<sf::Texture>() };
-        playerUpTexture->loadFromFile(TILE_PLAYER_08_FILENAME);
-        playerRightTexture->loadFromFile(TILE_PLAYER_17_FILENAME);
-        playerDownTexture->loadFromFile(TILE_PLAYER_05_FILENAME);
-        playerLeftTexture->loadFromFile(TILE_PLAYER_20_FILENAME);
+        // The textures load in the background; until then the player is a flat color
+        auto& assets = SokobanAssets::instance();
+        const sf::Color placeholder{ 50, 90, 200 };
+        const auto playerUpTexture = assets.texture(TILE_PLAYER_08_FILENAME, placeholder);
+        const auto playerRightTexture = assets.texture(TILE_PLAYER_17_FILENAME, placeholder);
+        const auto playerDownTexture = assets.texture(TILE_PLAYER_05_FILENAME, placeholder);
+        const auto playerLeftTexture = assets.texture(TILE_PLAYER_20_FILENAME, placeholder);
 
         m_playerTextureMap[Direction::Up] = { playerUpTexture };
         m_playerTextureMap[Direction::Right] = { playerRightTexture };
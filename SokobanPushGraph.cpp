@@ -0,0 +1,130 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanPushGraph.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace SB {
+
+    SokobanPushGraph::SokobanPushGraph(const SokobanLevel& level)
+        : m_level(level), m_occupancy(level.size(), 0), m_reached(level.size(), 0),
+          m_parents(level.size(), -1) {}
+
+    const SokobanLevel& SokobanPushGraph::level() const { return m_level; }
+
+    std::vector<Push> SokobanPushGraph::pushes(const SearchState& state) {
+        static_cast<void>(reach(state));
+
+        std::vector<Push> pushes;
+        for (const auto box : state.boxes) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto offset = m_level.offset(direction);
+                const auto target = box + offset;
+                if (m_reached[box - offset] == m_stamp && !m_level.isWall(target) &&
+                    !m_occupancy[target]) {
+                    pushes.push_back({ box, direction, target });
+                }
+            }
+        }
+
+        clear(state);
+        return pushes;
+    }
+
+    SearchState SokobanPushGraph::apply(const SearchState& state, const Push& push) const {
+        auto boxes = state.boxes;
+        auto it = std::lower_bound(boxes.begin(), boxes.end(), push.box);
+        if (it == boxes.end() || *it != push.box) {
+            throw std::invalid_argument("No box to push on cell " + std::to_string(push.box));
+        }
+
+        // Move the box to its new cell and shift it into order
+        *it = push.target;
+        if (push.target > push.box) {
+            std::rotate(it, it + 1, std::upper_bound(it + 1, boxes.end(), push.target));
+        }
+        else {
+            std::rotate(std::upper_bound(boxes.begin(), it, push.target), it, it + 1);
+        }
+
+        return { std::move(boxes), push.target - m_level.offset(push.direction) };
+    }
+
+    std::vector<Direction> SokobanPushGraph::walk(const SearchState& state, const Push& push) {
+        static_cast<void>(reach(state));
+
+        const auto offset = m_level.offset(push.direction);
+        const auto behind = push.box - offset;
+        const auto isPush = m_occupancy[push.box] && push.target == push.box + offset &&
+            m_reached[behind] == m_stamp && !m_level.isWall(push.target) &&
+            !m_occupancy[push.target];
+        clear(state);
+        if (!isPush) {
+            throw std::invalid_argument("Push not available from cell " +
+                std::to_string(push.box));
+        }
+
+        // Follow the flood fill back from the cell behind the box, then turn the cells into steps
+        std::vector<Direction> moves{ push.direction };
+        for (auto cell = behind; cell != state.player; cell = m_parents[cell]) {
+            const auto step = cell - m_parents[cell];
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                if (m_level.offset(direction) == step) {
+                    moves.push_back(direction);
+                    break;
+                }
+            }
+        }
+        std::reverse(moves.begin(), moves.end());
+
+        return moves;
+    }
+
+    int SokobanPushGraph::normalizedPlayer(const SearchState& state) {
+        const auto normalizedPlayer = reach(state);
+        clear(state);
+        return normalizedPlayer;
+    }
+
+    bool SokobanPushGraph::isSolved(const SearchState& state) const {
+        const auto target = std::min(state.boxes.size(), m_level.goals().size());
+        const auto onGoals = std::count_if(state.boxes.begin(), state.boxes.end(),
+            [&](const int box) { return m_level.isGoal(box); });
+        return static_cast<size_t>(onGoals) >= target;
+    }
+
+    int SokobanPushGraph::reach(const SearchState& state) {
+        for (const auto box : state.boxes) {
+            m_occupancy[box] = 1;
+        }
+
+        ++m_stamp;
+        m_queue.assign(1, state.player);
+        m_reached[state.player] = m_stamp;
+        m_parents[state.player] = state.player;
+        auto normalizedPlayer = state.player;
+        for (size_t head{ 0 }; head < m_queue.size(); ++head) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto next = m_queue[head] + m_level.offset(direction);
+                if (!m_level.isWall(next) && !m_occupancy[next] && m_reached[next] != m_stamp) {
+                    m_reached[next] = m_stamp;
+                    m_parents[next] = m_queue[head];
+                    normalizedPlayer = std::min(normalizedPlayer, next);
+                    m_queue.push_back(next);
+                }
+            }
+        }
+
+        return normalizedPlayer;
+    }
+
+    void SokobanPushGraph::clear(const SearchState& state) {
+        for (const auto box : state.boxes) {
+            m_occupancy[box] = 0;
+        }
+    }
+
+}  // namespace SB
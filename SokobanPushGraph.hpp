@@ -0,0 +1,93 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANPUSHGRAPH_HPP
+#define SOKOBANPUSHGRAPH_HPP
+
+#include <vector>
+#include "SokobanConstants.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanSearch.hpp"
+
+namespace SB {
+
+    /**
+     * @brief A level seen as a graph of positions linked by single pushes, for tools that reason
+     * about pushes rather than steps.
+     *
+     * `pushes` lists the pushes of a position: a box, a direction, and the cell the box ends on, for
+     * every box the player can walk behind and push into a free cell. Listing them takes one flood
+     * fill of the player's area. The steps that walk the player to a push are only searched for
+     * when `walk` asks for them. Positions keep their boxes in ascending order, as `SearchState`
+     * does everywhere.
+     *
+     * The graph keeps scratch space, so each thread needs a graph of its own.
+     */
+    class SokobanPushGraph {
+    public:
+        /**
+         * @brief Creates the graph of a level.
+         */
+        explicit SokobanPushGraph(const SokobanLevel& level);
+
+        /**
+         * @brief Returns the level.
+         */
+        [[nodiscard]] const SokobanLevel& level() const;
+
+        /**
+         * @brief Lists the pushes the player can make from a position, walking first if needed.
+         */
+        [[nodiscard]] std::vector<Push> pushes(const SearchState& state);
+
+        /**
+         * @brief Returns the position after a push, with the player where the box was.
+         * @throws std::invalid_argument if no box is on the push's cell.
+         */
+        [[nodiscard]] SearchState apply(const SearchState& state, const Push& push) const;
+
+        /**
+         * @brief Returns the moves of a push: the shortest walk behind the box, then the push.
+         * @throws std::invalid_argument if the push is not one of `pushes(state)`.
+         */
+        [[nodiscard]] std::vector<Direction> walk(const SearchState& state, const Push& push);
+
+        /**
+         * @brief Returns the top-left cell the player can reach. Two positions with the same boxes
+         * and the same normalized player have the same pushes.
+         */
+        [[nodiscard]] int normalizedPlayer(const SearchState& state);
+
+        /**
+         * @brief Returns true if enough boxes are on storages to win.
+         */
+        [[nodiscard]] bool isSolved(const SearchState& state) const;
+
+    private:
+        /**
+         * @brief Marks the boxes of a position and the cells the player reaches from its cell with
+         * a new stamp, recording for each reached cell the cell it was reached from.
+         * @return The top-left reached cell.
+         */
+        int reach(const SearchState& state);
+
+        /**
+         * @brief Unmarks the boxes of a position.
+         */
+        void clear(const SearchState& state);
+
+        SokobanLevel m_level;
+
+        /**
+         * @brief Scratch space: a flag per cell holding a box, the stamp of the last flood fill
+         * that reached each cell, the cell each was reached from, and the flood fill queue.
+         */
+        std::vector<char> m_occupancy;
+        std::vector<int> m_reached;
+        std::vector<int> m_parents;
+        std::vector<int> m_queue;
+        int m_stamp = 0;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,281 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanReachability.hpp"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace SB {
+
+    SokobanReachability::SokobanReachability(const SokobanLevel& level)
+        : m_cellCount(level.size()), m_walls(level.size()), m_marks(level.size(), 0) {
+        for (const auto direction : SokobanLevel::DIRECTIONS) {
+            m_offsets[static_cast<int>(direction)] = level.offset(direction);
+        }
+        for (int index{ 0 }; index < m_cellCount; ++index) {
+            m_walls[index] = level.isWall(index);
+        }
+
+        reset(level.initialBoxes(), level.initialPlayer());
+    }
+
+    void SokobanReachability::reset(const std::vector<int>& boxes, const int player) {
+        std::vector<char> isBox(m_cellCount, 0);
+        for (const auto box : boxes) {
+            isBox[box] = 1;
+        }
+
+        m_labels.assign(m_cellCount, BLOCKED);
+        m_sizes.clear();
+        m_topLefts.clear();
+        m_unusedLabels.clear();
+
+        // Scanning in cell order, the first cell of each area found is its top-left cell
+        for (int index{ 0 }; index < m_cellCount; ++index) {
+            if (m_walls[index] || isBox[index] || m_labels[index] != BLOCKED) {
+                continue;
+            }
+
+            const auto label = newLabel(0, index);
+            m_labels[index] = label;
+            m_queue.assign(1, index);
+            for (size_t head{ 0 }; head < m_queue.size(); ++head) {
+                for (const auto offset : m_offsets) {
+                    const auto next = m_queue[head] + offset;
+                    if (!m_walls[next] && !isBox[next] && m_labels[next] == BLOCKED) {
+                        m_labels[next] = label;
+                        m_queue.push_back(next);
+                    }
+                }
+            }
+            m_sizes[label] = static_cast<int>(m_queue.size());
+        }
+
+        m_player = player;
+    }
+
+    void SokobanReachability::moveBox(const int fromIndex, const int toIndex) {
+        if (fromIndex == toIndex) {
+            return;
+        }
+
+        // Blocking first keeps a push along a corridor from merging the areas on either side of the
+        // box only to split them again
+        block(toIndex);
+        free(fromIndex);
+    }
+
+    void SokobanReachability::movePlayer(const int index) { m_player = index; }
+
+    int SokobanReachability::player() const { return m_player; }
+
+    bool SokobanReachability::canReach(const int index) const {
+        return m_labels[index] != BLOCKED && m_labels[index] == m_labels[m_player];
+    }
+
+    int SokobanReachability::normalizedPlayer() const { return m_topLefts[m_labels[m_player]]; }
+
+    void SokobanReachability::free(const int index) {
+        std::array<int, 4> labels{};
+        auto labelCount = 0;
+        auto keeper = BLOCKED;
+        for (const auto offset : m_offsets) {
+            const auto label = m_labels[index + offset];
+            if (label == BLOCKED ||
+                std::find(labels.begin(), labels.begin() + labelCount, label) !=
+                labels.begin() + labelCount) {
+                continue;
+            }
+            labels[labelCount++] = label;
+            if (keeper == BLOCKED || m_sizes[label] > m_sizes[keeper]) {
+                keeper = label;
+            }
+        }
+
+        if (keeper == BLOCKED) {
+            m_labels[index] = newLabel(1, index);
+            return;
+        }
+
+        // The largest area keeps its label and takes in the cell and the others
+        m_labels[index] = keeper;
+        ++m_sizes[keeper];
+        m_topLefts[keeper] = std::min(m_topLefts[keeper], index);
+        for (int k{ 0 }; k < labelCount; ++k) {
+            const auto label = labels[k];
+            if (label == keeper) {
+                continue;
+            }
+            m_sizes[keeper] += m_sizes[label];
+            m_topLefts[keeper] = std::min(m_topLefts[keeper], m_topLefts[label]);
+            relabel(m_topLefts[label], keeper);
+            m_unusedLabels.push_back(label);
+        }
+    }
+
+    void SokobanReachability::block(const int index) {
+        const auto label = m_labels[index];
+        m_labels[index] = BLOCKED;
+        --m_sizes[label];
+
+        std::array<int, 4> starts{};
+        auto startCount = 0;
+        for (const auto offset : m_offsets) {
+            if (m_labels[index + offset] == label) {
+                starts[startCount++] = index + offset;
+            }
+        }
+        if (startCount == 0) {
+            m_unusedLabels.push_back(label);
+            return;
+        }
+
+        // One search per neighbour, each owning the cells it marks; searches that meet join a group,
+        // and a group whose searches all run dry is an area of its own
+        std::array<int, 4> groups{};
+        std::array<size_t, 4> heads{};
+        m_stamp += 4;
+        for (int k{ 0 }; k < startCount; ++k) {
+            groups[k] = k;
+            heads[k] = 0;
+            m_queues[k].assign(1, starts[k]);
+            m_marks[starts[k]] = m_stamp + k;
+        }
+        const auto root = [&](int k) {
+            while (groups[k] != k) {
+                k = groups[k];
+            }
+            return k;
+        };
+        const auto isRunning = [&](const int group) {
+            for (int k{ 0 }; k < startCount; ++k) {
+                if (root(k) == group && heads[k] < m_queues[k].size()) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        auto isSplit = false;
+        while (true) {
+            auto groupCount = 0;
+            auto runningCount = 0;
+            for (int k{ 0 }; k < startCount; ++k) {
+                if (root(k) == k) {
+                    ++groupCount;
+                    runningCount += isRunning(k);
+                }
+            }
+            if (groupCount == 1) {
+                break;
+            }
+            if (runningCount <= 1) {
+                isSplit = true;
+                break;
+            }
+
+            for (int k{ 0 }; k < startCount; ++k) {
+                if (heads[k] == m_queues[k].size()) {
+                    continue;
+                }
+                const auto cell = m_queues[k][heads[k]++];
+                for (const auto offset : m_offsets) {
+                    const auto next = cell + offset;
+                    if (m_labels[next] != label) {
+                        continue;
+                    }
+                    if (m_marks[next] >= m_stamp && m_marks[next] < m_stamp + 4) {
+                        const auto other = root(static_cast<int>(m_marks[next] - m_stamp));
+                        groups[other] = root(k);
+                        continue;
+                    }
+                    m_marks[next] = m_stamp + k;
+                    m_queues[k].push_back(next);
+                }
+            }
+        }
+
+        if (isSplit) {
+            // Every group but the one still running, or the largest if none is, is cut off
+            auto keeper = -1;
+            std::array<int, 4> sizes{};
+            for (int k{ 0 }; k < startCount; ++k) {
+                sizes[root(k)] += static_cast<int>(m_queues[k].size());
+            }
+            for (int k{ 0 }; k < startCount; ++k) {
+                if (root(k) == k && isRunning(k)) {
+                    keeper = k;
+                }
+            }
+            if (keeper < 0) {
+                for (int k{ 0 }; k < startCount; ++k) {
+                    if (root(k) == k && (keeper < 0 || sizes[k] > sizes[keeper])) {
+                        keeper = k;
+                    }
+                }
+            }
+
+            std::array<int, 4> newLabels{};
+            for (int k{ 0 }; k < startCount; ++k) {
+                if (root(k) == k && k != keeper) {
+                    newLabels[k] = newLabel(sizes[k], m_cellCount);
+                    m_sizes[label] -= sizes[k];
+                }
+            }
+            for (int k{ 0 }; k < startCount; ++k) {
+                const auto group = root(k);
+                if (group == keeper) {
+                    continue;
+                }
+                auto& topLeft = m_topLefts[newLabels[group]];
+                for (const auto cell : m_queues[k]) {
+                    m_labels[cell] = newLabels[group];
+                    topLeft = std::min(topLeft, cell);
+                }
+            }
+        }
+
+        const auto topLeft = m_topLefts[label];
+        if (topLeft == index || m_labels[topLeft] != label) {
+            m_topLefts[label] = findTopLeft(topLeft + 1, label);
+        }
+    }
+
+    int SokobanReachability::newLabel(const int size, const int topLeft) {
+        if (m_unusedLabels.empty()) {
+            m_sizes.push_back(size);
+            m_topLefts.push_back(topLeft);
+            return static_cast<int>(m_sizes.size()) - 1;
+        }
+
+        const auto label = m_unusedLabels.back();
+        m_unusedLabels.pop_back();
+        m_sizes[label] = size;
+        m_topLefts[label] = topLeft;
+        return label;
+    }
+
+    void SokobanReachability::relabel(const int index, const int label) {
+        const auto oldLabel = m_labels[index];
+        m_labels[index] = label;
+        m_queue.assign(1, index);
+        for (size_t head{ 0 }; head < m_queue.size(); ++head) {
+            for (const auto offset : m_offsets) {
+                const auto next = m_queue[head] + offset;
+                if (m_labels[next] == oldLabel) {
+                    m_labels[next] = label;
+                    m_queue.push_back(next);
+                }
+            }
+        }
+    }
+
+    int SokobanReachability::findTopLeft(int index, const int label) const {
+        while (m_labels[index] != label) {
+            ++index;
+        }
+
+        return index;
+    }
+
+}  // namespace SB
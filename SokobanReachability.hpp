@@ -0,0 +1,157 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANREACHABILITY_HPP
+#define SOKOBANREACHABILITY_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "SokobanLevel.hpp"
+
+namespace SB {
+
+    /**
+     * @brief The cells the player can reach without pushing, kept up to date as boxes move. The free
+     * cells (neither wall nor box) are labelled by connected area, and each area remembers its size
+     * and its top-left cell, so asking whether the player reaches a cell, or which cell stands for
+     * the player's area, costs O(1).
+     *
+     * A box leaving a cell merges the areas around it by relabelling the smaller ones. A box
+     * arriving on a cell may split its area; searches from the cell's neighbours run side by side
+     * until all but one have run dry or they have met, so only the pieces cut off are visited and
+     * relabelled. The top-left cell of the area that keeps its label is found again by scanning
+     * forward from the old one, which is only needed when it was covered or cut off.
+     */
+    class SokobanReachability {
+    public:
+        /**
+         * @brief Creates an empty structure; `reset` it before use.
+         */
+        SokobanReachability() = default;
+
+        /**
+         * @brief Creates a structure for a level, with no boxes and the player on the initial cell.
+         */
+        explicit SokobanReachability(const SokobanLevel& level);
+
+        /**
+         * @brief Labels the areas from scratch for a set of box cells.
+         * @param boxes The cells of all boxes.
+         * @param player The cell of the player.
+         */
+        void reset(const std::vector<int>& boxes, int player);
+
+        /**
+         * @brief Updates the areas after one box moved, e.g. by a push or a macro.
+         * @param fromIndex The cell the box moved from.
+         * @param toIndex The cell the box moved to, which must be free.
+         */
+        void moveBox(int fromIndex, int toIndex);
+
+        /**
+         * @brief Moves the player to a free cell, which need not be in the player's area.
+         */
+        void movePlayer(int index);
+
+        /**
+         * @brief Returns the cell of the player.
+         */
+        [[nodiscard]] int player() const;
+
+        /**
+         * @brief Returns true if the player can walk to a cell without pushing.
+         */
+        [[nodiscard]] bool canReach(int index) const;
+
+        /**
+         * @brief Returns the top-left cell the player can reach, which stands for the whole area
+         * when positions are told apart.
+         */
+        [[nodiscard]] int normalizedPlayer() const;
+
+    private:
+        /**
+         * @brief The label of walls and boxes.
+         */
+        static constexpr int BLOCKED = -1;
+
+        /**
+         * @brief Frees a cell, merging the areas around it.
+         */
+        void free(int index);
+
+        /**
+         * @brief Blocks a free cell, splitting its area if the cell held it together.
+         */
+        void block(int index);
+
+        /**
+         * @brief Takes an unused label for an area of a size and a top-left cell.
+         */
+        int newLabel(int size, int topLeft);
+
+        /**
+         * @brief Relabels every cell of the area around a cell.
+         */
+        void relabel(int index, int label);
+
+        /**
+         * @brief Scans forward from a cell for the first one with a label, which is its area's
+         * top-left cell if none before it has the label.
+         */
+        int findTopLeft(int index, int label) const;
+
+        /**
+         * @brief The number of cells in the level.
+         */
+        int m_cellCount = 0;
+
+        /**
+         * @brief The offsets of the four directions.
+         */
+        std::array<int, 4> m_offsets{};
+
+        /**
+         * @brief The walls, by cell.
+         */
+        std::vector<char> m_walls;
+
+        /**
+         * @brief The area label of each cell; BLOCKED for walls and boxes.
+         */
+        std::vector<int> m_labels;
+
+        /**
+         * @brief The number of cells and the top-left cell of the area with each label.
+         */
+        std::vector<int> m_sizes;
+        std::vector<int> m_topLefts;
+
+        /**
+         * @brief The labels no area uses.
+         */
+        std::vector<int> m_unusedLabels;
+
+        /**
+         * @brief The cell of the player.
+         */
+        int m_player = 0;
+
+        /**
+         * @brief Scratch space for `block`: a queue and a list of visited cells per neighbour, and
+         * the marks telling which search visited a cell. A search's mark is `m_stamp` plus its
+         * neighbour, so no clearing is needed between calls.
+         */
+        std::array<std::vector<int>, 4> m_queues;
+        std::vector<uint64_t> m_marks;
+        uint64_t m_stamp = 0;
+
+        /**
+         * @brief Scratch space for `relabel`.
+         */
+        std::vector<int> m_queue;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,197 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanReplay.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief Returns a checkpoint interval after checking it.
+         * @throws std::invalid_argument if the interval is less than 1.
+         */
+        int checkInterval(const int checkpointInterval) {
+            if (checkpointInterval < 1) {
+                throw std::invalid_argument("The checkpoint interval must be at least 1");
+            }
+            return checkpointInterval;
+        }
+
+    }  // namespace
+
+    SokobanReplay::SokobanReplay(const SokobanLevel& level, const std::vector<Direction>& moves,
+        const int checkpointInterval)
+        : m_level(level), m_checkpointInterval(checkInterval(checkpointInterval)),
+          m_codec(level, SearchState{ level.initialBoxes(), level.initialPlayer() }),
+          m_isBox(level.size(), 0), m_player(level.initialPlayer()) {
+        for (const auto direction : SokobanLevel::DIRECTIONS) {
+            m_offsets[static_cast<int>(direction)] = level.offset(direction);
+        }
+        for (const auto box : level.initialBoxes()) {
+            m_isBox[box] = 1;
+        }
+
+        m_moves.reserve(moves.size());
+        m_checkpoints.reserve((moves.size() / m_checkpointInterval + 1) * m_codec.bytes());
+        // Count the boxes on storages to stop at the win
+        const auto goalCount = static_cast<int>(std::min(level.goals().size(),
+            level.initialBoxes().size()));
+        auto onGoals = static_cast<int>(std::count_if(level.initialBoxes().begin(),
+            level.initialBoxes().end(), [&level](const int box) { return level.isGoal(box); }));
+
+        save();
+        for (const auto direction : moves) {
+            if (onGoals >= goalCount) {
+                break;
+            }
+
+            const auto move = play(direction);
+            m_moves.push_back(move);
+            if (move & MOVE_PUSHED) {
+                const auto box = m_player + m_offsets[move & 3];
+                onGoals += static_cast<int>(m_level.isGoal(box)) -
+                    static_cast<int>(m_level.isGoal(m_player));
+            }
+            if (m_moves.size() % m_checkpointInterval == 0) {
+                save();
+            }
+        }
+
+        restore(0);
+    }
+
+    int SokobanReplay::size() const { return static_cast<int>(m_moves.size()); }
+
+    int SokobanReplay::position() const { return m_position; }
+
+    void SokobanReplay::seek(const int position) {
+        moveTo(std::clamp(position, 0, size()));
+        m_cursor = m_position;
+        m_isPlaying = false;
+    }
+
+    void SokobanReplay::stepForward() { seek(m_position + 1); }
+
+    void SokobanReplay::stepBackward() { seek(m_position - 1); }
+
+    void SokobanReplay::setSpeed(const double movesPerSecond) { m_speed = movesPerSecond; }
+
+    double SokobanReplay::speed() const { return m_speed; }
+
+    void SokobanReplay::setPlaying(const bool isPlaying) {
+        m_isPlaying = isPlaying;
+        m_cursor = m_position;
+    }
+
+    bool SokobanReplay::isPlaying() const { return m_isPlaying; }
+
+    void SokobanReplay::update(const int64_t& dt) {
+        if (!m_isPlaying) {
+            return;
+        }
+
+        m_cursor += m_speed * static_cast<double>(dt) / 1e6;
+        if (m_cursor <= 0.0 || m_cursor >= size()) {
+            m_cursor = std::clamp(m_cursor, 0.0, static_cast<double>(size()));
+            m_isPlaying = false;
+        }
+        moveTo(static_cast<int>(m_cursor));
+    }
+
+    SearchState SokobanReplay::state() const {
+        SearchState state{ {}, m_player };
+        for (int index{ 0 }; index < m_level.size(); ++index) {
+            if (m_isBox[index]) {
+                state.boxes.push_back(index);
+            }
+        }
+
+        return state;
+    }
+
+    size_t SokobanReplay::checkpointBytes() const { return m_checkpoints.size(); }
+
+    void SokobanReplay::moveTo(const int position) {
+        if (position < m_position && m_position - position < m_checkpointInterval) {
+            while (m_position > position) {
+                revert(m_moves[--m_position]);
+            }
+            return;
+        }
+
+        // Anything further back or ahead than an interval is closer from the checkpoint before it
+        if (position - m_position >= m_checkpointInterval || position < m_position) {
+            restore(position / m_checkpointInterval);
+        }
+        while (m_position < position) {
+            apply(m_moves[m_position++]);
+        }
+    }
+
+    uint8_t SokobanReplay::play(const Direction direction) {
+        const auto move = static_cast<uint8_t>(direction);
+        const auto offset = m_offsets[move];
+        const auto next = m_player + offset;
+        if (m_level.isWall(next)) {
+            return move;
+        }
+
+        if (m_isBox[next]) {
+            const auto beyond = next + offset;
+            if (m_level.isWall(beyond) || m_isBox[beyond]) {
+                return move;
+            }
+            apply(move | MOVE_STEPPED | MOVE_PUSHED);
+            return move | MOVE_STEPPED | MOVE_PUSHED;
+        }
+
+        apply(move | MOVE_STEPPED);
+        return move | MOVE_STEPPED;
+    }
+
+    void SokobanReplay::apply(const uint8_t move) {
+        if (!(move & MOVE_STEPPED)) {
+            return;
+        }
+
+        const auto offset = m_offsets[move & 3];
+        m_player += offset;
+        if (move & MOVE_PUSHED) {
+            m_isBox[m_player] = 0;
+            m_isBox[m_player + offset] = 1;
+        }
+    }
+
+    void SokobanReplay::revert(const uint8_t move) {
+        if (!(move & MOVE_STEPPED)) {
+            return;
+        }
+
+        const auto offset = m_offsets[move & 3];
+        if (move & MOVE_PUSHED) {
+            m_isBox[m_player + offset] = 0;
+            m_isBox[m_player] = 1;
+        }
+        m_player -= offset;
+    }
+
+    void SokobanReplay::save() {
+        const auto state = this->state();
+        const auto offset = m_checkpoints.size();
+        m_checkpoints.resize(offset + m_codec.bytes());
+        m_codec.encode(state.boxes, state.player, m_checkpoints.data() + offset);
+    }
+
+    void SokobanReplay::restore(const int checkpoint) {
+        m_codec.decode(m_checkpoints.data() + checkpoint * m_codec.bytes(), m_boxes, m_player);
+        std::fill(m_isBox.begin(), m_isBox.end(), 0);
+        for (const auto box : m_boxes) {
+            m_isBox[box] = 1;
+        }
+        m_position = checkpoint * m_checkpointInterval;
+    }
+
+}  // namespace SB
@@ -0,0 +1,165 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANREPLAY_HPP
+#define SOKOBANREPLAY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SokobanConstants.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanSearch.hpp"
+#include "SokobanStateSet.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Plays back a recorded sequence of moves and seeks to any point of it.
+     *
+     * The moves are simulated once up front. Each one is stored in a byte that says whether it
+     * stepped, pushed a box or ran into something, so a move can be taken back without the board
+     * before it. Every `checkpointInterval` moves the board is packed into a `SokobanStateCodec`
+     * record. A seek within one interval of the current move steps there directly; any other seek
+     * restores the checkpoint at or before the target and replays fewer than `checkpointInterval`
+     * moves from it. Long sessions cost a few bytes per checkpoint and one byte per move.
+     */
+    class SokobanReplay {
+    public:
+        /**
+         * @brief The default number of moves between checkpoints.
+         */
+        static constexpr int DEFAULT_CHECKPOINT_INTERVAL = 256;
+
+        /**
+         * @brief Simulates a session from the initial position of a level and takes its checkpoints.
+         * Moves into walls and boxes that can't move are kept and change nothing, as in the game.
+         * The moves after the one that wins the level are dropped, since the game takes none then.
+         * @param level The level the session was played on.
+         * @param moves The direction of every move, in order.
+         * @param checkpointInterval The number of moves between checkpoints.
+         * @throws std::invalid_argument if the interval is less than 1.
+         */
+        SokobanReplay(const SokobanLevel& level, const std::vector<Direction>& moves,
+            int checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL);
+
+        /**
+         * @brief Returns the number of moves of the session.
+         */
+        [[nodiscard]] int size() const;
+
+        /**
+         * @brief Returns the number of moves played so far: 0 at the start, `size()` at the end.
+         */
+        [[nodiscard]] int position() const;
+
+        /**
+         * @brief Moves to a point of the session, clamped to [0, size()], and pauses.
+         */
+        void seek(int position);
+
+        /**
+         * @brief Plays one move forward or takes one back, if any, and pauses.
+         */
+        void stepForward();
+        void stepBackward();
+
+        /**
+         * @brief Sets the playback speed in moves per second; a negative speed plays backward.
+         */
+        void setSpeed(double movesPerSecond);
+
+        /**
+         * @brief Returns the playback speed in moves per second.
+         */
+        [[nodiscard]] double speed() const;
+
+        /**
+         * @brief Starts or pauses playback. Playback pauses by itself at either end.
+         */
+        void setPlaying(bool isPlaying);
+
+        /**
+         * @brief Returns true while playing.
+         */
+        [[nodiscard]] bool isPlaying() const;
+
+        /**
+         * @brief Advances playback in a game frame.
+         * @param dt The delta time in microseconds between this frame and the previous frame.
+         */
+        void update(const int64_t& dt);
+
+        /**
+         * @brief Returns the position at the current move, e.g. for `Sokoban::restore`.
+         */
+        [[nodiscard]] SearchState state() const;
+
+        /**
+         * @brief Returns the bytes taken by the checkpoints.
+         */
+        [[nodiscard]] size_t checkpointBytes() const;
+
+    private:
+        /**
+         * @brief The bits of a stored move: the direction in the low two bits and what it did.
+         */
+        static constexpr uint8_t MOVE_STEPPED = 1 << 2;
+        static constexpr uint8_t MOVE_PUSHED = 1 << 3;
+
+        /**
+         * @brief Goes to a move by stepping or from a checkpoint, whichever is closer.
+         */
+        void moveTo(int position);
+
+        /**
+         * @brief Plays a direction on the board and returns the stored move.
+         */
+        uint8_t play(Direction direction);
+
+        /**
+         * @brief Plays a stored move forward, or takes it back.
+         */
+        void apply(uint8_t move);
+        void revert(uint8_t move);
+
+        /**
+         * @brief Packs the board into the next checkpoint, or unpacks a checkpoint onto the board.
+         */
+        void save();
+        void restore(int checkpoint);
+
+        SokobanLevel m_level;
+        std::array<int, 4> m_offsets{};
+        int m_checkpointInterval;
+        SokobanStateCodec m_codec;
+
+        /**
+         * @brief The stored moves, and the checkpoint records back to back.
+         */
+        std::vector<uint8_t> m_moves;
+        std::vector<uint8_t> m_checkpoints;
+
+        /**
+         * @brief The board at the current move: 1 on the cells with a box, and the player's cell.
+         */
+        std::vector<uint8_t> m_isBox;
+        int m_player;
+        int m_position = 0;
+
+        /**
+         * @brief Scratch space for restoring checkpoints.
+         */
+        std::vector<int> m_boxes;
+
+        /**
+         * @brief The playback state. The cursor is the fractional move playback has reached.
+         */
+        double m_speed = 10.0;
+        double m_cursor = 0.0;
+        bool m_isPlaying = false;
+    };
+
+}  // namespace SB
+
+#endif
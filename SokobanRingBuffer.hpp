@@ -0,0 +1,103 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANRINGBUFFER_HPP
+#define SOKOBANRINGBUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace SB {
+
+    /**
+     * @brief A bounded lock-free queue for one producer thread and one consumer thread.
+     *
+     * The producer only writes the tail and the consumer only writes the head, each on a cache line
+     * of its own. Each side keeps a copy of the other side's index next to its own and only reloads
+     * it when the copy says the queue is full (or empty), so a push usually touches no line the
+     * consumer writes.
+     * @tparam T A trivially copyable element type.
+     */
+    template <typename T>
+    class SokobanRingBuffer {
+    public:
+        /**
+         * @brief Creates an empty queue.
+         * @param capacity The most elements it holds, rounded up to a power of two.
+         */
+        explicit SokobanRingBuffer(const size_t capacity) {
+            size_t size{ 1 };
+            while (size < capacity) {
+                size <<= 1;
+            }
+            m_elements.resize(size);
+            m_mask = size - 1;
+        }
+
+        /**
+         * @brief Appends an element. Producer thread only.
+         * @return False if the queue is full; the element is dropped then.
+         */
+        bool push(const T& element) {
+            const auto tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cachedHead > m_mask) {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (tail - m_cachedHead > m_mask) {
+                    return false;
+                }
+            }
+
+            m_elements[tail & m_mask] = element;
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Takes up to `count` elements from the front. Consumer thread only.
+         * @return The number of elements taken.
+         */
+        size_t pop(T* elements, const size_t count) {
+            const auto head = m_head.load(std::memory_order_relaxed);
+            if (m_cachedTail - head < count) {
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+            }
+
+            const auto taken = std::min(count, m_cachedTail - head);
+            for (size_t i{ 0 }; i < taken; ++i) {
+                elements[i] = m_elements[(head + i) & m_mask];
+            }
+            m_head.store(head + taken, std::memory_order_release);
+            return taken;
+        }
+
+        /**
+         * @brief Returns the most elements the queue holds.
+         */
+        [[nodiscard]] size_t capacity() const { return m_mask + 1; }
+
+    private:
+        /**
+         * @brief The size of a cache line, which the two sides keep apart.
+         */
+        static constexpr size_t CACHE_LINE_BYTES = 64;
+
+        std::vector<T> m_elements;
+        size_t m_mask = 0;
+
+        /**
+         * @brief The consumer's line: the next element to pop and its copy of the tail.
+         */
+        alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_head{ 0 };
+        size_t m_cachedTail = 0;
+
+        /**
+         * @brief The producer's line: the next free slot and its copy of the head.
+         */
+        alignas(CACHE_LINE_BYTES) std::atomic<size_t> m_tail{ 0 };
+        size_t m_cachedHead = 0;
+    };
+
+}  // namespace SB
+
+#endif
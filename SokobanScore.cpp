@@ -2,11 +2,13 @@
 
 #include "SokobanScore.hpp"
 #include <string>
+#include "SokobanAssets.hpp"
 #include "SokobanConstants.hpp"
 
 namespace SB {
 
-    SokobanScore::SokobanScore() { m_font.loadFromFile(FONT_DIGITAL7_FILENAME); }
+    SokobanScore::SokobanScore()
+        : m_font(SokobanAssets::instance().font(FONT_DIGITAL7_FILENAME)) {}
 
     bool SokobanScore::isWon() const { return m_score == m_maxScore; }
 
@@ -14,7 +16,7 @@ namespace SB {
         const std::string stringToPrint = std::to_string(m_score) + "/" + std::to_string(m_maxScore);
 
         sf::Text text;
-        text.setFont(m_font);
+        text.setFont(*m_font);
         text.setString(stringToPrint);
         text.setCharacterSize(28);
         text.setFillColor(isWon() ? sf::Color::Green : sf::Color::Red);
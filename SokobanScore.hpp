@@ -3,6 +3,7 @@
 #ifndef SOKOBANSCORE_HPP
 #define SOKOBANSCORE_HPP
 
+#include <memory>
 #include <SFML/Graphics.hpp>
 
 namespace SB {
@@ -42,9 +43,9 @@ namespace SB {
         int m_maxScore = 1;
 
         /**
-         * @brief The font for the displayed text.
+         * @brief The font for the displayed text. It is shared and empty until it has loaded.
          */
-        sf::Font m_font;
+        std::shared_ptr<sf::Font> m_font;
     };
 
 }  // namespace SB
@@ -0,0 +1,54 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSEARCH_HPP
+#define SOKOBANSEARCH_HPP
+
+#include <cstdint>
+#include <vector>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief A position in a search: the box cells in ascending order and the player cell. Cells are
+     * `SokobanLevel` indices.
+     */
+    struct SearchState {
+        std::vector<int> boxes;
+        int player;
+    };
+
+    /**
+     * @brief A push of one box, possibly a macro that pushes the same box several times. A straight
+     * run of pushes moves the box from `box` to `target` along `direction`; otherwise `path` names a
+     * precomputed push sequence in `SokobanMacros`.
+     */
+    struct Push {
+        int box;
+        Direction direction;
+        int target;
+        int path = -1;
+    };
+
+    /**
+     * @brief Returns the hash contribution of a box on a cell. States hash to the XOR of their boxes'
+     * contributions and the player's, so a push updates the hash in O(1).
+     */
+    [[nodiscard]] inline uint64_t boxHash(const int index) {
+        // splitmix64 finalizer
+        auto value = static_cast<uint64_t>(index) * 0x9E3779B97F4A7C15ull + 0x632BE59BD9B4E019ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * @brief Returns the hash contribution of the (normalized) player cell.
+     */
+    [[nodiscard]] inline uint64_t playerHash(const int index) {
+        return boxHash(~index);
+    }
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanSolution.hpp"
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    char toLurd(const Direction direction, const bool isPush) {
+        char lurd = 'u';
+        switch (direction) {
+        case Direction::Up:
+            lurd = 'u';
+            break;
+        case Direction::Down:
+            lurd = 'd';
+            break;
+        case Direction::Left:
+            lurd = 'l';
+            break;
+        case Direction::Right:
+            lurd = 'r';
+            break;
+        }
+
+        return isPush ? static_cast<char>(std::toupper(lurd)) : lurd;
+    }
+
+    Direction fromLurd(const char lurd) {
+        switch (std::tolower(static_cast<unsigned char>(lurd))) {
+        case 'u':
+            return Direction::Up;
+        case 'd':
+            return Direction::Down;
+        case 'l':
+            return Direction::Left;
+        case 'r':
+            return Direction::Right;
+        default:
+            throw std::invalid_argument(std::string("Invalid LURD character: ") + lurd);
+        }
+    }
+
+    std::vector<Direction> parseLurd(const std::string& solution) {
+        std::vector<Direction> directions;
+        for (const auto lurd : solution) {
+            if (!std::isspace(static_cast<unsigned char>(lurd))) {
+                directions.push_back(fromLurd(lurd));
+            }
+        }
+
+        return directions;
+    }
+
+    Direction opposite(const Direction direction) {
+        switch (direction) {
+        case Direction::Up:
+            return Direction::Down;
+        case Direction::Down:
+            return Direction::Up;
+        case Direction::Left:
+            return Direction::Right;
+        case Direction::Right:
+            return Direction::Left;
+        }
+
+        return direction;
+    }
+
+}  // namespace SB
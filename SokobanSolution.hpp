@@ -0,0 +1,39 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSOLUTION_HPP
+#define SOKOBANSOLUTION_HPP
+
+#include <string>
+#include <vector>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Converts a move into its LURD character: 'l', 'u', 'r' or 'd' for a step, and the upper
+     * case letter for a push.
+     * @param direction The direction of the move.
+     * @param isPush True if the move pushes a box.
+     */
+    [[nodiscard]] char toLurd(Direction direction, bool isPush);
+
+    /**
+     * @brief Converts a LURD character of either case into its direction.
+     * @throws std::invalid_argument if the character is not a LURD character.
+     */
+    [[nodiscard]] Direction fromLurd(char lurd);
+
+    /**
+     * @brief Parses a LURD solution, ignoring whitespace.
+     * @throws std::invalid_argument if the solution contains another character.
+     */
+    [[nodiscard]] std::vector<Direction> parseLurd(const std::string& solution);
+
+    /**
+     * @brief Returns the direction opposite to a direction.
+     */
+    [[nodiscard]] Direction opposite(Direction direction);
+
+}  // namespace SB
+
+#endif
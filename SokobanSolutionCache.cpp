@@ -0,0 +1,281 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanSolutionCache.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The first bytes of a data file.
+         */
+        constexpr char DATA_MAGIC[8] = { 'S', 'B', 'S', 'O', 'L', 'V', '0', '1' };
+
+        /**
+         * @brief The first field of an index file.
+         */
+        constexpr uint64_t INDEX_MAGIC = 0x3130584449425353ull;
+
+        /**
+         * @brief The number of slots of a new index.
+         */
+        constexpr uint64_t INITIAL_CAPACITY = 1024;
+
+        /**
+         * @brief The bytes of a record before its solution: the hash, the solution length, the
+         * moves, the pushes, the flags, the expanded nodes and the seconds.
+         */
+        constexpr size_t RECORD_HEADER_BYTES = 8 + 4 + 4 + 4 + 4 + 8 + 8;
+
+        /**
+         * @brief Returns the first slot to probe for a hash.
+         */
+        uint64_t slotOf(const uint64_t hash, const uint64_t capacity) {
+            return (hash ^ (hash >> 32)) & (capacity - 1);
+        }
+
+        /**
+         * @brief Copies a value into a byte buffer and moves past it.
+         */
+        template <typename T>
+        void put(char*& bytes, const T value) {
+            std::memcpy(bytes, &value, sizeof(T));
+            bytes += sizeof(T);
+        }
+
+        /**
+         * @brief Copies a value out of a byte buffer and moves past it.
+         */
+        template <typename T>
+        void get(const char*& bytes, T& value) {
+            std::memcpy(&value, bytes, sizeof(T));
+            bytes += sizeof(T);
+        }
+
+    }  // namespace
+
+    SokobanSolutionCache::SokobanSolutionCache(const std::string& filename) : m_filename(filename) {
+        m_dataFile = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+        if (m_dataFile < 0) {
+            throw std::runtime_error("Can't open solution cache: " + filename);
+        }
+
+        struct stat status{};
+        fstat(m_dataFile, &status);
+        m_dataBytes = static_cast<uint64_t>(status.st_size);
+        char magic[sizeof(DATA_MAGIC)]{};
+        if (m_dataBytes == 0) {
+            if (pwrite(m_dataFile, DATA_MAGIC, sizeof(DATA_MAGIC), 0) !=
+                static_cast<ssize_t>(sizeof(DATA_MAGIC))) {
+                close(m_dataFile);
+                throw std::runtime_error("Can't write solution cache: " + filename);
+            }
+            m_dataBytes = sizeof(DATA_MAGIC);
+        }
+        else if (pread(m_dataFile, magic, sizeof(magic), 0) != static_cast<ssize_t>(sizeof(magic)) ||
+            std::memcmp(magic, DATA_MAGIC, sizeof(magic)) != 0) {
+            close(m_dataFile);
+            throw std::runtime_error("Not a solution cache: " + filename);
+        }
+
+        // Keep the index if it is whole and covers no more than the data; rebuild it otherwise
+        const auto indexFilename = filename + ".idx";
+        m_indexFile = open(indexFilename.c_str(), O_RDWR | O_CREAT, 0644);
+        if (m_indexFile < 0) {
+            close(m_dataFile);
+            throw std::runtime_error("Can't open solution cache index: " + indexFilename);
+        }
+        IndexHeader header{};
+        fstat(m_indexFile, &status);
+        const auto isValid = pread(m_indexFile, &header, sizeof(header), 0) ==
+            static_cast<ssize_t>(sizeof(header)) && header.magic == INDEX_MAGIC &&
+            header.capacity >= INITIAL_CAPACITY && (header.capacity & (header.capacity - 1)) == 0 &&
+            static_cast<uint64_t>(status.st_size) ==
+                sizeof(header) + header.capacity * sizeof(IndexSlot) &&
+            header.coveredBytes >= sizeof(DATA_MAGIC) && header.coveredBytes <= m_dataBytes;
+        try {
+            mapIndex(indexFilename, isValid ? header.capacity : INITIAL_CAPACITY, !isValid);
+            catchUp();
+        } catch (...) {
+            unmapIndex();
+            close(m_dataFile);
+            throw;
+        }
+    }
+
+    SokobanSolutionCache::~SokobanSolutionCache() {
+        unmapIndex();
+        close(m_dataFile);
+    }
+
+    bool SokobanSolutionCache::find(const uint64_t hash, CachedSolution& solution) const {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        const auto mask = m_header->capacity - 1;
+        for (auto slot = slotOf(hash, m_header->capacity); m_slots[slot].offset != 0;
+            slot = (slot + 1) & mask) {
+            if (m_slots[slot].hash == hash) {
+                uint64_t recordHash{ 0 };
+                uint64_t size{ 0 };
+                return readRecord(m_slots[slot].offset - 1, recordHash, solution, size) &&
+                    recordHash == hash;
+            }
+        }
+
+        return false;
+    }
+
+    void SokobanSolutionCache::store(const uint64_t hash, const CachedSolution& solution) {
+        std::vector<char> record(RECORD_HEADER_BYTES + solution.solution.size());
+        auto* bytes = record.data();
+        put(bytes, hash);
+        put(bytes, static_cast<uint32_t>(solution.solution.size()));
+        put(bytes, static_cast<int32_t>(solution.moves));
+        put(bytes, static_cast<int32_t>(solution.pushes));
+        put(bytes, solution.flags);
+        put(bytes, solution.expandedNodes);
+        put(bytes, solution.seconds);
+        std::memcpy(bytes, solution.solution.data(), solution.solution.size());
+
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        if (pwrite(m_dataFile, record.data(), record.size(), static_cast<off_t>(m_dataBytes)) !=
+            static_cast<ssize_t>(record.size())) {
+            throw std::runtime_error("Can't write solution cache: " + m_filename);
+        }
+        insert(hash, m_dataBytes);
+        m_dataBytes += record.size();
+        m_header->coveredBytes = m_dataBytes;
+    }
+
+    size_t SokobanSolutionCache::size() const {
+        const std::lock_guard<std::mutex> lock{ m_mutex };
+        return static_cast<size_t>(m_header->count);
+    }
+
+    void SokobanSolutionCache::mapIndex(const std::string& filename, const uint64_t capacity,
+        const bool isNew) {
+        const auto bytes = sizeof(IndexHeader) + capacity * sizeof(IndexSlot);
+        if (isNew && (ftruncate(m_indexFile, 0) != 0 ||
+            ftruncate(m_indexFile, static_cast<off_t>(bytes)) != 0)) {
+            throw std::runtime_error("Can't resize solution cache index: " + filename);
+        }
+
+        auto* const address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+            m_indexFile, 0);
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("Can't map solution cache index: " + filename);
+        }
+        m_mappedBytes = bytes;
+        m_header = static_cast<IndexHeader*>(address);
+        m_slots = reinterpret_cast<IndexSlot*>(m_header + 1);
+        if (isNew) {
+            *m_header = { INDEX_MAGIC, sizeof(DATA_MAGIC), capacity, 0 };
+        }
+    }
+
+    void SokobanSolutionCache::unmapIndex() {
+        if (m_header != nullptr) {
+            munmap(m_header, m_mappedBytes);
+            m_header = nullptr;
+            m_slots = nullptr;
+        }
+        if (m_indexFile >= 0) {
+            close(m_indexFile);
+            m_indexFile = -1;
+        }
+    }
+
+    void SokobanSolutionCache::insert(const uint64_t hash, const uint64_t offset) {
+        if (2 * (m_header->count + 1) > m_header->capacity) {
+            // Double the table. Until it is refilled, the index claims to cover nothing, so a crash
+            // in between only costs a rebuild.
+            std::vector<IndexSlot> live;
+            for (uint64_t slot{ 0 }; slot < m_header->capacity; ++slot) {
+                if (m_slots[slot].offset != 0) {
+                    live.push_back(m_slots[slot]);
+                }
+            }
+            const auto coveredBytes = m_header->coveredBytes;
+            const auto capacity = 2 * m_header->capacity;
+            munmap(m_header, m_mappedBytes);
+            m_header = nullptr;
+            mapIndex(m_filename + ".idx", capacity, true);
+            for (const auto& entry : live) {
+                insert(entry.hash, entry.offset - 1);
+            }
+            m_header->coveredBytes = coveredBytes;
+        }
+
+        const auto mask = m_header->capacity - 1;
+        auto slot = slotOf(hash, m_header->capacity);
+        while (m_slots[slot].offset != 0 && m_slots[slot].hash != hash) {
+            slot = (slot + 1) & mask;
+        }
+        if (m_slots[slot].offset == 0) {
+            ++m_header->count;
+        }
+        m_slots[slot] = { hash, offset + 1 };
+    }
+
+    void SokobanSolutionCache::catchUp() {
+        auto offset = m_header->coveredBytes;
+        while (offset < m_dataBytes) {
+            uint64_t hash{ 0 };
+            uint64_t size{ 0 };
+            CachedSolution solution;
+            if (!readRecord(offset, hash, solution, size)) {
+                // A store cut short; the next one goes in its place
+                if (ftruncate(m_dataFile, static_cast<off_t>(offset)) != 0) {
+                    throw std::runtime_error("Can't repair solution cache: " + m_filename);
+                }
+                m_dataBytes = offset;
+                break;
+            }
+
+            insert(hash, offset);
+            offset += size;
+            m_header->coveredBytes = offset;
+        }
+    }
+
+    bool SokobanSolutionCache::readRecord(const uint64_t offset, uint64_t& hash,
+        CachedSolution& solution, uint64_t& size) const {
+        char header[RECORD_HEADER_BYTES];
+        if (offset + RECORD_HEADER_BYTES > m_dataBytes ||
+            pread(m_dataFile, header, sizeof(header), static_cast<off_t>(offset)) !=
+            static_cast<ssize_t>(sizeof(header))) {
+            return false;
+        }
+
+        const char* bytes = header;
+        uint32_t length{ 0 };
+        int32_t moves{ 0 };
+        int32_t pushes{ 0 };
+        get(bytes, hash);
+        get(bytes, length);
+        get(bytes, moves);
+        get(bytes, pushes);
+        get(bytes, solution.flags);
+        get(bytes, solution.expandedNodes);
+        get(bytes, solution.seconds);
+        solution.moves = moves;
+        solution.pushes = pushes;
+
+        size = RECORD_HEADER_BYTES + length;
+        if (offset + size > m_dataBytes) {
+            return false;
+        }
+        solution.solution.resize(length);
+        return pread(m_dataFile, solution.solution.data(), length,
+            static_cast<off_t>(offset + RECORD_HEADER_BYTES)) == static_cast<ssize_t>(length);
+    }
+
+}  // namespace SB
@@ -0,0 +1,159 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSOLUTIONCACHE_HPP
+#define SOKOBANSOLUTIONCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace SB {
+
+    /**
+     * @brief Set in `CachedSolution::flags` when the optimizer shortened the solution for moves.
+     */
+    inline constexpr uint32_t CACHE_OPTIMIZED_MOVES = 1;
+
+    /**
+     * @brief Set in `CachedSolution::flags` when the optimizer shortened the solution for pushes.
+     */
+    inline constexpr uint32_t CACHE_OPTIMIZED_PUSHES = 2;
+
+    /**
+     * @brief Returns the key under which a level's solution of one kind is stored: the solver's
+     * with no flags, or the optimizer's with `CACHE_OPTIMIZED_MOVES` or `CACHE_OPTIMIZED_PUSHES`.
+     * Each kind has a record of its own, so storing one never replaces another.
+     * @param hash The canonical hash of the level.
+     */
+    [[nodiscard]] inline constexpr uint64_t cacheKey(const uint64_t hash, const uint32_t flags) {
+        return hash ^ (flags * 0x9E3779B97F4A7C15ull);
+    }
+
+    /**
+     * @brief A solution of a canonical level and what it took to find it.
+     */
+    struct CachedSolution {
+        /**
+         * @brief The LURD solution of the canonical level.
+         */
+        std::string solution;
+
+        int moves = 0;
+        int pushes = 0;
+        int64_t expandedNodes = 0;
+
+        /**
+         * @brief The seconds the solver searched for it.
+         */
+        double seconds = 0.0;
+
+        uint32_t flags = 0;
+    };
+
+    /**
+     * @brief A persistent map from canonical level hashes (see `canonicalize`) to solutions.
+     *
+     * Solutions are appended to a data file and never rewritten; the last one stored for a hash
+     * wins. Next to it, `<filename>.idx` holds an open-addressing table from hashes to data file
+     * offsets, mapped into memory, so a lookup touches a slot or two of the table and reads one
+     * record. The index records how much of the data file it covers and catches up on open, so it
+     * can be deleted at any time and is rebuilt from the data. Both files are in the byte order of
+     * the machine.
+     *
+     * A cache is safe to use from several threads, but not from several processes at once.
+     */
+    class SokobanSolutionCache {
+    public:
+        /**
+         * @brief Opens a cache, creating its files if missing.
+         * @param filename The data file.
+         * @throws std::runtime_error if the files can't be opened or mapped.
+         */
+        explicit SokobanSolutionCache(const std::string& filename);
+
+        SokobanSolutionCache(const SokobanSolutionCache&) = delete;
+        SokobanSolutionCache& operator=(const SokobanSolutionCache&) = delete;
+
+        /**
+         * @brief Unmaps the index and closes the files.
+         */
+        ~SokobanSolutionCache();
+
+        /**
+         * @brief Looks up the solution last stored for a hash.
+         * @return True if there is one.
+         */
+        bool find(uint64_t hash, CachedSolution& solution) const;
+
+        /**
+         * @brief Appends a solution for a hash, replacing the one stored before.
+         * @throws std::runtime_error if writing failed.
+         */
+        void store(uint64_t hash, const CachedSolution& solution);
+
+        /**
+         * @brief Returns the number of hashes with a solution.
+         */
+        [[nodiscard]] size_t size() const;
+
+    private:
+        /**
+         * @brief The header of the index file; the slots follow it.
+         */
+        struct IndexHeader {
+            uint64_t magic;
+            uint64_t coveredBytes;
+            uint64_t capacity;
+            uint64_t count;
+        };
+
+        /**
+         * @brief A slot of the index: a hash and one more than the offset of its record, 0 if empty.
+         */
+        struct IndexSlot {
+            uint64_t hash;
+            uint64_t offset;
+        };
+
+        /**
+         * @brief Maps an index file of the given capacity, creating or resizing it first if asked.
+         */
+        void mapIndex(const std::string& filename, uint64_t capacity, bool isNew);
+
+        /**
+         * @brief Unmaps the index and closes its file.
+         */
+        void unmapIndex();
+
+        /**
+         * @brief Points the slot of a hash at a record, doubling the table when half full.
+         */
+        void insert(uint64_t hash, uint64_t offset);
+
+        /**
+         * @brief Adds the records past the covered part of the data file to the index, and cuts off
+         * a record left half-written by a crash.
+         */
+        void catchUp();
+
+        /**
+         * @brief Reads the record at an offset of the data file.
+         * @return False if it is cut off.
+         */
+        bool readRecord(uint64_t offset, uint64_t& hash, CachedSolution& solution,
+            uint64_t& size) const;
+
+        std::string m_filename;
+        int m_dataFile = -1;
+        uint64_t m_dataBytes = 0;
+        int m_indexFile = -1;
+        IndexHeader* m_header = nullptr;
+        IndexSlot* m_slots = nullptr;
+        size_t m_mappedBytes = 0;
+        mutable std::mutex m_mutex;
+    };
+
+}  // namespace SB
+
+#endif
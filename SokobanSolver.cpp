@@ -0,0 +1,877 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanSolver.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "SokobanParallel.hpp"
+#include "SokobanPushGraph.hpp"
+#include "SokobanReachability.hpp"
+#include "SokobanSolution.hpp"
+#include "SokobanStateSet.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief A search node. Box cells are kept in a shared pool, `boxCount` per node.
+         */
+        struct Node {
+            int parent;
+            Push push;
+            int player;
+            int cost;
+            uint64_t boxKey;
+        };
+
+        /**
+         * @brief An open list entry, ordered by its strategy's key (the estimated total cost under
+         * A*), then by deeper nodes first.
+         */
+        struct OpenEntry {
+            int estimate;
+            int cost;
+            int node;
+
+            bool operator<(const OpenEntry& other) const {
+                return estimate != other.estimate ? estimate > other.estimate : cost < other.cost;
+            }
+        };
+
+        /**
+         * @brief Salts that keep the forward and backward searches' keys apart in the shared table.
+         */
+        constexpr uint64_t FORWARD_SALT = 0;
+        constexpr uint64_t BACKWARD_SALT = 0xD1B54A32D192ED03ull;
+
+        /**
+         * @brief Returns the open list key of a node under a best-first strategy.
+         */
+        int priority(const Strategy strategy, const int cost, const int estimate) {
+            switch (strategy) {
+            case Strategy::BreadthFirst:
+                return cost;
+            case Strategy::GreedyBestFirst:
+                return estimate;
+            default:
+                return cost + estimate;
+            }
+        }
+
+    }  // namespace
+
+    const char* strategyName(const Strategy strategy) {
+        switch (strategy) {
+        case Strategy::AStar:
+            return "astar";
+        case Strategy::BreadthFirst:
+            return "bfs";
+        case Strategy::GreedyBestFirst:
+            return "greedy";
+        case Strategy::IdaStar:
+            return "ida";
+        }
+
+        return "";
+    }
+
+    /**
+     * @brief One side of a bidirectional search: an A* search over pushes, or a uniform-cost search
+     * over pulls when backward (the lower bound only measures the distance to the storages).
+     */
+    class SokobanSolver::HalfSearch {
+    public:
+        HalfSearch(const SokobanSolver& solver, const bool isBackward, const int boxCount)
+            : m_solver(solver), m_level(solver.m_level), m_isBackward(isBackward),
+            m_boxCount(boxCount), m_lowerBound(solver.m_lowerBound),
+            m_occupancy(m_level.size(), 0), m_reached(m_level.size(), 0), m_boxes(boxCount) {}
+
+        /**
+         * @brief Adds a position to start from.
+         */
+        void addRoot(std::vector<int> boxes, const int player) {
+            std::sort(boxes.begin(), boxes.end());
+            uint64_t boxKey{ 0 };
+            for (const auto box : boxes) {
+                boxKey ^= boxHash(box);
+            }
+            m_nodes.push_back({ -1, {}, player, 0, boxKey });
+            m_boxPool.insert(m_boxPool.end(), boxes.begin(), boxes.end());
+
+            auto estimate = 0;
+            if (!m_isBackward) {
+                m_lowerBound.reset(boxes);
+                estimate = m_lowerBound.value();
+            }
+            m_open.push({ estimate, 0, static_cast<int>(m_nodes.size()) - 1 });
+        }
+
+        /**
+         * @brief Expands nodes until the queue runs out, the node budget is spent, `stop` is set, or
+         * a position is found that the other side has seen or that ends this side's search.
+         * @param goal The position the backward search has to reach; unused forward.
+         * @param meeting Receives the key of that position if this side sets `stop` first.
+         */
+        void run(SokobanTranspositionTable& table, std::atomic<bool>& stop, uint64_t& meeting,
+            const SearchState& goal, const int64_t maxNodes) {
+            const auto ownSalt = m_isBackward ? BACKWARD_SALT : FORWARD_SALT;
+            const auto otherSalt = m_isBackward ? FORWARD_SALT : BACKWARD_SALT;
+            const auto surplus = std::max(m_boxCount - static_cast<int>(m_level.goals().size()), 0);
+            auto goalBoxes{ goal.boxes };
+            std::sort(goalBoxes.begin(), goalBoxes.end());
+
+            auto stamp = 0;
+            while (!m_open.empty() && static_cast<int64_t>(m_nodes.size()) < maxNodes &&
+                !stop.load(std::memory_order_relaxed) && !m_solver.isCancelled()) {
+                const auto id = m_open.top().node;
+                m_open.pop();
+                const auto node = m_nodes[id];
+                std::copy_n(m_boxPool.begin() + static_cast<ptrdiff_t>(id) * m_boxCount,
+                    m_boxCount, m_boxes.begin());
+                for (const auto box : m_boxes) {
+                    m_occupancy[box] = 1;
+                }
+                const auto normalizedPlayer = m_solver.findReachable(m_occupancy, node.player,
+                    m_reached, ++stamp, m_queue);
+
+                const auto key = node.boxKey ^ playerHash(normalizedPlayer);
+                if (!m_closed.emplace(key, id).second) {
+                    clearOccupancy();
+                    continue;
+                }
+                ++m_expandedNodes;
+
+                TranspositionEntry seen;
+                table.probe(key ^ ownSalt, { node.cost, node.push.box, node.push.direction, 0 });
+                const auto isEnd = m_isBackward ?
+                    m_boxes == goalBoxes && m_reached[goal.player] == stamp :
+                    m_solver.isSolved(m_boxes);
+                if (isEnd || table.find(key ^ otherSalt, seen)) {
+                    if (!stop.exchange(true)) {
+                        meeting = key;
+                    }
+                    clearOccupancy();
+                    break;
+                }
+
+                if (!m_isBackward) {
+                    m_lowerBound.reset(m_boxes);
+                }
+                for (int k{ 0 }; k < m_boxCount; ++k) {
+                    const auto box = m_boxes[k];
+                    for (const auto direction : SokobanLevel::DIRECTIONS) {
+                        const auto offset = m_level.offset(direction);
+                        m_isBackward ? expandPull(id, k, box, offset, direction, stamp) :
+                            expandPush(id, k, box, offset, direction, stamp, surplus);
+                    }
+                }
+                clearOccupancy();
+            }
+        }
+
+        /**
+         * @brief Returns the pushes that lead from this side's root to the position with a key
+         * forward, or from that position to this side's root backward. Empty if the position was
+         * not expanded.
+         */
+        [[nodiscard]] std::vector<Push> pushesTo(const uint64_t key) const {
+            std::vector<Push> pushes;
+            const auto found = m_closed.find(key);
+            if (found == m_closed.end()) {
+                return pushes;
+            }
+
+            for (auto id = found->second; m_nodes[id].parent >= 0; id = m_nodes[id].parent) {
+                pushes.push_back(m_nodes[id].push);
+            }
+            if (!m_isBackward) {
+                std::reverse(pushes.begin(), pushes.end());
+            }
+
+            return pushes;
+        }
+
+        [[nodiscard]] int64_t expandedNodes() const { return m_expandedNodes; }
+
+        [[nodiscard]] int64_t generatedNodes() const {
+            return static_cast<int64_t>(m_nodes.size());
+        }
+
+    private:
+        void expandPush(const int id, const int k, const int box, const int offset,
+            const Direction direction, const int stamp, const int surplus) {
+            const auto target = box + offset;
+            if (m_reached[box - offset] != stamp || m_level.isWall(target) || m_occupancy[target] ||
+                m_solver.m_lowerBound.isDeadSquare(target)) {
+                return;
+            }
+
+            Push push{ box, direction, target };
+            if (m_solver.m_options.useMacros) {
+                push = m_solver.m_macros.extend(m_occupancy, push);
+                if (m_solver.m_lowerBound.isDeadSquare(push.target)) {
+                    return;
+                }
+            }
+            if (m_solver.isFrozen(m_occupancy, box, push.target, surplus)) {
+                return;
+            }
+
+            m_lowerBound.moveBox(box, push.target);
+            const auto estimate = m_lowerBound.value();
+            m_lowerBound.moveBox(push.target, box);
+            if (estimate == SokobanLowerBound::UNREACHABLE) {
+                return;
+            }
+
+            const auto player = push.target -
+                m_level.offset(m_solver.m_macros.lastDirection(push));
+            addChild(id, k, push, player, m_solver.m_macros.pushCount(push), estimate);
+        }
+
+        void expandPull(const int id, const int k, const int box, const int offset,
+            const Direction direction, const int stamp) {
+            // The player stands next to the box and steps away from it, dragging it along. Played
+            // forward, that is a push of the box back in the opposite direction.
+            const auto from = box + offset;
+            const auto to = from + offset;
+            if (m_reached[from] != stamp || m_level.isWall(to) || m_occupancy[to]) {
+                return;
+            }
+
+            addChild(id, k, { from, opposite(direction), box }, to, 1, 0);
+        }
+
+        void addChild(const int id, const int k, const Push& push, const int player,
+            const int pushCount, const int estimate) {
+            const auto cost = m_nodes[id].cost + pushCount;
+            const auto from = m_isBackward ? push.target : push.box;
+            const auto to = m_isBackward ? push.box : push.target;
+            m_nodes.push_back({ id, push, player, cost,
+                                m_nodes[id].boxKey ^ boxHash(from) ^ boxHash(to) });
+            m_open.push({ cost + estimate, cost, static_cast<int>(m_nodes.size()) - 1 });
+
+            m_boxPool.insert(m_boxPool.end(), m_boxes.begin(), m_boxes.end());
+            const auto childBoxes = m_boxPool.end() - m_boxCount;
+            childBoxes[k] = to;
+            std::sort(childBoxes, m_boxPool.end());
+        }
+
+        void clearOccupancy() {
+            for (const auto box : m_boxes) {
+                m_occupancy[box] = 0;
+            }
+        }
+
+        const SokobanSolver& m_solver;
+        const SokobanLevel& m_level;
+        bool m_isBackward;
+        int m_boxCount;
+        SokobanLowerBound m_lowerBound;
+        std::vector<Node> m_nodes;
+        std::priority_queue<OpenEntry> m_open;
+        std::vector<int> m_boxPool;
+        std::unordered_map<uint64_t, int> m_closed;
+        std::vector<char> m_occupancy;
+        std::vector<int> m_reached;
+        std::vector<int> m_queue;
+        std::vector<int> m_boxes;
+        int64_t m_expandedNodes = 0;
+    };
+
+    /**
+     * @brief The state of an IDA* search: one position, changed in place as the depth-first walk
+     * pushes and unpushes boxes.
+     */
+    class SokobanSolver::IdaSearch {
+    public:
+        IdaSearch(const SokobanSolver& solver, const SearchState& start, std::atomic<bool>* stop)
+            : m_solver(solver), m_level(solver.m_level), m_stop(stop),
+            m_lowerBound(solver.m_lowerBound), m_table(solver.m_options.tableBytes),
+            m_reachability(m_level), m_occupancy(m_level.size(), 0), m_boxes(start.boxes),
+            m_player(start.player) {
+            m_surplus = std::max(static_cast<int>(m_boxes.size()) -
+                static_cast<int>(m_level.goals().size()), 0);
+        }
+
+        /**
+         * @brief Runs passes with a rising bound until one finds a solution, no position exceeds
+         * the bound, the node budget is spent or `stop` is set.
+         * @return True if solved; `pushes()` then leads from the start to the solution.
+         */
+        bool run() {
+            uint64_t boxKey{ 0 };
+            for (const auto box : m_boxes) {
+                m_occupancy[box] = 1;
+                boxKey ^= boxHash(box);
+            }
+            m_lowerBound.reset(m_boxes);
+            m_reachability.reset(m_boxes, m_player);
+            m_bound = m_lowerBound.value();
+
+            // Each pass salts its keys instead of clearing the table; older entries make room
+            for (uint64_t pass{ 1 }; m_bound != SokobanLowerBound::UNREACHABLE; ++pass) {
+                m_table.newSearch();
+                m_salt = pass * 0x9E3779B97F4A7C15ull;
+                m_nextBound = SokobanLowerBound::UNREACHABLE;
+                if (visit(0, boxKey)) {
+                    return true;
+                }
+                if (m_isAborted) {
+                    return false;
+                }
+                m_bound = m_nextBound;
+            }
+
+            return false;
+        }
+
+        [[nodiscard]] const std::vector<Push>& pushes() const { return m_path; }
+
+        [[nodiscard]] int64_t expandedNodes() const { return m_expandedNodes; }
+
+        [[nodiscard]] int64_t generatedNodes() const { return m_generatedNodes; }
+
+    private:
+        /**
+         * @brief A push from the position being visited and the lower bound after it.
+         */
+        struct Child {
+            int k;
+            Push push;
+            int estimate;
+        };
+
+        /**
+         * @brief Searches below the current position, reached with `cost` pushes.
+         */
+        bool visit(const int cost, const uint64_t boxKey) {
+            if (m_expandedNodes >= m_solver.m_options.maxNodes ||
+                (m_stop != nullptr && m_stop->load(std::memory_order_relaxed)) ||
+                m_solver.isCancelled()) {
+                m_isAborted = true;
+                return false;
+            }
+
+            const auto total = cost + m_lowerBound.value();
+            if (total > m_bound) {
+                m_nextBound = std::min(m_nextBound, total);
+                return false;
+            }
+            if (m_solver.isSolved(m_boxes)) {
+                if (m_stop != nullptr) {
+                    m_stop->store(true, std::memory_order_relaxed);
+                }
+                return true;
+            }
+
+            // A position seen in this pass with no more pushes has been searched with at least as
+            // much of the bound left
+            const auto key = boxKey ^ playerHash(m_reachability.normalizedPlayer()) ^ m_salt;
+            if (m_table.probe(key, { cost, -1, Direction::Up, 0 })) {
+                return false;
+            }
+            ++m_expandedNodes;
+
+            // Collect the pushes before descending, which changes what the player reaches
+            std::vector<Child> children;
+            const auto boxCount = static_cast<int>(m_boxes.size());
+            for (int k{ 0 }; k < boxCount; ++k) {
+                const auto box = m_boxes[k];
+                for (const auto direction : SokobanLevel::DIRECTIONS) {
+                    const auto offset = m_level.offset(direction);
+                    const auto target = box + offset;
+                    if (!m_reachability.canReach(box - offset) || m_level.isWall(target) ||
+                        m_occupancy[target] || m_lowerBound.isDeadSquare(target)) {
+                        continue;
+                    }
+
+                    Push push{ box, direction, target };
+                    if (m_solver.m_options.useMacros) {
+                        push = m_solver.m_macros.extend(m_occupancy, push);
+                        if (m_lowerBound.isDeadSquare(push.target)) {
+                            continue;
+                        }
+                    }
+                    if (m_solver.isFrozen(m_occupancy, box, push.target, m_surplus)) {
+                        continue;
+                    }
+
+                    m_lowerBound.moveBox(box, push.target);
+                    const auto estimate = m_lowerBound.value();
+                    m_lowerBound.moveBox(push.target, box);
+                    if (estimate != SokobanLowerBound::UNREACHABLE) {
+                        children.push_back({ k, push, estimate });
+                    }
+                }
+            }
+            std::stable_sort(children.begin(), children.end(),
+                [](const Child& first, const Child& second) {
+                    return first.estimate < second.estimate;
+                });
+
+            const auto player = m_reachability.player();
+            for (const auto& [k, push, estimate] : children) {
+                const auto box = push.box;
+                const auto childPlayer = push.target -
+                    m_level.offset(m_solver.m_macros.lastDirection(push));
+                m_occupancy[box] = 0;
+                m_occupancy[push.target] = 1;
+                m_boxes[k] = push.target;
+                m_lowerBound.moveBox(box, push.target);
+                m_reachability.moveBox(box, push.target);
+                m_reachability.movePlayer(childPlayer);
+                m_path.push_back(push);
+                ++m_generatedNodes;
+
+                if (visit(cost + m_solver.m_macros.pushCount(push),
+                    boxKey ^ boxHash(box) ^ boxHash(push.target))) {
+                    return true;
+                }
+
+                m_path.pop_back();
+                m_reachability.movePlayer(player);
+                m_reachability.moveBox(push.target, box);
+                m_lowerBound.moveBox(push.target, box);
+                m_boxes[k] = box;
+                m_occupancy[push.target] = 0;
+                m_occupancy[box] = 1;
+                if (m_isAborted) {
+                    return false;
+                }
+            }
+
+            return false;
+        }
+
+        const SokobanSolver& m_solver;
+        const SokobanLevel& m_level;
+        std::atomic<bool>* m_stop;
+        SokobanLowerBound m_lowerBound;
+        SokobanTranspositionTable m_table;
+        SokobanReachability m_reachability;
+        std::vector<char> m_occupancy;
+        std::vector<int> m_boxes;
+        std::vector<Push> m_path;
+        int m_player;
+        int m_surplus = 0;
+        int m_bound = 0;
+        int m_nextBound = 0;
+        uint64_t m_salt = 0;
+        bool m_isAborted = false;
+        int64_t m_expandedNodes = 0;
+        int64_t m_generatedNodes = 0;
+    };
+
+    SokobanSolver::SokobanSolver(const SokobanLevel& level, const SolverOptions& options)
+        : m_level(level), m_options(options), m_macros(level), m_lowerBound(level) {}
+
+    SearchState SokobanSolver::initialState(const SokobanLevel& level) {
+        return { level.initialBoxes(), level.initialPlayer() };
+    }
+
+    void SokobanSolver::setDeadlockTable(const SokobanDeadlockTable* deadlockTable) {
+        m_deadlockTable = deadlockTable;
+    }
+
+    SolverResult SokobanSolver::solve() const { return solve(initialState(m_level)); }
+
+    SolverResult SokobanSolver::solve(const SearchState& start) const {
+        if (m_options.externalMemory) {
+            return solveExternal(start);
+        }
+
+        if (!m_options.portfolio.empty()) {
+            return solvePortfolio(start);
+        }
+
+        if (m_options.bidirectional && start.boxes.size() == m_level.goals().size()) {
+            return solveBidirectional(start);
+        }
+
+        // IDA* keeps its memory bounded by searching alone
+        const auto workerCount = std::max(m_options.threads, 1);
+        if (workerCount == 1 || m_options.strategy == Strategy::IdaStar) {
+            return search(start, m_options.strategy, nullptr);
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        SokobanTranspositionTable table{ m_options.tableBytes };
+        std::atomic<bool> stop{ false };
+        std::vector<SolverResult> results(workerCount);
+        parallelFor(workerCount, [&](const int worker) {
+            results[worker] = search(start, m_options.strategy, &table, &stop, worker,
+                workerCount);
+            }, static_cast<unsigned>(workerCount));
+
+        SolverResult result;
+        for (const auto& workerResult : results) {
+            if (workerResult.isSolved && (!result.isSolved || workerResult.pushes < result.pushes)) {
+                result.isSolved = true;
+                result.solution = workerResult.solution;
+                result.pushes = workerResult.pushes;
+                result.moves = workerResult.moves;
+            }
+            result.expandedNodes += workerResult.expandedNodes;
+            result.generatedNodes += workerResult.generatedNodes;
+        }
+        result.transpositions = table.stats();
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+        return result;
+    }
+
+    SolverResult SokobanSolver::solveBidirectional(const SearchState& start) const {
+        const auto startTime = std::chrono::steady_clock::now();
+        const auto boxCount = static_cast<int>(start.boxes.size());
+
+        HalfSearch forward{ *this, false, boxCount };
+        forward.addRoot(start.boxes, start.player);
+
+        // One backward root per player area around the filled storages
+        HalfSearch backward{ *this, true, boxCount };
+        std::vector<char> occupancy(m_level.size(), 0);
+        for (const auto goal : m_level.goals()) {
+            occupancy[goal] = 1;
+        }
+        std::vector<int> reached(m_level.size(), 0);
+        std::vector<int> queue;
+        for (int cell{ 0 }; cell < m_level.size(); ++cell) {
+            if (!m_level.isWall(cell) && !occupancy[cell] && reached[cell] == 0) {
+                backward.addRoot(m_level.goals(), findReachable(occupancy, cell, reached, 1, queue));
+            }
+        }
+
+        SokobanTranspositionTable table{ m_options.tableBytes };
+        std::atomic<bool> stop{ false };
+        uint64_t meeting{ 0 };
+        const auto maxNodes = m_options.maxNodes / 2;
+        parallelFor(2, [&](const int side) {
+            (side == 0 ? forward : backward).run(table, stop, meeting, start, maxNodes);
+            }, 2);
+
+        SolverResult result;
+        if (stop.load()) {
+            auto pushes = forward.pushesTo(meeting);
+            const auto pulls = backward.pushesTo(meeting);
+            pushes.insert(pushes.end(), pulls.begin(), pulls.end());
+
+            result.isSolved = true;
+            result.solution = toLurd(start, pushes);
+            result.moves = static_cast<int>(result.solution.size());
+            result.pushes = static_cast<int>(std::count_if(result.solution.begin(),
+                result.solution.end(), [](const char lurd) { return std::isupper(lurd) != 0; }));
+        }
+        result.expandedNodes = forward.expandedNodes() + backward.expandedNodes();
+        result.generatedNodes = forward.generatedNodes() + backward.generatedNodes();
+        result.transpositions = table.stats();
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+        return result;
+    }
+
+    SolverResult SokobanSolver::solvePortfolio(const SearchState& start) const {
+        const auto startTime = std::chrono::steady_clock::now();
+        const auto count = static_cast<int>(m_options.portfolio.size());
+        std::atomic<bool> stop{ false };
+        std::atomic<int> winner{ -1 };
+        std::vector<SolverResult> results(count);
+        parallelFor(count, [&](const int i) {
+            results[i] = search(start, m_options.portfolio[i], &stop);
+            auto none = -1;
+            if (results[i].isSolved && winner.compare_exchange_strong(none, i)) {
+                // Whoever set the flag, the first to return with a solution wins
+                stop.store(true);
+            }
+            }, static_cast<unsigned>(count));
+
+        SolverResult result;
+        for (int i{ 0 }; i < count; ++i) {
+            const auto& strategyResult = results[i];
+            result.strategies.push_back({ m_options.portfolio[i], strategyResult.isSolved,
+                i == winner.load(), strategyResult.expandedNodes, strategyResult.seconds });
+            result.expandedNodes += strategyResult.expandedNodes;
+            result.generatedNodes += strategyResult.generatedNodes;
+        }
+        if (winner.load() >= 0) {
+            const auto& best = results[winner.load()];
+            result.isSolved = true;
+            result.solution = best.solution;
+            result.pushes = best.pushes;
+            result.moves = best.moves;
+        }
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+        return result;
+    }
+
+    SolverResult SokobanSolver::search(const SearchState& start, const Strategy strategy,
+        std::atomic<bool>* stop) const {
+        if (strategy == Strategy::IdaStar) {
+            return searchIda(start, stop);
+        }
+
+        return search(start, strategy, nullptr, stop, 0, 1);
+    }
+
+    SolverResult SokobanSolver::searchIda(const SearchState& start, std::atomic<bool>* stop) const {
+        const auto startTime = std::chrono::steady_clock::now();
+        IdaSearch ida{ *this, start, stop };
+        SolverResult result;
+        if (ida.run()) {
+            result.isSolved = true;
+            result.solution = toLurd(start, ida.pushes());
+            result.moves = static_cast<int>(result.solution.size());
+            result.pushes = static_cast<int>(std::count_if(result.solution.begin(),
+                result.solution.end(), [](const char lurd) { return std::isupper(lurd) != 0; }));
+        }
+        result.expandedNodes = ida.expandedNodes();
+        result.generatedNodes = ida.generatedNodes();
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+
+        return result;
+    }
+
+    SolverResult SokobanSolver::search(const SearchState& start, const Strategy strategy,
+        SokobanTranspositionTable* table, std::atomic<bool>* stop, const int worker,
+        const int workerCount) const {
+        const auto startTime = std::chrono::steady_clock::now();
+        SolverResult result;
+
+        const auto boxCount = static_cast<int>(start.boxes.size());
+        const auto surplus =
+            std::max(boxCount - static_cast<int>(m_level.goals().size()), 0);
+        auto lowerBound{ m_lowerBound };
+
+        std::vector<Node> nodes;
+        std::vector<int> boxPool;
+        std::priority_queue<OpenEntry> open;
+
+        // Without a shared table, positions are kept whole and packed, so none is mistaken for
+        // another with the same hash
+        const SokobanStateCodec codec{ m_level, start, &m_lowerBound };
+        SokobanStateSet closed{ codec.bytes() };
+        std::vector<uint8_t> record(codec.bytes());
+
+        auto startBoxes{ start.boxes };
+        std::sort(startBoxes.begin(), startBoxes.end());
+        uint64_t startKey{ 0 };
+        for (const auto box : startBoxes) {
+            startKey ^= boxHash(box);
+        }
+        nodes.push_back({ -1, {}, start.player, 0, startKey });
+        boxPool.insert(boxPool.end(), startBoxes.begin(), startBoxes.end());
+        lowerBound.reset(startBoxes);
+        open.push({ priority(strategy, 0, lowerBound.value()), 0, 0 });
+
+        std::vector<char> occupancy(m_level.size(), 0);
+        std::vector<int> reached(m_level.size(), 0);
+        std::vector<int> queue;
+        std::vector<int> boxes(boxCount);
+        auto stamp = 0;
+        auto solvedNode = -1;
+
+        const auto maxNodes = m_options.maxNodes / workerCount;
+        auto rootPush = 0;
+        while (!open.empty() && solvedNode < 0 && static_cast<int64_t>(nodes.size()) < maxNodes &&
+            (stop == nullptr || !stop->load(std::memory_order_relaxed)) && !isCancelled()) {
+            const auto id = open.top().node;
+            open.pop();
+            const auto node = nodes[id];
+            std::copy_n(boxPool.begin() + static_cast<ptrdiff_t>(id) * boxCount, boxCount,
+                boxes.begin());
+
+            // Find the area the player can reach; its top-left cell stands for the whole area
+            for (const auto box : boxes) {
+                occupancy[box] = 1;
+            }
+            const auto normalizedPlayer = findReachable(occupancy, node.player, reached, ++stamp,
+                queue);
+
+            // The start is never looked up in a shared table: every worker has to expand it
+            auto isClosed = false;
+            if (table == nullptr) {
+                codec.encode(boxes, normalizedPlayer, record.data());
+                isClosed = !closed.insert(record.data());
+            }
+            else {
+                isClosed = id != 0 && table->probe(node.boxKey ^ playerHash(normalizedPlayer),
+                    { node.cost, node.push.box, node.push.direction, 0 });
+            }
+            if (isClosed) {
+                for (const auto box : boxes) {
+                    occupancy[box] = 0;
+                }
+                continue;
+            }
+
+            ++result.expandedNodes;
+            if (isSolved(boxes)) {
+                solvedNode = id;
+                if (stop != nullptr) {
+                    stop->store(true, std::memory_order_relaxed);
+                }
+                break;
+            }
+
+            lowerBound.reset(boxes);
+            for (int k{ 0 }; k < boxCount; ++k) {
+                const auto box = boxes[k];
+                for (const auto direction : SokobanLevel::DIRECTIONS) {
+                    const auto offset = m_level.offset(direction);
+                    const auto target = box + offset;
+                    if (reached[box - offset] != stamp || m_level.isWall(target) ||
+                        occupancy[target] || lowerBound.isDeadSquare(target)) {
+                        continue;
+                    }
+
+                    if (id == 0 && rootPush++ % workerCount != worker) {
+                        continue;
+                    }
+
+                    Push push{ box, direction, target };
+                    if (m_options.useMacros) {
+                        push = m_macros.extend(occupancy, push);
+                        if (lowerBound.isDeadSquare(push.target)) {
+                            continue;
+                        }
+                    }
+
+                    if (isFrozen(occupancy, box, push.target, surplus)) {
+                        continue;
+                    }
+
+                    // Estimate with one incremental re-match, then restore the parent's matching
+                    lowerBound.moveBox(box, push.target);
+                    const auto estimate = lowerBound.value();
+                    lowerBound.moveBox(push.target, box);
+                    if (estimate == SokobanLowerBound::UNREACHABLE) {
+                        continue;
+                    }
+
+                    const auto cost = node.cost + m_macros.pushCount(push);
+                    const auto player = push.target - m_level.offset(m_macros.lastDirection(push));
+                    const auto childId = static_cast<int>(nodes.size());
+                    nodes.push_back({ id, push, player, cost,
+                                      node.boxKey ^ boxHash(box) ^ boxHash(push.target) });
+
+                    boxPool.insert(boxPool.end(), boxes.begin(), boxes.end());
+                    const auto childBoxes = boxPool.end() - boxCount;
+                    childBoxes[k] = push.target;
+                    std::sort(childBoxes, boxPool.end());
+
+                    open.push({ priority(strategy, cost, estimate), cost, childId });
+                    ++result.generatedNodes;
+                }
+            }
+
+            for (const auto box : boxes) {
+                occupancy[box] = 0;
+            }
+        }
+
+        if (solvedNode >= 0) {
+            std::vector<Push> pushes;
+            for (auto id = solvedNode; nodes[id].parent >= 0; id = nodes[id].parent) {
+                pushes.push_back(nodes[id].push);
+            }
+            std::reverse(pushes.begin(), pushes.end());
+
+            result.isSolved = true;
+            result.solution = toLurd(start, pushes);
+            result.moves = static_cast<int>(result.solution.size());
+            result.pushes = static_cast<int>(std::count_if(result.solution.begin(),
+                result.solution.end(), [](const char lurd) { return std::isupper(lurd) != 0; }));
+        }
+
+        if (table == nullptr) {
+            result.visited = { closed.size(), closed.bytes(), codec.bytes() };
+        }
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        return result;
+    }
+
+    std::string SokobanSolver::toLurd(const SearchState& start, const std::vector<Push>& pushes)
+        const {
+        SokobanPushGraph graph{ m_level };
+        auto state = start;
+        std::sort(state.boxes.begin(), state.boxes.end());
+        std::string lurd;
+        for (const auto& push : pushes) {
+            auto box = push.box;
+            for (const auto direction : m_macros.expand(push)) {
+                const Push single{ box, direction, box + m_level.offset(direction) };
+                for (const auto move : graph.walk(state, single)) {
+                    lurd.push_back(SB::toLurd(move, false));
+                }
+                lurd.back() = SB::toLurd(direction, true);
+
+                state = graph.apply(state, single);
+                box = single.target;
+            }
+        }
+
+        return lurd;
+    }
+
+    const SokobanLevel& SokobanSolver::level() const { return m_level; }
+
+    const SokobanMacros& SokobanSolver::macros() const { return m_macros; }
+
+    bool SokobanSolver::isCancelled() const {
+        return m_options.cancel != nullptr && m_options.cancel->load(std::memory_order_relaxed);
+    }
+
+    bool SokobanSolver::isSolved(const std::vector<int>& boxes) const {
+        const auto target = std::min(boxes.size(), m_level.goals().size());
+        const auto onGoals = std::count_if(boxes.begin(), boxes.end(),
+            [&](const int box) { return m_level.isGoal(box); });
+        return static_cast<size_t>(onGoals) >= target;
+    }
+
+    int SokobanSolver::findReachable(const std::vector<char>& boxes, const int player,
+        std::vector<int>& reached, const int stamp, std::vector<int>& queue) const {
+        queue.assign(1, player);
+        reached[player] = stamp;
+        auto normalizedPlayer = player;
+        for (size_t head{ 0 }; head < queue.size(); ++head) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto next = queue[head] + m_level.offset(direction);
+                if (!m_level.isWall(next) && !boxes[next] && reached[next] != stamp) {
+                    reached[next] = stamp;
+                    normalizedPlayer = std::min(normalizedPlayer, next);
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        return normalizedPlayer;
+    }
+
+    bool SokobanSolver::isFrozen(std::vector<char>& boxes, const int from, const int to,
+        const int surplus) const {
+        if (m_deadlockTable == nullptr) {
+            return false;
+        }
+
+        boxes[from] = 0;
+        boxes[to] = 1;
+        const auto frozen = m_deadlockTable->frozenBoxCount(m_level, to,
+            [&](const int index) { return boxes[index] != 0; });
+        boxes[to] = 0;
+        boxes[from] = 1;
+
+        return frozen > surplus;
+    }
+
+}  // namespace SB
@@ -0,0 +1,382 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSOLVER_HPP
+#define SOKOBANSOLVER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SokobanDeadlockTable.hpp"
+#include "SokobanLevel.hpp"
+#include "SokobanLowerBound.hpp"
+#include "SokobanMacros.hpp"
+#include "SokobanSearch.hpp"
+#include "SokobanTranspositionTable.hpp"
+
+namespace SB {
+
+    /**
+     * @brief The ways the solver can order its search over pushes.
+     */
+    enum class Strategy {
+        /**
+         * @brief Best first by pushes made plus the lower bound: the fewest pushes, in good time.
+         */
+        AStar,
+
+        /**
+         * @brief Fewest pushes made first; suits short levels, where the lower bound helps little.
+         */
+        BreadthFirst,
+
+        /**
+         * @brief Lowest lower bound first, ignoring the pushes made; suits wide levels with many
+         * solutions, but the solution may be long.
+         */
+        GreedyBestFirst,
+
+        /**
+         * @brief Depth-first A* with an increasing bound, remembering positions in the fixed-size
+         * transposition table only; suits levels whose open list would not fit in memory.
+         */
+        IdaStar,
+    };
+
+    /**
+     * @brief Returns the name of a strategy: "astar", "bfs", "greedy" or "ida".
+     */
+    [[nodiscard]] const char* strategyName(Strategy strategy);
+
+    /**
+     * @brief Parameters of the solver.
+     */
+    struct SolverOptions {
+        bool useMacros = true;
+        int64_t maxNodes = 4000000;
+
+        /**
+         * @brief How the search orders positions.
+         */
+        Strategy strategy = Strategy::AStar;
+
+        /**
+         * @brief Strategies to race, one single-threaded search each on a thread of its own. The
+         * first solution found wins and the others are stopped. Empty to run `strategy` alone.
+         */
+        std::vector<Strategy> portfolio;
+
+        /**
+         * @brief Set from another thread to make the search give up without a solution; nullptr if
+         * it can't be cancelled.
+         */
+        std::atomic<bool>* cancel = nullptr;
+
+        /**
+         * @brief The number of search threads. With more than one, the pushes from the start are
+         * dealt out to the threads, which share a transposition table as their closed set.
+         */
+        int threads = 1;
+
+        /**
+         * @brief The memory budget of the shared transposition table in bytes.
+         */
+        size_t tableBytes = size_t{ 64 } << 20;
+
+        /**
+         * @brief Search forward from the start and backward from the solved positions at the same
+         * time, on two threads. Needs as many boxes as storages; otherwise the search runs forward
+         * only.
+         */
+        bool bidirectional = false;
+
+        /**
+         * @brief Search breadth-first over pushes with the visited set on disk instead of in memory.
+         * Each layer is written as a sorted, compressed state file and merged against the visited
+         * states with streaming reads. The solution has the fewest pushes, counting a macro as one.
+         */
+        bool externalMemory = false;
+
+        /**
+         * @brief The memory the external-memory search may use for state buffers, in bytes.
+         */
+        size_t memoryBytes = size_t{ 256 } << 20;
+
+        /**
+         * @brief Where the external-memory search writes its state files; empty for the system
+         * temporary directory. The files are removed when the search ends.
+         */
+        std::string spillDirectory;
+    };
+
+    /**
+     * @brief Counters of the external-memory search.
+     */
+    struct ExternalStats {
+        /**
+         * @brief The number of breadth-first layers expanded.
+         */
+        int layers = 0;
+
+        /**
+         * @brief The number of distinct states written to new layers.
+         */
+        uint64_t statesWritten = 0;
+
+        /**
+         * @brief The number of states read by merges, runs and visited set together.
+         */
+        uint64_t statesMerged = 0;
+
+        uint64_t bytesWritten = 0;
+        uint64_t bytesRead = 0;
+
+        /**
+         * @brief The time spent sorting runs and merging them with the visited set.
+         */
+        double mergeSeconds = 0.0;
+
+        /**
+         * @brief The most memory the state buffers held, in bytes.
+         */
+        size_t peakBufferBytes = 0;
+    };
+
+    /**
+     * @brief The memory of the closed set of a best-first search with a table of its own.
+     */
+    struct VisitedStats {
+        uint64_t states = 0;
+
+        /**
+         * @brief The memory the set holds, in bytes.
+         */
+        size_t bytes = 0;
+
+        /**
+         * @brief The size of one encoded state; see `SokobanStateCodec`.
+         */
+        size_t recordBytes = 0;
+    };
+
+    /**
+     * @brief How one strategy of a portfolio fared.
+     */
+    struct StrategyStats {
+        Strategy strategy = Strategy::AStar;
+        bool isSolved = false;
+
+        /**
+         * @brief True for the strategy whose solution was taken.
+         */
+        bool isWinner = false;
+
+        int64_t expandedNodes = 0;
+
+        /**
+         * @brief The time the strategy ran until it solved the level, gave up or was stopped.
+         */
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief The outcome of a search.
+     */
+    struct SolverResult {
+        bool isSolved = false;
+        std::string solution;
+        int pushes = 0;
+        int moves = 0;
+        int64_t expandedNodes = 0;
+        int64_t generatedNodes = 0;
+        double seconds = 0.0;
+        TranspositionStats transpositions;
+        ExternalStats external;
+        VisitedStats visited;
+
+        /**
+         * @brief One entry per strategy of a portfolio, in the order given; empty otherwise.
+         */
+        std::vector<StrategyStats> strategies;
+    };
+
+    /**
+     * @brief Solves levels with a search over pushes, A* unless another strategy is chosen. The
+     * player's walks between pushes are not part of the search: a position is the set of boxes
+     * plus the area the player can reach, and the walks are filled in when the solution is written
+     * out. Pushes into dead squares, pushes the deadlock table rejects and positions whose lower
+     * bound is unreachable are pruned, and pushes through tunnels and into goal rooms are collapsed
+     * into macro pushes.
+     */
+    class SokobanSolver {
+    public:
+        /**
+         * @brief Creates a solver for a level and precomputes its distance tables and macros.
+         * @param level The level to solve.
+         * @param options The solver parameters.
+         */
+        explicit SokobanSolver(const SokobanLevel& level, const SolverOptions& options = {});
+
+        /**
+         * @brief Returns the position the level starts in.
+         */
+        [[nodiscard]] static SearchState initialState(const SokobanLevel& level);
+
+        /**
+         * @brief Lets the solver prune with a deadlock table. The table must outlive the solver.
+         */
+        void setDeadlockTable(const SokobanDeadlockTable* deadlockTable);
+
+        /**
+         * @brief Solves the level from its initial position.
+         * @throws std::runtime_error in external-memory mode if the state files can't be written.
+         */
+        [[nodiscard]] SolverResult solve() const;
+
+        /**
+         * @brief Solves the level from a given position.
+         * @throws std::runtime_error in external-memory mode if the state files can't be written.
+         */
+        [[nodiscard]] SolverResult solve(const SearchState& start) const;
+
+        /**
+         * @brief Writes a push sequence out as a LURD solution, filling in the player's walks.
+         * @param start The position the pushes start from.
+         * @param pushes The pushes, possibly macros.
+         */
+        [[nodiscard]] std::string toLurd(const SearchState& start, const std::vector<Push>& pushes)
+            const;
+
+        /**
+         * @brief Returns the level.
+         */
+        [[nodiscard]] const SokobanLevel& level() const;
+
+        /**
+         * @brief Returns the macros found in the level.
+         */
+        [[nodiscard]] const SokobanMacros& macros() const;
+
+    private:
+        class HalfSearch;
+        class IdaSearch;
+        struct ExternalScratch;
+
+        /**
+         * @brief Runs the breadth-first search with disk-based duplicate detection. Defined in
+         * `SokobanSolverExternal.cpp`.
+         * @throws std::runtime_error if the state files can't be written or read.
+         */
+        [[nodiscard]] SolverResult solveExternal(const SearchState& start) const;
+
+        /**
+         * @brief Calls `visit(push, child)` for every push from a state record that survives the
+         * pruning, where `child` is the record of the position after the push. A record is the box
+         * cells in ascending order followed by the normalized player cell.
+         */
+        template <typename Visit>
+        void expandRecord(const int* record, ExternalScratch& scratch, Visit&& visit) const;
+
+        /**
+         * @brief Runs an A* push search from the start and a uniform-cost pull search from every
+         * position with all storages filled, one per player area, on two threads. Both
+         * record the positions they expand in a shared transposition table and stop at the first
+         * position the other has seen; the solution is the push path to it followed by the
+         * reversed pull path.
+         */
+        [[nodiscard]] SolverResult solveBidirectional(const SearchState& start) const;
+
+        /**
+         * @brief Runs the strategies of the portfolio on a thread each, sharing one stop flag.
+         */
+        [[nodiscard]] SolverResult solvePortfolio(const SearchState& start) const;
+
+        /**
+         * @brief Runs one search with a strategy.
+         * @param stop Set by the search that finds a solution; the search gives up when it sees it.
+         * May be nullptr.
+         */
+        [[nodiscard]] SolverResult search(const SearchState& start, Strategy strategy,
+            std::atomic<bool>* stop) const;
+
+        /**
+         * @brief Runs one best-first search.
+         * @param start The position to search from.
+         * @param strategy How to order the open list; not `Strategy::IdaStar`.
+         * @param table The shared closed set, or nullptr for a private one.
+         * @param stop Set by the search that finds a solution; the others give up when they see it.
+         * May be nullptr.
+         * @param worker Only every `workerCount`-th push from the start, from the `worker`-th on, is
+         * searched.
+         */
+        [[nodiscard]] SolverResult search(const SearchState& start, Strategy strategy,
+            SokobanTranspositionTable* table, std::atomic<bool>* stop, int worker, int workerCount)
+            const;
+
+        /**
+         * @brief Runs an IDA* search: depth-first passes bounded by pushes plus lower bound, the
+         * bound raised to the smallest value that exceeded it after each pass. Positions seen in a
+         * pass are kept in a transposition table of `tableBytes`, so memory doesn't grow with the
+         * search.
+         */
+        [[nodiscard]] SolverResult searchIda(const SearchState& start, std::atomic<bool>* stop)
+            const;
+
+        /**
+         * @brief Returns true if the caller cancelled the search; see `SolverOptions::cancel`.
+         */
+        [[nodiscard]] bool isCancelled() const;
+
+        /**
+         * @brief Returns true if enough boxes are on storages to win.
+         */
+        [[nodiscard]] bool isSolved(const std::vector<int>& boxes) const;
+
+        /**
+         * @brief Finds the cells the player can reach.
+         * @param boxes One flag per cell; set for cells holding a box.
+         * @param player The player cell.
+         * @param reached Set to `stamp` for every reachable cell.
+         * @param queue Scratch space.
+         * @return The top-left reachable cell, which stands for the whole area.
+         */
+        int findReachable(const std::vector<char>& boxes, int player, std::vector<int>& reached,
+            int stamp, std::vector<int>& queue) const;
+
+        /**
+         * @brief Returns true if moving a box freezes more boxes than the level can spare.
+         * @param boxes One flag per cell; set for cells holding a box. Restored before returning.
+         * @param surplus The number of boxes that may stay off storages.
+         */
+        [[nodiscard]] bool isFrozen(std::vector<char>& boxes, int from, int to, int surplus) const;
+
+        /**
+         * @brief The level.
+         */
+        SokobanLevel m_level;
+
+        /**
+         * @brief The solver parameters.
+         */
+        SolverOptions m_options;
+
+        /**
+         * @brief The macros found in the level.
+         */
+        SokobanMacros m_macros;
+
+        /**
+         * @brief The lower bound with its precomputed distance tables. Each search works on a copy.
+         */
+        SokobanLowerBound m_lowerBound;
+
+        /**
+         * @brief The deadlock table, or nullptr.
+         */
+        const SokobanDeadlockTable* m_deadlockTable = nullptr;
+    };
+
+}  // namespace SB
+
+#endif
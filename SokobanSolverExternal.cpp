@@ -0,0 +1,443 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanSolver.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "SokobanStateFile.hpp"
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief A directory of state files that is removed with everything in it when destroyed.
+         */
+        class SpillDirectory {
+        public:
+            explicit SpillDirectory(const std::string& parent) {
+                static std::atomic<int> counter{ 0 };
+                const auto base = parent.empty() ? std::filesystem::temp_directory_path() :
+                    std::filesystem::path{ parent };
+                m_path = base / ("sokoban-" + std::to_string(getpid()) + "-" +
+                    std::to_string(counter++));
+                std::filesystem::create_directories(m_path);
+            }
+
+            SpillDirectory(const SpillDirectory&) = delete;
+            SpillDirectory& operator=(const SpillDirectory&) = delete;
+
+            ~SpillDirectory() {
+                std::error_code error;
+                std::filesystem::remove_all(m_path, error);
+            }
+
+            /**
+             * @brief Returns the path of a file in the directory.
+             */
+            [[nodiscard]] std::string file(const std::string& name) const {
+                return (m_path / name).string();
+            }
+
+        private:
+            std::filesystem::path m_path;
+        };
+
+        /**
+         * @brief Returns true if one record sorts before another.
+         */
+        bool isLess(const int* first, const int* second, const int width) {
+            return std::lexicographical_compare(first, first + width, second, second + width);
+        }
+
+        bool isEqual(const int* first, const int* second, const int width) {
+            return std::equal(first, first + width, second);
+        }
+
+    }  // namespace
+
+    /**
+     * @brief The buffers one expansion needs, kept across expansions.
+     */
+    struct SokobanSolver::ExternalScratch {
+        ExternalScratch(const SokobanSolver& solver, const int boxCount)
+            : boxCount(boxCount),
+              surplus(std::max(boxCount - static_cast<int>(solver.m_level.goals().size()), 0)),
+              lowerBound(solver.m_lowerBound), occupancy(solver.m_level.size(), 0),
+              reached(solver.m_level.size(), 0), childReached(solver.m_level.size(), 0),
+              boxes(boxCount), child(boxCount + 1) {}
+
+        int boxCount;
+        int surplus;
+        SokobanLowerBound lowerBound;
+        std::vector<char> occupancy;
+        std::vector<int> reached;
+        std::vector<int> childReached;
+        std::vector<int> queue;
+        std::vector<int> boxes;
+        std::vector<int> child;
+        int stamp = 0;
+        int childStamp = 0;
+    };
+
+    template <typename Visit>
+    void SokobanSolver::expandRecord(const int* record, ExternalScratch& scratch, Visit&& visit)
+        const {
+        const auto boxCount = scratch.boxCount;
+        auto& occupancy = scratch.occupancy;
+        auto& reached = scratch.reached;
+        std::copy_n(record, boxCount, scratch.boxes.begin());
+        for (const auto box : scratch.boxes) {
+            occupancy[box] = 1;
+        }
+        const auto stamp = ++scratch.stamp;
+        static_cast<void>(findReachable(occupancy, record[boxCount], reached, stamp, scratch.queue));
+
+        auto& lowerBound = scratch.lowerBound;
+        lowerBound.reset(scratch.boxes);
+        for (int k{ 0 }; k < boxCount; ++k) {
+            const auto box = scratch.boxes[k];
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto offset = m_level.offset(direction);
+                const auto target = box + offset;
+                if (reached[box - offset] != stamp || m_level.isWall(target) ||
+                    occupancy[target] || lowerBound.isDeadSquare(target)) {
+                    continue;
+                }
+
+                Push push{ box, direction, target };
+                if (m_options.useMacros) {
+                    push = m_macros.extend(occupancy, push);
+                    if (lowerBound.isDeadSquare(push.target)) {
+                        continue;
+                    }
+                }
+
+                if (isFrozen(occupancy, box, push.target, scratch.surplus)) {
+                    continue;
+                }
+
+                lowerBound.moveBox(box, push.target);
+                const auto estimate = lowerBound.value();
+                lowerBound.moveBox(push.target, box);
+                if (estimate == SokobanLowerBound::UNREACHABLE) {
+                    continue;
+                }
+
+                // The child's record: its sorted boxes, then its normalized player
+                auto& child = scratch.child;
+                std::copy(scratch.boxes.begin(), scratch.boxes.end(), child.begin());
+                child[k] = push.target;
+                std::sort(child.begin(), child.begin() + boxCount);
+                occupancy[box] = 0;
+                occupancy[push.target] = 1;
+                const auto player = push.target - m_level.offset(m_macros.lastDirection(push));
+                child[boxCount] = findReachable(occupancy, player, scratch.childReached,
+                    ++scratch.childStamp, scratch.queue);
+                occupancy[push.target] = 0;
+                occupancy[box] = 1;
+
+                visit(push, child.data());
+            }
+        }
+
+        for (const auto box : scratch.boxes) {
+            occupancy[box] = 0;
+        }
+    }
+
+    SolverResult SokobanSolver::solveExternal(const SearchState& start) const {
+        const auto startTime = std::chrono::steady_clock::now();
+        SolverResult result;
+        auto& stats = result.external;
+
+        const auto boxCount = static_cast<int>(start.boxes.size());
+        const auto width = boxCount + 1;
+        const SpillDirectory directory{ m_options.spillDirectory };
+        ExternalScratch scratch{ *this, boxCount };
+
+        // While a layer is expanded, the successor buffer gets what the budget leaves after the
+        // frontier reader and the run writer. It is freed before merging, where the budget goes to
+        // file buffers: one per run read, plus the visited set and two writers.
+        const auto recordBytes = sizeof(int) * (width + 1);
+        const auto fileBuffers = 2 * STATE_FILE_BUFFER_BYTES;
+        const auto capacity = std::max<size_t>(
+            (m_options.memoryBytes - std::min(m_options.memoryBytes, fileBuffers)) / recordBytes, 1);
+        const auto fanIn = std::max<size_t>(m_options.memoryBytes / STATE_FILE_BUFFER_BYTES, 5) - 3;
+
+        const auto layerFile = [&](const int layer) {
+            return directory.file("layer-" + std::to_string(layer));
+        };
+
+        // Layer 0 and the first visited set hold the start alone
+        std::vector<int> startRecord{ start.boxes };
+        std::sort(startRecord.begin(), startRecord.end());
+        {
+            for (const auto box : startRecord) {
+                scratch.occupancy[box] = 1;
+            }
+            startRecord.push_back(findReachable(scratch.occupancy, start.player, scratch.reached,
+                ++scratch.stamp, scratch.queue));
+            for (int k{ 0 }; k < boxCount; ++k) {
+                scratch.occupancy[startRecord[k]] = 0;
+            }
+        }
+        for (const auto& name : { layerFile(0), directory.file("visited-0") }) {
+            SokobanStateFileWriter writer{ name, width };
+            writer.write(startRecord.data());
+            writer.close();
+            stats.bytesWritten += writer.bytes();
+        }
+        stats.statesWritten = 1;
+
+        // The push into a solved position, once found, and the record it was made from
+        std::vector<int> parent(width);
+        Push lastPush{};
+        auto isFound = isSolved(start.boxes);
+        auto layer = 0;
+
+        std::vector<int> buffer;
+        std::vector<int> order;
+        std::vector<int> childBoxes;
+        while (!isFound) {
+            // Expand the layer, spilling the successors as sorted runs whenever the buffer fills
+            std::vector<std::string> runs;
+            const auto spill = [&] {
+                const auto mergeStart = std::chrono::steady_clock::now();
+                const auto count = static_cast<int>(buffer.size() / width);
+                order.resize(count);
+                std::iota(order.begin(), order.end(), 0);
+                std::sort(order.begin(), order.end(), [&](const int first, const int second) {
+                    return isLess(&buffer[first * width], &buffer[second * width], width);
+                    });
+                stats.peakBufferBytes = std::max(stats.peakBufferBytes,
+                    buffer.capacity() * sizeof(int) + order.capacity() * sizeof(int));
+
+                runs.push_back(directory.file("run-" + std::to_string(runs.size())));
+                SokobanStateFileWriter writer{ runs.back(), width };
+                for (const auto index : order) {
+                    writer.write(&buffer[index * width]);
+                }
+                writer.close();
+                stats.bytesWritten += writer.bytes();
+                buffer.clear();
+                stats.mergeSeconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - mergeStart).count();
+            };
+
+            {
+                SokobanStateFileReader frontier{ layerFile(layer), width };
+                while (!isFound && result.generatedNodes < m_options.maxNodes && !isCancelled() &&
+                    frontier.next()) {
+                    ++result.expandedNodes;
+                    expandRecord(frontier.record(), scratch, [&](const Push& push, const int* child) {
+                        if (isFound) {
+                            return;
+                        }
+
+                        ++result.generatedNodes;
+                        childBoxes.assign(child, child + boxCount);
+                        if (isSolved(childBoxes)) {
+                            std::copy_n(frontier.record(), width, parent.begin());
+                            lastPush = push;
+                            isFound = true;
+                            return;
+                        }
+
+                        // Grow the buffer by hand so that it never holds more than the budget
+                        if (buffer.size() == buffer.capacity()) {
+                            buffer.reserve(std::min(capacity * width,
+                                std::max<size_t>(2 * buffer.capacity(), 1024 * width)));
+                        }
+                        buffer.insert(buffer.end(), child, child + width);
+                        if (buffer.size() >= capacity * width) {
+                            spill();
+                        }
+                        });
+                }
+                stats.bytesRead += frontier.bytes();
+            }
+            ++stats.layers;
+            if (isFound || result.generatedNodes >= m_options.maxNodes || isCancelled()) {
+                break;
+            }
+            if (!buffer.empty()) {
+                spill();
+            }
+            if (runs.empty()) {
+                break;
+            }
+            std::vector<int>().swap(buffer);
+            std::vector<int>().swap(order);
+
+            const auto mergeStart = std::chrono::steady_clock::now();
+            stats.peakBufferBytes = std::max(stats.peakBufferBytes,
+                (std::min(runs.size(), fanIn) + 3) * STATE_FILE_BUFFER_BYTES);
+
+            // Merge runs until one pass can take them all
+            auto pass = 0;
+            while (runs.size() > fanIn) {
+                std::vector<std::string> merged;
+                for (size_t first{ 0 }; first < runs.size(); first += fanIn) {
+                    const auto last = std::min(first + fanIn, runs.size());
+                    std::vector<std::unique_ptr<SokobanStateFileReader>> readers;
+                    for (auto run = first; run < last; ++run) {
+                        readers.push_back(std::make_unique<SokobanStateFileReader>(runs[run], width));
+                    }
+
+                    merged.push_back(directory.file("pass-" + std::to_string(pass) + "-" +
+                        std::to_string(merged.size())));
+                    SokobanStateFileWriter writer{ merged.back(), width };
+                    using Entry = std::pair<const int*, size_t>;
+                    const auto greater = [width](const Entry& first, const Entry& second) {
+                        return isLess(second.first, first.first, width);
+                    };
+                    std::priority_queue<Entry, std::vector<Entry>, decltype(greater)> heap{ greater };
+                    for (size_t i{ 0 }; i < readers.size(); ++i) {
+                        if (readers[i]->next()) {
+                            heap.push({ readers[i]->record(), i });
+                        }
+                    }
+                    while (!heap.empty()) {
+                        const auto [record, i] = heap.top();
+                        heap.pop();
+                        writer.write(record);
+                        ++stats.statesMerged;
+                        if (readers[i]->next()) {
+                            heap.push({ readers[i]->record(), i });
+                        }
+                    }
+                    writer.close();
+                    stats.bytesWritten += writer.bytes();
+                    for (const auto& reader : readers) {
+                        stats.bytesRead += reader->bytes();
+                    }
+                    for (auto run = first; run < last; ++run) {
+                        std::filesystem::remove(runs[run]);
+                    }
+                }
+                runs = std::move(merged);
+                ++pass;
+            }
+
+            // Merge the runs with the visited set: states not seen before form the next layer, and
+            // the visited set grows by them
+            {
+                std::vector<std::unique_ptr<SokobanStateFileReader>> readers;
+                for (const auto& run : runs) {
+                    readers.push_back(std::make_unique<SokobanStateFileReader>(run, width));
+                }
+                SokobanStateFileReader visited{ directory.file("visited-" + std::to_string(layer)),
+                                                width };
+                SokobanStateFileWriter next{ layerFile(layer + 1), width };
+                SokobanStateFileWriter nextVisited{
+                    directory.file("visited-" + std::to_string(layer + 1)), width };
+
+                using Entry = std::pair<const int*, size_t>;
+                const auto greater = [width](const Entry& first, const Entry& second) {
+                    return isLess(second.first, first.first, width);
+                };
+                std::priority_queue<Entry, std::vector<Entry>, decltype(greater)> heap{ greater };
+                for (size_t i{ 0 }; i < readers.size(); ++i) {
+                    if (readers[i]->next()) {
+                        heap.push({ readers[i]->record(), i });
+                    }
+                }
+
+                std::vector<int> previous(width, -1);
+                auto hasVisited = visited.next();
+                while (!heap.empty()) {
+                    const auto [record, i] = heap.top();
+                    heap.pop();
+                    ++stats.statesMerged;
+                    if (!isEqual(record, previous.data(), width)) {
+                        std::copy_n(record, width, previous.begin());
+                        while (hasVisited && isLess(visited.record(), previous.data(), width)) {
+                            nextVisited.write(visited.record());
+                            ++stats.statesMerged;
+                            hasVisited = visited.next();
+                        }
+                        if (!hasVisited || !isEqual(visited.record(), previous.data(), width)) {
+                            next.write(previous.data());
+                            nextVisited.write(previous.data());
+                        }
+                    }
+                    if (readers[i]->next()) {
+                        heap.push({ readers[i]->record(), i });
+                    }
+                }
+                for (; hasVisited; hasVisited = visited.next()) {
+                    nextVisited.write(visited.record());
+                    ++stats.statesMerged;
+                }
+
+                next.close();
+                nextVisited.close();
+                stats.statesWritten += next.records();
+                stats.bytesWritten += next.bytes() + nextVisited.bytes();
+                stats.bytesRead += visited.bytes();
+                for (const auto& reader : readers) {
+                    stats.bytesRead += reader->bytes();
+                }
+                if (next.records() == 0) {
+                    stats.mergeSeconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - mergeStart).count();
+                    break;
+                }
+            }
+            for (const auto& run : runs) {
+                std::filesystem::remove(run);
+            }
+            std::filesystem::remove(directory.file("visited-" + std::to_string(layer)));
+            stats.mergeSeconds += std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - mergeStart).count();
+            ++layer;
+        }
+
+        if (isFound) {
+            // Walk back through the layers, finding in each a position with a push to the current one
+            std::vector<Push> pushes;
+            if (!isSolved(start.boxes)) {
+                pushes.push_back(lastPush);
+                for (auto back = layer - 1; back >= 0; --back) {
+                    SokobanStateFileReader reader{ layerFile(back), width };
+                    auto isLinked = false;
+                    while (!isLinked && reader.next()) {
+                        expandRecord(reader.record(), scratch, [&](const Push& push, const int* child) {
+                            if (!isLinked && isEqual(child, parent.data(), width)) {
+                                pushes.push_back(push);
+                                isLinked = true;
+                            }
+                            });
+                        if (isLinked) {
+                            std::copy_n(reader.record(), width, parent.begin());
+                        }
+                    }
+                    stats.bytesRead += reader.bytes();
+                }
+                std::reverse(pushes.begin(), pushes.end());
+            }
+
+            result.isSolved = true;
+            result.solution = toLurd(start, pushes);
+            result.moves = static_cast<int>(result.solution.size());
+            result.pushes = static_cast<int>(std::count_if(result.solution.begin(),
+                result.solution.end(), [](const char lurd) { return std::isupper(lurd) != 0; }));
+        }
+
+        result.seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - startTime).count();
+        return result;
+    }
+
+}  // namespace SB
@@ -0,0 +1,132 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanStateFile.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace SB {
+
+    SokobanStateFileWriter::SokobanStateFileWriter(const std::string& filename, const int width)
+        : m_file(filename, std::ios::binary | std::ios::trunc), m_width(width), m_previous(width) {
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Can't write state file: " + filename);
+        }
+        m_buffer.reserve(STATE_FILE_BUFFER_BYTES);
+    }
+
+    SokobanStateFileWriter::~SokobanStateFileWriter() {
+        if (m_file.is_open()) {
+            flush();
+        }
+    }
+
+    bool SokobanStateFileWriter::write(const int* record) {
+        int shared{ 0 };
+        if (m_hasPrevious) {
+            while (shared < m_width && record[shared] == m_previous[shared]) {
+                ++shared;
+            }
+            if (shared == m_width) {
+                return false;
+            }
+        }
+
+        putVarint(static_cast<uint32_t>(shared));
+        for (auto i = shared; i < m_width; ++i) {
+            putVarint(static_cast<uint32_t>(record[i]));
+        }
+        std::copy_n(record, m_width, m_previous.begin());
+        m_hasPrevious = true;
+        ++m_records;
+
+        if (m_buffer.size() + 5 * (m_width + 1) > STATE_FILE_BUFFER_BYTES) {
+            flush();
+        }
+        return true;
+    }
+
+    void SokobanStateFileWriter::close() {
+        flush();
+        m_file.close();
+        if (m_file.fail()) {
+            throw std::runtime_error("Can't write state file");
+        }
+    }
+
+    uint64_t SokobanStateFileWriter::records() const { return m_records; }
+
+    uint64_t SokobanStateFileWriter::bytes() const { return m_bytes + m_buffer.size(); }
+
+    void SokobanStateFileWriter::putVarint(uint32_t value) {
+        while (value >= 0x80) {
+            m_buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    void SokobanStateFileWriter::flush() {
+        m_file.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+        m_bytes += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    SokobanStateFileReader::SokobanStateFileReader(const std::string& filename, const int width)
+        : m_file(filename, std::ios::binary), m_width(width), m_record(width),
+          m_buffer(STATE_FILE_BUFFER_BYTES) {
+        if (!m_file.is_open()) {
+            throw std::runtime_error("Can't read state file: " + filename);
+        }
+    }
+
+    bool SokobanStateFileReader::next() {
+        const auto first = getByte();
+        if (first < 0) {
+            return false;
+        }
+
+        const auto shared = static_cast<int>(getVarint(first));
+        if (shared >= m_width) {
+            throw std::runtime_error("Corrupt state file");
+        }
+        for (auto i = shared; i < m_width; ++i) {
+            m_record[i] = static_cast<int>(getVarint(getByte()));
+        }
+        return true;
+    }
+
+    const int* SokobanStateFileReader::record() const { return m_record.data(); }
+
+    uint64_t SokobanStateFileReader::bytes() const { return m_bytes; }
+
+    int SokobanStateFileReader::getByte() {
+        if (m_position == m_size) {
+            m_file.read(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            m_size = static_cast<size_t>(m_file.gcount());
+            m_position = 0;
+            m_bytes += m_size;
+            if (m_size == 0) {
+                return -1;
+            }
+        }
+
+        return static_cast<unsigned char>(m_buffer[m_position++]);
+    }
+
+    uint32_t SokobanStateFileReader::getVarint(int byte) {
+        uint32_t value{ 0 };
+        for (int shift{ 0 }; shift < 35; shift += 7, byte = getByte()) {
+            if (byte < 0) {
+                throw std::runtime_error("Truncated state file");
+            }
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+
+        throw std::runtime_error("Corrupt state file");
+    }
+
+}  // namespace SB
@@ -0,0 +1,134 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSTATEFILE_HPP
+#define SOKOBANSTATEFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    /**
+     * @brief The size of the buffer each state file reader or writer holds.
+     */
+    inline constexpr size_t STATE_FILE_BUFFER_BYTES = size_t{ 64 } << 10;
+
+    /**
+     * @brief Writes a sorted state file. A state is a record of a fixed number of non-negative ints,
+     * e.g. the box cells in ascending order followed by the normalized player cell.
+     *
+     * Records must come in ascending lexicographic order. Each is stored as the number of leading
+     * ints it shares with the previous record followed by the rest as variable-length integers, so
+     * neighboring states, which share most of their boxes, take a few bytes each. A record equal to
+     * the previous one is dropped.
+     */
+    class SokobanStateFileWriter {
+    public:
+        /**
+         * @brief Creates or truncates a state file.
+         * @param filename The file.
+         * @param width The number of ints per record.
+         * @throws std::runtime_error if the file can't be opened.
+         */
+        SokobanStateFileWriter(const std::string& filename, int width);
+
+        SokobanStateFileWriter(const SokobanStateFileWriter&) = delete;
+        SokobanStateFileWriter& operator=(const SokobanStateFileWriter&) = delete;
+
+        /**
+         * @brief Flushes and closes the file.
+         */
+        ~SokobanStateFileWriter();
+
+        /**
+         * @brief Appends a record.
+         * @return False if it equals the previous record and was dropped.
+         */
+        bool write(const int* record);
+
+        /**
+         * @brief Flushes and closes the file. Nothing can be written afterwards.
+         * @throws std::runtime_error if writing failed.
+         */
+        void close();
+
+        /**
+         * @brief Returns the number of records written.
+         */
+        [[nodiscard]] uint64_t records() const;
+
+        /**
+         * @brief Returns the number of bytes written.
+         */
+        [[nodiscard]] uint64_t bytes() const;
+
+    private:
+        void putVarint(uint32_t value);
+
+        void flush();
+
+        std::ofstream m_file;
+        int m_width;
+        std::vector<int> m_previous;
+        bool m_hasPrevious = false;
+        std::vector<char> m_buffer;
+        uint64_t m_records = 0;
+        uint64_t m_bytes = 0;
+    };
+
+    /**
+     * @brief Reads a state file written by `SokobanStateFileWriter`, one record at a time.
+     */
+    class SokobanStateFileReader {
+    public:
+        /**
+         * @brief Opens a state file.
+         * @param filename The file.
+         * @param width The number of ints per record.
+         * @throws std::runtime_error if the file can't be opened.
+         */
+        SokobanStateFileReader(const std::string& filename, int width);
+
+        /**
+         * @brief Reads the next record.
+         * @return False at the end of the file.
+         * @throws std::runtime_error if the file is truncated.
+         */
+        bool next();
+
+        /**
+         * @brief Returns the record last read.
+         */
+        [[nodiscard]] const int* record() const;
+
+        /**
+         * @brief Returns the number of bytes read.
+         */
+        [[nodiscard]] uint64_t bytes() const;
+
+    private:
+        /**
+         * @brief Returns the next byte, or -1 at the end of the file.
+         */
+        int getByte();
+
+        /**
+         * @brief Decodes a variable-length integer that starts with the given byte.
+         */
+        uint32_t getVarint(int byte);
+
+        std::ifstream m_file;
+        int m_width;
+        std::vector<int> m_record;
+        std::vector<char> m_buffer;
+        size_t m_position = 0;
+        size_t m_size = 0;
+        uint64_t m_bytes = 0;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,326 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanStateSet.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief Returns the number of bits needed to write a value.
+         */
+        int bitWidth(uint32_t value) {
+            auto width = 0;
+            for (; value != 0; value >>= 1) {
+                ++width;
+            }
+
+            return width;
+        }
+
+        /**
+         * @brief ORs the low `width` bits of a value into a bit string, least significant bit first.
+         */
+        void putBits(uint8_t* bytes, const size_t position, const uint32_t value, const int width) {
+            for (int bit{ 0 }; bit < width; ++bit) {
+                if ((value >> bit) & 1) {
+                    bytes[(position + bit) >> 3] |= static_cast<uint8_t>(1 << ((position + bit) & 7));
+                }
+            }
+        }
+
+        /**
+         * @brief Reads `width` bits of a bit string, least significant bit first.
+         */
+        uint32_t getBits(const uint8_t* bytes, const size_t position, const int width) {
+            uint32_t value{ 0 };
+            for (int bit{ 0 }; bit < width; ++bit) {
+                value |= static_cast<uint32_t>((bytes[(position + bit) >> 3] >>
+                    ((position + bit) & 7)) & 1) << bit;
+            }
+
+            return value;
+        }
+
+        /**
+         * @brief Returns true if no byte of a record is set, i.e. the slot holding it is empty.
+         */
+        bool isEmpty(const uint8_t* record, const size_t bytes) {
+            return std::all_of(record, record + bytes, [](const uint8_t byte) { return byte == 0; });
+        }
+
+    }  // namespace
+
+    SokobanStateCodec::SokobanStateCodec(const SokobanLevel& level, const SearchState& start,
+        const SokobanLowerBound* lowerBound)
+        : m_boxNumbers(level.size(), -1), m_floorNumbers(level.size(), -1),
+          m_boxCount(static_cast<int>(start.boxes.size())) {
+        // Flood the floor from the player, through boxes
+        std::vector<char> isFloor(level.size(), 0);
+        std::vector<int> queue{ start.player };
+        isFloor[start.player] = 1;
+        for (size_t head{ 0 }; head < queue.size(); ++head) {
+            for (const auto direction : SokobanLevel::DIRECTIONS) {
+                const auto next = queue[head] + level.offset(direction);
+                if (!level.isWall(next) && !isFloor[next]) {
+                    isFloor[next] = 1;
+                    queue.push_back(next);
+                }
+            }
+        }
+
+        std::vector<char> isStart(level.size(), 0);
+        for (const auto box : start.boxes) {
+            isStart[box] = 1;
+        }
+        for (int index{ 0 }; index < level.size(); ++index) {
+            if (isFloor[index]) {
+                m_floorNumbers[index] = static_cast<int>(m_floorCells.size());
+                m_floorCells.push_back(index);
+            }
+            if (isStart[index] ||
+                (isFloor[index] && (lowerBound == nullptr || !lowerBound->isDeadSquare(index)))) {
+                m_boxNumbers[index] = static_cast<int>(m_boxCells.size());
+                m_boxCells.push_back(index);
+            }
+        }
+
+        const auto cellCount = static_cast<int>(m_boxCells.size());
+        if (m_boxCount > 0) {
+            while ((static_cast<int64_t>(m_boxCount) << (m_lowBits + 1)) <= cellCount) {
+                ++m_lowBits;
+            }
+            m_highBits = m_boxCount + ((cellCount - 1) >> m_lowBits);
+        }
+        m_playerBits = bitWidth(static_cast<uint32_t>(m_floorCells.size()));
+        m_bytes = (static_cast<size_t>(m_boxCount) * m_lowBits + m_highBits + m_playerBits + 7) / 8;
+    }
+
+    size_t SokobanStateCodec::bytes() const { return m_bytes; }
+
+    void SokobanStateCodec::encode(const std::vector<int>& boxes, const int player,
+        uint8_t* record) const {
+        std::memset(record, 0, m_bytes);
+
+        const auto highStart = static_cast<size_t>(m_boxCount) * m_lowBits;
+        for (int k{ 0 }; k < m_boxCount; ++k) {
+            const auto number = m_boxNumbers[boxes[k]];
+            if (number < 0) {
+                throw std::invalid_argument("Box outside the floor of the codec");
+            }
+            putBits(record, static_cast<size_t>(k) * m_lowBits,
+                static_cast<uint32_t>(number) & ((1u << m_lowBits) - 1), m_lowBits);
+            const auto high = static_cast<size_t>(number >> m_lowBits) + k;
+            record[(highStart + high) >> 3] |= static_cast<uint8_t>(1 << ((highStart + high) & 7));
+        }
+
+        if (m_floorNumbers[player] < 0) {
+            throw std::invalid_argument("Player outside the floor of the codec");
+        }
+        putBits(record, highStart + m_highBits, static_cast<uint32_t>(m_floorNumbers[player]) + 1,
+            m_playerBits);
+    }
+
+    void SokobanStateCodec::decode(const uint8_t* record, std::vector<int>& boxes, int& player)
+        const {
+        boxes.resize(m_boxCount);
+
+        const auto highStart = static_cast<size_t>(m_boxCount) * m_lowBits;
+        auto k = 0;
+        for (int bit{ 0 }; bit < m_highBits && k < m_boxCount; ++bit) {
+            if (getBits(record, highStart + bit, 1) != 0) {
+                const auto low = getBits(record, static_cast<size_t>(k) * m_lowBits, m_lowBits);
+                boxes[k] = m_boxCells[(static_cast<uint32_t>(bit - k) << m_lowBits) | low];
+                ++k;
+            }
+        }
+
+        player = m_floorCells[getBits(record, highStart + m_highBits, m_playerBits) - 1];
+    }
+
+    uint8_t* SokobanStateSet::Slabs::at(const uint32_t entry) {
+        const auto slab = entry / entriesPerSlab;
+        while (slabs.size() <= slab) {
+            slabs.push_back(std::make_unique<uint8_t[]>(entriesPerSlab * entryBytes));
+        }
+
+        return slabs[slab].get() + (entry % entriesPerSlab) * entryBytes;
+    }
+
+    const uint8_t* SokobanStateSet::Slabs::at(const uint32_t entry) const {
+        return slabs[entry / entriesPerSlab].get() + (entry % entriesPerSlab) * entryBytes;
+    }
+
+    SokobanStateSet::SokobanStateSet(const size_t recordBytes) : m_recordBytes(recordBytes) {
+        if (recordBytes == 0) {
+            throw std::invalid_argument("Records must not be empty");
+        }
+
+        // A bucket is its slots followed by its first overflow entry; an overflow entry is a record
+        // followed by the next entry
+        m_buckets.entryBytes = BUCKET_SLOTS * recordBytes + sizeof(uint32_t);
+        m_buckets.entriesPerSlab = std::max<size_t>(SLAB_BYTES / m_buckets.entryBytes, 1);
+        m_overflows.entryBytes = recordBytes + sizeof(uint32_t);
+        m_overflows.entriesPerSlab = std::max<size_t>(SLAB_BYTES / m_overflows.entryBytes, 1);
+        m_buckets.at(0);
+    }
+
+    bool SokobanStateSet::insert(const uint8_t* record) {
+        if (!place(record)) {
+            return false;
+        }
+
+        ++m_size;
+        const auto bucketCount = (uint64_t{ 1 } << m_round) + m_split;
+        if (static_cast<double>(m_size) >
+            MAX_LOAD * BUCKET_SLOTS * static_cast<double>(bucketCount)) {
+            split();
+        }
+
+        return true;
+    }
+
+    bool SokobanStateSet::contains(const uint8_t* record) const {
+        const auto* const bucket = m_buckets.at(bucketOf(hash(record)));
+        for (int slot{ 0 }; slot < BUCKET_SLOTS; ++slot) {
+            const auto* const stored = bucket + slot * m_recordBytes;
+            if (isEmpty(stored, m_recordBytes)) {
+                return false;
+            }
+            if (std::memcmp(stored, record, m_recordBytes) == 0) {
+                return true;
+            }
+        }
+
+        for (auto entry = overflowHead(bucket); entry != 0;
+            entry = overflowNext(m_overflows.at(entry - 1))) {
+            if (std::memcmp(m_overflows.at(entry - 1), record, m_recordBytes) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    uint64_t SokobanStateSet::size() const { return m_size; }
+
+    size_t SokobanStateSet::bytes() const {
+        return m_buckets.slabs.size() * m_buckets.entriesPerSlab * m_buckets.entryBytes +
+            m_overflows.slabs.size() * m_overflows.entriesPerSlab * m_overflows.entryBytes +
+            (m_buckets.slabs.capacity() + m_overflows.slabs.capacity()) * sizeof(void*) +
+            m_freeOverflows.capacity() * sizeof(uint32_t) + m_moved.capacity();
+    }
+
+    uint64_t SokobanStateSet::hash(const uint8_t* record) const {
+        uint64_t value{ 0x9E3779B97F4A7C15ull };
+        for (size_t offset{ 0 }; offset < m_recordBytes; offset += sizeof(uint64_t)) {
+            uint64_t word{ 0 };
+            std::memcpy(&word, record + offset, std::min(sizeof(word), m_recordBytes - offset));
+            value = (value ^ word) * 0xBF58476D1CE4E5B9ull;
+            value ^= value >> 31;
+        }
+
+        value = (value ^ (value >> 30)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    uint32_t SokobanStateSet::bucketOf(const uint64_t hash) const {
+        const auto bucket = hash & ((uint64_t{ 1 } << m_round) - 1);
+        if (bucket < m_split) {
+            return static_cast<uint32_t>(hash & ((uint64_t{ 2 } << m_round) - 1));
+        }
+
+        return static_cast<uint32_t>(bucket);
+    }
+
+    uint32_t SokobanStateSet::overflowHead(const uint8_t* bucket) const {
+        uint32_t entry{ 0 };
+        std::memcpy(&entry, bucket + BUCKET_SLOTS * m_recordBytes, sizeof(entry));
+        return entry;
+    }
+
+    uint32_t SokobanStateSet::overflowNext(const uint8_t* entry) const {
+        uint32_t next{ 0 };
+        std::memcpy(&next, entry + m_recordBytes, sizeof(next));
+        return next;
+    }
+
+    bool SokobanStateSet::place(const uint8_t* record) {
+        // Slots fill in order and are only emptied by splitting the whole bucket, so the first empty
+        // slot ends the records, and overflow entries exist only once the slots are full
+        auto* const bucket = m_buckets.at(bucketOf(hash(record)));
+        for (int slot{ 0 }; slot < BUCKET_SLOTS; ++slot) {
+            auto* const stored = bucket + slot * m_recordBytes;
+            if (isEmpty(stored, m_recordBytes)) {
+                std::memcpy(stored, record, m_recordBytes);
+                return true;
+            }
+            if (std::memcmp(stored, record, m_recordBytes) == 0) {
+                return false;
+            }
+        }
+
+        auto* link = bucket + BUCKET_SLOTS * m_recordBytes;
+        for (auto entry = overflowHead(bucket); entry != 0;) {
+            auto* const stored = m_overflows.at(entry - 1);
+            if (std::memcmp(stored, record, m_recordBytes) == 0) {
+                return false;
+            }
+            link = stored + m_recordBytes;
+            entry = overflowNext(stored);
+        }
+
+        uint32_t entry{ 0 };
+        if (m_freeOverflows.empty()) {
+            entry = m_overflowCount++;
+        }
+        else {
+            entry = m_freeOverflows.back();
+            m_freeOverflows.pop_back();
+        }
+        auto* const stored = m_overflows.at(entry);
+        std::memcpy(stored, record, m_recordBytes);
+        std::memset(stored + m_recordBytes, 0, sizeof(uint32_t));
+        const auto next = entry + 1;
+        std::memcpy(link, &next, sizeof(next));
+        return true;
+    }
+
+    void SokobanStateSet::split() {
+        // Take the records out of the bucket whose turn it is, then add its image bucket and put
+        // them back, each into one of the two
+        const auto bucketIndex = m_split;
+        auto* const bucket = m_buckets.at(bucketIndex);
+        m_moved.clear();
+        for (int slot{ 0 }; slot < BUCKET_SLOTS; ++slot) {
+            const auto* const stored = bucket + slot * m_recordBytes;
+            if (isEmpty(stored, m_recordBytes)) {
+                break;
+            }
+            m_moved.insert(m_moved.end(), stored, stored + m_recordBytes);
+        }
+        for (auto entry = overflowHead(bucket); entry != 0;) {
+            const auto* const stored = m_overflows.at(entry - 1);
+            m_moved.insert(m_moved.end(), stored, stored + m_recordBytes);
+            m_freeOverflows.push_back(entry - 1);
+            entry = overflowNext(stored);
+        }
+        std::memset(bucket, 0, m_buckets.entryBytes);
+
+        m_buckets.at(static_cast<uint32_t>((uint64_t{ 1 } << m_round) + m_split));
+        if (++m_split == (uint64_t{ 1 } << m_round)) {
+            ++m_round;
+            m_split = 0;
+        }
+
+        for (size_t offset{ 0 }; offset < m_moved.size(); offset += m_recordBytes) {
+            place(m_moved.data() + offset);
+        }
+    }
+
+}  // namespace SB
@@ -0,0 +1,211 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANSTATESET_HPP
+#define SOKOBANSTATESET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "SokobanLevel.hpp"
+#include "SokobanLowerBound.hpp"
+#include "SokobanSearch.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Packs positions into fixed-size records of as few bytes as the level allows.
+     *
+     * Only the floor around the start counts: the cells the player could walk to if boxes were no
+     * obstacle. Boxes are numbered among the floor cells that are not dead squares (plus the cells
+     * they start on), the player among all floor cells. The sorted box numbers are Elias-Fano coded:
+     * the low `L` bits of each are packed side by side, and the gaps between their high parts
+     * follow in unary, where L is the largest width with `boxes << L` within the count of box cells.
+     * That takes about `2 + log2(cells / boxes)` bits per box, e.g. 11 bytes for 20 boxes on 80
+     * cells. The normalized player cell plus one follows at the minimum bit width, so no record is
+     * all zero bytes.
+     */
+    class SokobanStateCodec {
+    public:
+        /**
+         * @brief Lays out records for the positions reachable from a start.
+         * @param level The level.
+         * @param start The first position; boxes may also be on its cells.
+         * @param lowerBound Tells the dead squares, which boxes never reach; nullptr to count them.
+         */
+        SokobanStateCodec(const SokobanLevel& level, const SearchState& start,
+            const SokobanLowerBound* lowerBound = nullptr);
+
+        /**
+         * @brief Returns the size of a record.
+         */
+        [[nodiscard]] size_t bytes() const;
+
+        /**
+         * @brief Encodes a position.
+         * @param boxes The box cells in ascending order.
+         * @param player The normalized player cell.
+         * @param record Receives `bytes()` bytes.
+         * @throws std::invalid_argument if a cell lies outside the floor laid out.
+         */
+        void encode(const std::vector<int>& boxes, int player, uint8_t* record) const;
+
+        /**
+         * @brief Decodes a record written by `encode`.
+         */
+        void decode(const uint8_t* record, std::vector<int>& boxes, int& player) const;
+
+    private:
+        /**
+         * @brief The number of each cell among the box cells or among the floor cells; -1 if none.
+         */
+        std::vector<int> m_boxNumbers;
+        std::vector<int> m_floorNumbers;
+
+        /**
+         * @brief The cell of each box number and of each floor number.
+         */
+        std::vector<int> m_boxCells;
+        std::vector<int> m_floorCells;
+
+        int m_boxCount = 0;
+
+        /**
+         * @brief The bits of the low part of a box number, of the unary high parts and of the player.
+         */
+        int m_lowBits = 0;
+        int m_highBits = 0;
+        int m_playerBits = 0;
+
+        size_t m_bytes = 0;
+    };
+
+    /**
+     * @brief A set of fixed-size records, e.g. from `SokobanStateCodec`, none of which may be all
+     * zero bytes.
+     *
+     * The set is a linear hashing table: buckets of `BUCKET_SLOTS` records live side by side in
+     * large slabs, and each time the load passes `MAX_LOAD` one bucket is split in two, so memory
+     * grows with the records instead of doubling, and no record is ever moved but the few of the
+     * bucket being split. Records that don't fit their bucket go to a chain of overflow entries,
+     * also kept in slabs. Nothing is allocated per record.
+     */
+    class SokobanStateSet {
+    public:
+        /**
+         * @brief The records a bucket holds before it overflows.
+         */
+        static constexpr int BUCKET_SLOTS = 8;
+
+        /**
+         * @brief The records per bucket slot the set holds before it splits a bucket.
+         */
+        static constexpr double MAX_LOAD = 0.9;
+
+        /**
+         * @brief The size of each slab.
+         */
+        static constexpr size_t SLAB_BYTES = size_t{ 64 } << 10;
+
+        /**
+         * @brief Creates an empty set.
+         * @param recordBytes The size of each record.
+         */
+        explicit SokobanStateSet(size_t recordBytes);
+
+        /**
+         * @brief Adds a record.
+         * @return False if it was in the set already.
+         */
+        bool insert(const uint8_t* record);
+
+        /**
+         * @brief Returns true if a record is in the set.
+         */
+        [[nodiscard]] bool contains(const uint8_t* record) const;
+
+        /**
+         * @brief Returns the number of records.
+         */
+        [[nodiscard]] uint64_t size() const;
+
+        /**
+         * @brief Returns the memory the set holds, slabs and bookkeeping together.
+         */
+        [[nodiscard]] size_t bytes() const;
+
+    private:
+        /**
+         * @brief Fixed-size entries in slabs, numbered from 0.
+         */
+        struct Slabs {
+            size_t entryBytes = 0;
+            size_t entriesPerSlab = 0;
+            std::vector<std::unique_ptr<uint8_t[]>> slabs;
+
+            /**
+             * @brief Returns an entry, adding zeroed slabs until it exists.
+             */
+            uint8_t* at(uint32_t entry);
+
+            [[nodiscard]] const uint8_t* at(uint32_t entry) const;
+        };
+
+        /**
+         * @brief Returns the hash of a record.
+         */
+        [[nodiscard]] uint64_t hash(const uint8_t* record) const;
+
+        /**
+         * @brief Returns the bucket of a hash under the current split.
+         */
+        [[nodiscard]] uint32_t bucketOf(uint64_t hash) const;
+
+        /**
+         * @brief Returns the first overflow entry of a bucket plus one, 0 if none.
+         */
+        [[nodiscard]] uint32_t overflowHead(const uint8_t* bucket) const;
+
+        /**
+         * @brief Returns the next overflow entry plus one, 0 if none.
+         */
+        [[nodiscard]] uint32_t overflowNext(const uint8_t* entry) const;
+
+        /**
+         * @brief Puts a record into its bucket unless it is there already.
+         * @return False if it was.
+         */
+        bool place(const uint8_t* record);
+
+        /**
+         * @brief Splits the next bucket in turn.
+         */
+        void split();
+
+        size_t m_recordBytes;
+        Slabs m_buckets;
+        Slabs m_overflows;
+
+        /**
+         * @brief Overflow entries freed by splits, reused before new ones.
+         */
+        std::vector<uint32_t> m_freeOverflows;
+        uint32_t m_overflowCount = 0;
+
+        /**
+         * @brief The buckets in use are `(1 << m_round) + m_split`; the first `m_split` have been
+         * split this round.
+         */
+        int m_round = 0;
+        uint32_t m_split = 0;
+        uint64_t m_size = 0;
+
+        /**
+         * @brief Scratch space for `split`.
+         */
+        std::vector<uint8_t> m_moved;
+    };
+
+}  // namespace SB
+
+#endif
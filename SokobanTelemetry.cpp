@@ -0,0 +1,223 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanTelemetry.hpp"
+#include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The first bytes of every log file.
+         */
+        constexpr char MAGIC[8] = { 'S', 'B', 'T', 'E', 'L', 'E', '0', '1' };
+
+        /**
+         * @brief The most events moved out of the ring for one write.
+         */
+        constexpr size_t BATCH_EVENTS = 1024;
+
+        // The layout of an event on disk
+        static_assert(offsetof(TelemetryEvent, timeMicroseconds) == 0);
+        static_assert(offsetof(TelemetryEvent, elapsedMicroseconds) == 8);
+        static_assert(offsetof(TelemetryEvent, sequence) == 16);
+        static_assert(offsetof(TelemetryEvent, direction) == 20);
+        static_assert(offsetof(TelemetryEvent, type) == 24);
+        static_assert(offsetof(TelemetryEvent, reserved) == 25);
+        static_assert(offsetof(TelemetryEvent, x) == 26);
+        static_assert(offsetof(TelemetryEvent, y) == 28);
+        static_assert(offsetof(TelemetryEvent, score) == 30);
+        static_assert(sizeof(TelemetryEvent) == 32, "telemetry events are 32 bytes on disk");
+
+        /**
+         * @brief The clock events are stamped with. The coarse clock reads the time of the last
+         * timer tick, a few milliseconds at worst, for a fraction of the cost of a precise read.
+         */
+#ifdef CLOCK_REALTIME_COARSE
+        constexpr clockid_t EVENT_CLOCK = CLOCK_REALTIME_COARSE;
+#else
+        constexpr clockid_t EVENT_CLOCK = CLOCK_REALTIME;
+#endif
+
+        /**
+         * @brief Returns the name of the i-th older file of a log; the 0-th is the current one.
+         */
+        std::string rotatedName(const std::string& filename, const int i) {
+            return i == 0 ? filename : filename + "." + std::to_string(i);
+        }
+
+        /**
+         * @brief Throws if a stream doesn't start with the magic bytes.
+         */
+        void checkMagic(std::istream& stream, const std::string& filename) {
+            char magic[sizeof(MAGIC)];
+            if (!stream.read(magic, sizeof(magic)) ||
+                std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("Not a telemetry log: " + filename);
+            }
+        }
+
+    }  // namespace
+
+    const char* telemetryEventName(const TelemetryEventType type) {
+        switch (type) {
+        case TelemetryEventType::Move:
+            return "move";
+        case TelemetryEventType::Push:
+            return "push";
+        case TelemetryEventType::Undo:
+            return "undo";
+        case TelemetryEventType::Jump:
+            return "jump";
+        case TelemetryEventType::Reset:
+            return "reset";
+        case TelemetryEventType::Win:
+            return "win";
+        }
+        return "unknown";
+    }
+
+    SokobanTelemetry::SokobanTelemetry(const std::string& filename, const size_t maxFileBytes,
+        const int fileCount, const size_t capacity)
+        : m_filename(filename), m_maxFileBytes(maxFileBytes), m_fileCount(std::max(fileCount, 1)),
+          m_ring(capacity), m_batch(BATCH_EVENTS) {
+        open();
+        m_worker = std::thread{ &SokobanTelemetry::work, this };
+    }
+
+    SokobanTelemetry::~SokobanTelemetry() {
+        m_isStopping = true;
+        m_worker.join();
+    }
+
+    bool SokobanTelemetry::record(TelemetryEvent event) {
+        const auto sequence = m_recorded.load(std::memory_order_relaxed);
+        event.sequence = static_cast<uint32_t>(sequence);
+        timespec time{};
+        clock_gettime(EVENT_CLOCK, &time);
+        event.timeMicroseconds = static_cast<int64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+        m_recorded.store(sequence + 1, std::memory_order_relaxed);
+
+        if (!m_ring.push(event)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t SokobanTelemetry::recorded() const { return m_recorded; }
+
+    uint64_t SokobanTelemetry::dropped() const { return m_dropped; }
+
+    uint64_t SokobanTelemetry::written() const { return m_written; }
+
+    void SokobanTelemetry::open() {
+        std::error_code error;
+        const auto size = std::filesystem::file_size(m_filename, error);
+        if (!error && size > 0) {
+            std::ifstream existing{ m_filename, std::ios::binary };
+            checkMagic(existing, m_filename);
+        }
+
+        m_file.open(m_filename, std::ios::binary | std::ios::app);
+        if (!m_file) {
+            throw std::runtime_error("Failed to open telemetry log: " + m_filename);
+        }
+        m_fileBytes = error ? 0 : static_cast<size_t>(size);
+        if (m_fileBytes == 0) {
+            m_file.write(MAGIC, sizeof(MAGIC));
+            m_fileBytes = sizeof(MAGIC);
+        }
+    }
+
+    void SokobanTelemetry::rotate() {
+        m_file.close();
+
+        std::error_code error;
+        std::filesystem::remove(rotatedName(m_filename, m_fileCount - 1), error);
+        for (auto i{ m_fileCount - 2 }; i >= 0; --i) {
+            std::filesystem::rename(rotatedName(m_filename, i), rotatedName(m_filename, i + 1),
+                error);
+        }
+
+        // A log that can't be reopened stops taking events rather than ending the game
+        try {
+            open();
+        } catch (const std::runtime_error&) {
+            m_file.setstate(std::ios::failbit);
+        }
+    }
+
+    void SokobanTelemetry::work() {
+        while (!m_isStopping) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{ FLUSH_INTERVAL_MILLISECONDS });
+            drain();
+        }
+        drain();
+    }
+
+    void SokobanTelemetry::drain() {
+        size_t count{ 0 };
+        bool isWritten{ false };
+        while ((count = m_ring.pop(m_batch.data(), m_batch.size())) > 0) {
+            size_t start{ 0 };
+            while (start < count && m_file) {
+                // Every file takes at least one event, however small the limit
+                auto room = m_fileBytes < m_maxFileBytes ?
+                    (m_maxFileBytes - m_fileBytes) / sizeof(TelemetryEvent) : 0;
+                if (room == 0 && m_fileBytes > sizeof(MAGIC)) {
+                    rotate();
+                    continue;
+                }
+                room = std::clamp<size_t>(room, 1, count - start);
+
+                const auto bytes = room * sizeof(TelemetryEvent);
+                m_file.write(reinterpret_cast<const char*>(m_batch.data() + start),
+                    static_cast<std::streamsize>(bytes));
+                m_fileBytes += bytes;
+                m_written.fetch_add(room, std::memory_order_relaxed);
+                start += room;
+                isWritten = true;
+            }
+
+            // Past a failed rotation, the events taken from the ring have nowhere to go
+            m_dropped.fetch_add(count - start, std::memory_order_relaxed);
+        }
+        if (isWritten) {
+            m_file.flush();
+        }
+    }
+
+    SokobanTelemetryReader::SokobanTelemetryReader(const std::string& filename)
+        : m_file(filename, std::ios::binary) {
+        if (!m_file) {
+            throw std::runtime_error("Failed to open telemetry log: " + filename);
+        }
+        checkMagic(m_file, filename);
+    }
+
+    bool SokobanTelemetryReader::next(TelemetryEvent& event) {
+        return static_cast<bool>(m_file.read(reinterpret_cast<char*>(&event), sizeof(event)));
+    }
+
+    std::vector<std::string> telemetryFiles(const std::string& filename) {
+        std::vector<std::string> files;
+        for (int i{ 1 }; std::filesystem::exists(rotatedName(filename, i)); ++i) {
+            files.push_back(rotatedName(filename, i));
+        }
+        std::reverse(files.begin(), files.end());
+        if (std::filesystem::exists(filename)) {
+            files.push_back(filename);
+        }
+        return files;
+    }
+
+}  // namespace SB
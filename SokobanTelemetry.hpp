@@ -0,0 +1,208 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANTELEMETRY_HPP
+#define SOKOBANTELEMETRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "SokobanConstants.hpp"
+#include "SokobanRingBuffer.hpp"
+
+namespace SB {
+
+    /**
+     * @brief What a telemetry event records.
+     */
+    enum class TelemetryEventType : uint8_t { Move, Push, Undo, Jump, Reset, Win };
+
+    /**
+     * @brief Returns the name of an event type, e.g. "push".
+     */
+    [[nodiscard]] const char* telemetryEventName(TelemetryEventType type);
+
+    /**
+     * @brief One gameplay event, as stored in a telemetry log: fixed-size and in the byte order of
+     * the machine.
+     */
+    struct TelemetryEvent {
+        /**
+         * @brief The wall clock time in microseconds since the epoch, as of the last timer tick.
+         */
+        int64_t timeMicroseconds = 0;
+
+        /**
+         * @brief The game's elapsed time in microseconds; see `SokobanElapsedTime`.
+         */
+        int64_t elapsedMicroseconds = 0;
+
+        /**
+         * @brief The number of events the sink was given before this one, dropped ones included,
+         * so gaps show where events were dropped.
+         */
+        uint32_t sequence = 0;
+
+        /**
+         * @brief The direction of a move or push, of the move undone, or the player's orientation.
+         */
+        Direction direction = Direction::Up;
+
+        TelemetryEventType type = TelemetryEventType::Move;
+
+        /**
+         * @brief Always 0. It fills the byte before `x`, so that no byte of a stored event is left
+         * undefined.
+         */
+        uint8_t reserved = 0;
+
+        /**
+         * @brief The player's tile and the score after the event.
+         */
+        int16_t x = 0;
+        int16_t y = 0;
+        int16_t score = 0;
+    };
+
+    /**
+     * @brief A telemetry sink that keeps file writes off the game thread.
+     *
+     * `record` stamps an event and appends it to a single-producer single-consumer ring buffer,
+     * which costs a coarse clock read and a copy; it never blocks, and drops the event if the
+     * buffer is full. A background thread wakes every `FLUSH_INTERVAL_MILLISECONDS`, takes whatever
+     * is buffered and writes it to the log file in one batch. When the file grows past its size
+     * limit it becomes `<filename>.1`, the older files move up one number, and the oldest beyond
+     * the file count is deleted.
+     *
+     * Only one thread may call `record`.
+     */
+    class SokobanTelemetry {
+    public:
+        /**
+         * @brief How often the background thread writes the buffered events.
+         */
+        static constexpr int FLUSH_INTERVAL_MILLISECONDS = 20;
+
+        /**
+         * @brief Opens a log, appending to it if it exists, and starts the background thread.
+         * @param filename The current log file.
+         * @param maxFileBytes The size past which the file is rotated.
+         * @param fileCount The most files kept, the current one included.
+         * @param capacity The most events buffered between flushes.
+         * @throws std::runtime_error if the file can't be opened or isn't a telemetry log.
+         */
+        explicit SokobanTelemetry(const std::string& filename,
+            size_t maxFileBytes = size_t{ 4 } << 20, int fileCount = 4,
+            size_t capacity = size_t{ 1 } << 14);
+
+        SokobanTelemetry(const SokobanTelemetry&) = delete;
+        SokobanTelemetry& operator=(const SokobanTelemetry&) = delete;
+
+        /**
+         * @brief Writes the events still buffered, stops the background thread and closes the file.
+         */
+        ~SokobanTelemetry();
+
+        /**
+         * @brief Stamps an event with the time and a sequence number and buffers it.
+         * @return False if the buffer was full and the event was dropped.
+         */
+        bool record(TelemetryEvent event);
+
+        /**
+         * @brief Returns the number of events given to `record`.
+         */
+        [[nodiscard]] uint64_t recorded() const;
+
+        /**
+         * @brief Returns the number of events dropped because the buffer was full, or because the
+         * log could not be reopened after a rotation.
+         */
+        [[nodiscard]] uint64_t dropped() const;
+
+        /**
+         * @brief Returns the number of events written to files so far.
+         */
+        [[nodiscard]] uint64_t written() const;
+
+    private:
+        /**
+         * @brief Opens the current file, writing the header if it is new.
+         */
+        void open();
+
+        /**
+         * @brief Moves every file one number up and opens a new current file.
+         */
+        void rotate();
+
+        /**
+         * @brief Writes the buffered events until the sink is destroyed.
+         */
+        void work();
+
+        /**
+         * @brief Writes the events buffered now.
+         */
+        void drain();
+
+        std::string m_filename;
+        size_t m_maxFileBytes;
+        int m_fileCount;
+        std::ofstream m_file;
+        size_t m_fileBytes = 0;
+        SokobanRingBuffer<TelemetryEvent> m_ring;
+
+        /**
+         * @brief Events moved out of the ring for one write.
+         */
+        std::vector<TelemetryEvent> m_batch;
+
+        /**
+         * @brief A counter only the recording thread writes.
+         */
+        std::atomic<uint64_t> m_recorded{ 0 };
+
+        /**
+         * @brief Added to by the recording thread when the buffer is full, and by the background
+         * thread when the log can't be reopened.
+         */
+        std::atomic<uint64_t> m_dropped{ 0 };
+
+        std::atomic<uint64_t> m_written{ 0 };
+        std::atomic<bool> m_isStopping{ false };
+        std::thread m_worker;
+    };
+
+    /**
+     * @brief Reads the events of one telemetry log file in order.
+     */
+    class SokobanTelemetryReader {
+    public:
+        /**
+         * @brief Opens a log file.
+         * @throws std::runtime_error if the file can't be opened or isn't a telemetry log.
+         */
+        explicit SokobanTelemetryReader(const std::string& filename);
+
+        /**
+         * @brief Reads the next event.
+         * @return False at the end of the file, or at an event cut short by a crash.
+         */
+        bool next(TelemetryEvent& event);
+
+    private:
+        std::ifstream m_file;
+    };
+
+    /**
+     * @brief Returns the files of a rotated log that exist, oldest first.
+     */
+    [[nodiscard]] std::vector<std::string> telemetryFiles(const std::string& filename);
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,125 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanTerminal.hpp"
+#include <algorithm>
+#include <string>
+
+namespace SB {
+
+    namespace {
+
+        /**
+         * @brief The number of cells kept between the player and the edge of the screen.
+         */
+        constexpr int MARGIN = 3;
+
+        /**
+         * @brief Returns the character a tile is shown with.
+         */
+        char toScreenChar(const TileChar tileChar) {
+            return tileChar == TileChar::Empty ? ' ' : static_cast<char>(tileChar);
+        }
+
+        /**
+         * @brief Moves the start of a window of `size` cells over `length` cells so that `position`
+         * stays `margin` cells inside it, centering it when the position leaves that band.
+         */
+        int scroll(const int start, const int position, const int size, const int length) {
+            const auto margin = std::min(MARGIN, (size - 1) / 2);
+            if (position >= start + margin && position < start + size - margin) {
+                return start;
+            }
+
+            return std::clamp(position - size / 2, 0, std::max(length - size, 0));
+        }
+
+    }  // namespace
+
+    SokobanTerminal::SokobanTerminal(std::ostream& output, const int columns, const int rows)
+        : m_output(output), m_columns(std::max(columns, 1)), m_rows(std::max(rows, 2)) {}
+
+    size_t SokobanTerminal::render(const Sokoban& sokoban) {
+        m_frame.clear();
+        const auto mapRows = m_rows - 1;
+        if (m_screen.empty()) {
+            // Clear the screen and hide the cursor; blank cells then need no update
+            m_frame += "\x1b[?25l\x1b[2J";
+            m_screen.assign(static_cast<size_t>(m_columns) * mapRows, ' ');
+            m_status.clear();
+            m_cursorRow = -1;
+        }
+
+        const auto view = sokoban.tileCharView();
+        const sf::Vector2i player{ static_cast<int>(sokoban.playerLoc().x),
+                                   static_cast<int>(sokoban.playerLoc().y) };
+        follow(player, view.width(), view.height());
+
+        // Compare only the visible part of the board, so the cost doesn't grow with the board
+        const auto visibleColumns = std::clamp(view.width() - m_origin.x, 0, m_columns);
+        for (int row{ 0 }; row < mapRows; ++row) {
+            auto* const screenRow = m_screen.data() + static_cast<size_t>(row) * m_columns;
+            const auto y = m_origin.y + row;
+            const auto isInside = y < view.height();
+            for (int column{ 0 }; column < m_columns; ++column) {
+                auto cell = ' ';
+                if (isInside && column < visibleColumns) {
+                    cell = toScreenChar(view.row(y)[m_origin.x + column]);
+                    if (y == player.y && m_origin.x + column == player.x) {
+                        cell = static_cast<char>(TileChar::Player);
+                    }
+                }
+
+                if (screenRow[column] != cell) {
+                    moveCursor(row, column);
+                    m_frame.push_back(cell);
+                    ++m_cursorColumn;
+                    screenRow[column] = cell;
+                }
+            }
+        }
+
+        std::string status = "Moves: " +
+            std::to_string(sokoban.undoTree().node(sokoban.undoTree().current()).depth);
+        if (sokoban.isWon()) {
+            status += "  Solved!";
+        }
+        else if (sokoban.isDeadlocked()) {
+            status += "  Deadlocked";
+        }
+        status.resize(std::min(status.size(), static_cast<size_t>(m_columns)));
+        if (status != m_status) {
+            moveCursor(mapRows, 0);
+            m_frame += status;
+            m_frame += "\x1b[K";
+            m_cursorColumn += static_cast<int>(status.size());
+            m_status = status;
+        }
+
+        m_output << m_frame << std::flush;
+        return m_frame.size();
+    }
+
+    void SokobanTerminal::invalidate(const int columns, const int rows) {
+        m_columns = std::max(columns, 1);
+        m_rows = std::max(rows, 2);
+        m_screen.clear();
+    }
+
+    sf::Vector2i SokobanTerminal::origin() const { return m_origin; }
+
+    void SokobanTerminal::follow(const sf::Vector2i& player, const int width, const int height) {
+        m_origin.x = scroll(m_origin.x, player.x, m_columns, width);
+        m_origin.y = scroll(m_origin.y, player.y, m_rows - 1, height);
+    }
+
+    void SokobanTerminal::moveCursor(const int row, const int column) {
+        if (row == m_cursorRow && column == m_cursorColumn) {
+            return;
+        }
+
+        m_frame += "\x1b[" + std::to_string(row + 1) + ";" + std::to_string(column + 1) + "H";
+        m_cursorRow = row;
+        m_cursorColumn = column;
+    }
+
+}  // namespace SB
@@ -0,0 +1,98 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANTERMINAL_HPP
+#define SOKOBANTERMINAL_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <SFML/System.hpp>
+#include "Sokoban.hpp"
+
+namespace SB {
+
+    /**
+     * @brief Draws a game on an ANSI terminal, sending only what changed since the last frame.
+     *
+     * The screen shows a window of the board that follows the player, with a status line below it.
+     * The renderer remembers what is on the screen; a frame compares the visible tiles against it
+     * and sends one cursor move per run of changed cells, so after a move only the two or three
+     * tiles it touched go over the wire, however large the board is. Tiles are shown with the level
+     * file characters, except that floor is blank.
+     */
+    class SokobanTerminal {
+    public:
+        /**
+         * @brief Creates a renderer for a terminal of the given size.
+         * @param output Where the escape sequences go.
+         * @param columns The terminal width in characters.
+         * @param rows The terminal height in lines, the status line included.
+         */
+        explicit SokobanTerminal(std::ostream& output, int columns = 80, int rows = 24);
+
+        /**
+         * @brief Draws a frame: the whole screen the first time and after `invalidate()`, the changes
+         * otherwise.
+         * @return The number of bytes sent.
+         */
+        size_t render(const Sokoban& sokoban);
+
+        /**
+         * @brief Forgets what is on the screen, so that the next frame clears it and draws everything,
+         * e.g. after a resize or when another program wrote to the terminal.
+         * @param columns The new terminal width in characters.
+         * @param rows The new terminal height in lines.
+         */
+        void invalidate(int columns, int rows);
+
+        /**
+         * @brief Returns the board coordinate shown in the top-left corner of the screen.
+         */
+        [[nodiscard]] sf::Vector2i origin() const;
+
+    private:
+        /**
+         * @brief Moves the window of the board so that the player is not near its edge.
+         */
+        void follow(const sf::Vector2i& player, int width, int height);
+
+        /**
+         * @brief Appends the escape sequence that moves the cursor, unless it is there already.
+         */
+        void moveCursor(int row, int column);
+
+        std::ostream& m_output;
+        int m_columns;
+        int m_rows;
+
+        /**
+         * @brief The board coordinate of the top-left cell of the screen.
+         */
+        sf::Vector2i m_origin{ 0, 0 };
+
+        /**
+         * @brief What is on the screen above the status line, row by row; empty until the first frame.
+         */
+        std::vector<char> m_screen;
+
+        /**
+         * @brief The status line on the screen.
+         */
+        std::string m_status;
+
+        /**
+         * @brief The frame being assembled, sent in one write.
+         */
+        std::string m_frame;
+
+        /**
+         * @brief The cursor position, or -1 if unknown.
+         */
+        int m_cursorRow = -1;
+        int m_cursorColumn = -1;
+    };
+
+}  // namespace SB
+
+#endif
@@ -1,21 +1,23 @@
 // Copyright 2024 Jason Ossai
 
 #include "SokobanTileGrid.hpp"
+#include <algorithm>
 #include <memory>
+#include <memory_resource>
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include "InvalidCoordinateException.hpp"
+#include "SokobanAssets.hpp"
 
 namespace SB {
 
     SokobanTileGrid::SokobanTileGrid() {
-        const auto groundTexture{ std::make_shared<sf::Texture>() };
-        const auto groundStorageTexture{ std::make_shared<sf::Texture>() };
-        const auto boxTexture{ std::make_shared<sf::Texture>() };
-        const auto wallTexture{ std::make_shared<sf::Texture>() };
-        groundTexture->loadFromFile(TILE_GROUND_01_FILENAME);
-        groundStorageTexture->loadFromFile(TILE_GROUND_04_FILENAME);
-        boxTexture->loadFromFile(TILE_CRATE_03_FILENAME);
-        wallTexture->loadFromFile(TILE_BLOCK_06_FILENAME);
+        // The textures load in the background; until then each kind of tile is a flat color
+        auto& assets = SokobanAssets::instance();
+        const auto groundTexture = assets.texture(TILE_GROUND_01_FILENAME, { 214, 194, 160 });
+        const auto groundStorageTexture = assets.texture(TILE_GROUND_04_FILENAME, { 120, 170, 90 });
+        const auto boxTexture = assets.texture(TILE_CRATE_03_FILENAME, { 160, 100, 50 });
+        const auto wallTexture = assets.texture(TILE_BLOCK_06_FILENAME, { 90, 90, 90 });
 
         m_tileTextureMap[TileChar::Player] = { groundTexture };
         m_tileTextureMap[TileChar::Empty] = { groundTexture };
@@ -26,19 +28,56 @@ namespace SB {
     }
 
     void SokobanTileGrid::draw(sf::RenderTarget& target, sf::RenderStates states) const {
-        traverseTileCharGrid([&](auto coordinate, auto tileChar) {
-            const sf::Vector2f position({ static_cast<float>(coordinate.x * TILE_WIDTH),
-                                          static_cast<float>(coordinate.y * TILE_HEIGHT) });
-            const auto tile = getTile(tileChar);
-            tile->setPosition(position);
-            target.draw(*tile);
-
-            return false;
+        const SokobanGridView<const sf::Sprite> tiles{ m_tileGrid.data() + m_stride + 1, m_width,
+                                                       m_height, m_stride };
+        for (int row{ 0 }; row < m_height; ++row) {
+            for (const auto& tile : tiles.row(row)) {
+                target.draw(tile, states);
+            }
+        }
+    }
+
+    void SokobanTileGrid::loadTileCharGrid(const int width, const int height,
+        const std::vector<TileChar>& tileCharGrid) {
+        // Empty the grids so that nothing points into the arena, then free it in one step
+        m_initialTileCharGrid = std::pmr::vector<TileChar>{ m_arena.resource() };
+        m_tileCharGrid = std::pmr::vector<TileChar>{ m_arena.resource() };
+        m_tileGrid = std::pmr::vector<sf::Sprite>{ m_arena.resource() };
+        m_arena.release();
+
+        m_width = width;
+        m_height = height;
+        m_stride = width + 2;
+        m_offsets = { -m_stride, m_stride, -1, 1 };
+
+        // Surround the level with walls
+        const auto size = static_cast<size_t>(m_stride) * (height + 2);
+        m_initialTileCharGrid.assign(size, TileChar::Wall);
+        for (int row{ 0 }; row < height; ++row) {
+            std::copy_n(tileCharGrid.begin() + row * width, width,
+                m_initialTileCharGrid.begin() + getIndex({ 0, row }));
+        }
+        m_tileCharGrid.reserve(size);
+        m_tileGrid.resize(size);
+        const SokobanGridView<sf::Sprite> tiles{ m_tileGrid.data() + m_stride + 1, width, height,
+                                                 m_stride };
+        tiles.forEachCell([](const sf::Vector2i coordinate, sf::Sprite& tile) {
+            tile.setPosition({ static_cast<float>(coordinate.x * TILE_WIDTH),
+                               static_cast<float>(coordinate.y * TILE_HEIGHT) });
             });
     }
 
+    void SokobanTileGrid::resetTileCharGrid() {
+        m_tileCharGrid.assign(m_initialTileCharGrid.begin(), m_initialTileCharGrid.end());
+        for (size_t index{ 0 }; index < m_tileCharGrid.size(); ++index) {
+            if (const auto texture = getTexture(m_tileCharGrid[index])) {
+                m_tileGrid[index].setTexture(*texture);
+            }
+        }
+    }
+
     int SokobanTileGrid::getIndex(const sf::Vector2i& coordinate) const {
-        return coordinate.x + coordinate.y * m_width;
+        return (coordinate.y + 1) * m_stride + coordinate.x + 1;
     }
 
     int SokobanTileGrid::height() const { return m_height; }
@@ -46,51 +85,40 @@ namespace SB {
     int SokobanTileGrid::width() const { return m_width; }
 
     TileChar SokobanTileGrid::getTileChar(const sf::Vector2i& coordinate) const {
-        return m_tileCharGrid.at(checkCoordinate(coordinate));
+        return m_tileCharGrid[checkCoordinate(coordinate)];
     }
 
     void SokobanTileGrid::setTileChar(const sf::Vector2i& coordinate, const TileChar tileChar) {
-        const auto index = checkCoordinate(coordinate);
-        const auto originalTileChar = m_tileCharGrid[index];
+        setTileCharAt(checkCoordinate(coordinate), tileChar);
+    }
 
-        if (originalTileChar != tileChar) {
+    void SokobanTileGrid::setTileCharAt(const int index, const TileChar tileChar) {
+        if (m_tileCharGrid[index] != tileChar) {
             m_tileCharGrid[index] = tileChar;
-            const auto newTile{ std::make_shared<sf::Sprite>() };
-            newTile->setTexture(*m_tileTextureMap.at(tileChar));
+            m_tileGrid[index].setTexture(*m_tileTextureMap.at(tileChar));
         }
     }
 
-    void SokobanTileGrid::traverseTileCharGrid(
-        const std::function<bool(sf::Vector2i, TileChar)>& callback) const {
-        auto stopIteration = false;
-        for (int row = 0; !stopIteration && row < m_height; ++row) {
-            for (int col = 0; !stopIteration && col < m_width; ++col) {
-                const auto tileChar = getTileChar({ col, row });
-                stopIteration = callback({ col, row }, tileChar);
-            }
-        }
+    SokobanGridView<const TileChar> SokobanTileGrid::tileCharView() const {
+        return { m_tileCharGrid.data() + m_stride + 1, m_width, m_height, m_stride };
     }
 
-    std::shared_ptr<sf::Sprite> SokobanTileGrid::getTile(const TileChar& tileChar) const {
+    const sf::Texture* SokobanTileGrid::getTexture(const TileChar& tileChar) const {
         const auto it = m_tileTextureMap.find(tileChar);
         if (it == m_tileTextureMap.end()) {
             return nullptr;
         }
 
-        const auto sprite{ std::make_shared<sf::Sprite>() };
-        sprite->setTexture(*it->second);
-
-        return sprite;
+        return it->second.get();
     }
 
     int SokobanTileGrid::checkCoordinate(const sf::Vector2i& coordinate) const {
-        const auto index = getIndex(coordinate);
-        const auto gridSize = static_cast<int>(m_initialTileCharGrid.size());
-        if (index < 0 || index >= gridSize) {
+        if (coordinate.x < 0 || coordinate.x >= m_width || coordinate.y < 0 ||
+            coordinate.y >= m_height) {
             throw InvalidCoordinateException(coordinate);
         }
 
-        return index;
+        return getIndex(coordinate);
     }
 
 }  // namespace SB
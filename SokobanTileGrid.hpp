@@ -3,11 +3,15 @@
 #ifndef SOKOBANTILEGRID_HPP
 #define SOKOBANTILEGRID_HPP
 
+#include <array>
 #include <memory>
+#include <memory_resource>
 #include <unordered_map>
 #include <vector>
 #include <SFML/Graphics.hpp>
+#include "SokobanArena.hpp"
 #include "SokobanConstants.hpp"
+#include "SokobanGridView.hpp"
 
 namespace SB {
 
@@ -15,6 +19,10 @@ namespace SB {
      * @brief This class manages the tile grid system in Sokoban. Tiles include the unmovable things in
      * the game, including wall blocks, ground blocks, box blocks, and so on. Note that the player is not
      * included in tiles.
+     *
+     * Internally the grids have a border of walls one tile wide, laid out like `SokobanLevel` cells:
+     * the tile at (x, y) has index `(y + 1) * stride + x + 1` with `stride = width + 2`. A step from any
+     * tile inside the board therefore lands on a valid index, so moves need no bounds checks.
      */
     class SokobanTileGrid : public virtual sf::Drawable {
     public:
@@ -34,9 +42,16 @@ namespace SB {
          */
         [[nodiscard]] TileChar getTileChar(const sf::Vector2i& coordinate) const;
 
+        /**
+         * @brief Returns a read-only view of the tile char grid, for traversals that visit many tiles.
+         * Unlike `getTileChar`, the view checks no coordinate.
+         */
+        [[nodiscard]] SokobanGridView<const TileChar> tileCharView() const;
+
     protected:
         /**
-         * @brief Creates a SokobanTileGrid instance; initializes the tile texture map.
+         * @brief Creates a SokobanTileGrid instance; initializes the tile texture map with the shared
+         * textures, which may still be placeholders.
          */
         SokobanTileGrid();
 
@@ -46,11 +61,38 @@ namespace SB {
         void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
         /**
-         * @brief Returns the corresponding index of a specified coordinate.
+         * @brief Returns the corresponding index of a specified coordinate in the padded grids. It is
+         * the same index `SokobanLevel` uses.
          * @param coordinate Coordinate to analyze.
          */
         [[nodiscard]] int getIndex(const sf::Vector2i& coordinate) const;
 
+        /**
+         * @brief Returns the tile character at an index of the padded grid, unchecked.
+         */
+        [[nodiscard]] TileChar tileCharAt(int index) const { return m_tileCharGrid[index]; }
+
+        /**
+         * @brief Sets the tile character at an index of the padded grid, unchecked, and retextures
+         * the tile if it changes.
+         */
+        void setTileCharAt(int index, TileChar tileChar);
+
+        /**
+         * @brief Returns the memory of the previous level to the heap and lays out the grids of a new
+         * level in the arena. Containers outside this class that use the arena must be emptied first.
+         * @param width The number of tile columns.
+         * @param height The number of tile rows.
+         * @param tileCharGrid The initial tile char grid in row-major order.
+         */
+        void loadTileCharGrid(int width, int height, const std::vector<TileChar>& tileCharGrid);
+
+        /**
+         * @brief Copies the initial tile char grid into the current one and updates every tile. The
+         * grids keep their memory.
+         */
+        void resetTileCharGrid();
+
         /**
          * @brief Sets the tile character for a specified coordinate. If the tile character changes, the
          * corresponding tile in the tile grid changes synchronously.
@@ -60,18 +102,10 @@ namespace SB {
         void setTileChar(const sf::Vector2i& coordinate, TileChar tileChar);
 
         /**
-         * @brief Iterates over each tile character in the grid and invokes the specified callback
-         * function for each tile, providing the tile's coordinate and its associated tile character.
-         * The callback function should return true to continue the traversal or false to stop it.
-         * @param callback The callback function to be invoked for each tile.
-         */
-        void traverseTileCharGrid(const std::function<bool(sf::Vector2i, TileChar)>& callback) const;
-
-        /**
-         * @brief Converts a character into the corresponding tile sprite.
-         * @return The corresponding tile sprite; nullptr if the tile char is not supported.
+         * @brief Converts a character into the corresponding tile texture.
+         * @return The corresponding tile texture; nullptr if the tile char is not supported.
          */
-        [[nodiscard]] std::shared_ptr<sf::Sprite> getTile(const TileChar& tileChar) const;
+        [[nodiscard]] const sf::Texture* getTexture(const TileChar& tileChar) const;
 
         /**
          * @brief The number of tile columns.
@@ -83,6 +117,16 @@ namespace SB {
          */
         int m_height = 0;
 
+        /**
+         * @brief The distance between rows of the padded grids: the width plus the two border tiles.
+         */
+        int m_stride = 2;
+
+        /**
+         * @brief What to add to an index to step one tile, in `Direction` order.
+         */
+        std::array<int, 4> m_offsets{};
+
         /**
          * @brief Associates characters with their respective tile textures. Refer to
          * `SokobanConstants.h` for additional details. This mapping is crucial for constructing the
@@ -90,27 +134,33 @@ namespace SB {
          */
         std::unordered_map<TileChar, std::shared_ptr<sf::Texture>> m_tileTextureMap;
 
+        /**
+         * @brief The memory of the current level. Declared before the containers that use it.
+         */
+        SokobanArena m_arena;
+
         /**
          * @brief The initial tile char grid. It remains unchanged until the level changes.
          */
-        std::vector<TileChar> m_initialTileCharGrid;
+        std::pmr::vector<TileChar> m_initialTileCharGrid{ m_arena.resource() };
 
         /**
          * @brief Represents the tile character grid, which is mapped into a one-dimensional array in
-         * row-major order.
+         * row-major order with the wall border.
          */
-        std::vector<TileChar> m_tileCharGrid;
+        std::pmr::vector<TileChar> m_tileCharGrid{ m_arena.resource() };
 
         /**
          * @brief Represents the tile grid, which is mapped into a one-dimensional array in row-major
-         * order.
+         * order with the border; border sprites are never drawn. Each sprite is positioned once per
+         * level; only its texture changes while playing.
          */
-        std::vector<std::shared_ptr<sf::Sprite>> m_tileGrid;
+        std::pmr::vector<sf::Sprite> m_tileGrid{ m_arena.resource() };
 
     private:
         /**
          * @brief Checks if a specified coordinate is valid. A valid coordinate should be able to be
-         * located in the tile char grid.
+         * located inside the border of the tile char grid.
          * @param coordinate The coordinate to check.
          * @return An index corresponding to the coordinate.
          * @throws InvalidCoordinateException if the coordinate is invalid.
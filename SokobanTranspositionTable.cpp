@@ -0,0 +1,149 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanTranspositionTable.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace SB {
+
+    namespace {
+
+        constexpr int DEPTH_SHIFT = 0;
+        constexpr int MOVE_CELL_SHIFT = 16;
+        constexpr int MOVE_DIRECTION_SHIFT = 40;
+        constexpr int FLAGS_SHIFT = 48;
+        constexpr int AGE_SHIFT = 56;
+        constexpr uint64_t MOVE_CELL_MASK = (1ull << 24) - 1;
+
+    }  // namespace
+
+    SokobanTranspositionTable::SokobanTranspositionTable(const size_t budget) {
+        uint64_t bucketCount{ 1 };
+        while (bucketCount * 2 * sizeof(Bucket) <= budget) {
+            bucketCount *= 2;
+        }
+
+        m_buckets = std::make_unique<Bucket[]>(bucketCount);
+        m_mask = bucketCount - 1;
+        clear();
+    }
+
+    void SokobanTranspositionTable::clear() {
+        for (uint64_t bucket{ 0 }; bucket <= m_mask; ++bucket) {
+            for (auto& slot : m_buckets[bucket].slots) {
+                slot.check.store(0, std::memory_order_relaxed);
+                slot.data.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        m_age.store(1, std::memory_order_relaxed);
+        m_hits.value.store(0, std::memory_order_relaxed);
+        m_misses.value.store(0, std::memory_order_relaxed);
+        m_collisions.value.store(0, std::memory_order_relaxed);
+    }
+
+    void SokobanTranspositionTable::newSearch() {
+        // Ages run from 1 to 255 so that a live payload is never zero
+        const auto age = m_age.load(std::memory_order_relaxed);
+        m_age.store(age == 255 ? 1 : age + 1, std::memory_order_relaxed);
+    }
+
+    bool SokobanTranspositionTable::probe(const uint64_t key, const TranspositionEntry& entry) {
+        auto& bucket = bucketOf(key);
+        const auto data = pack(entry);
+        const auto age = m_age.load(std::memory_order_relaxed);
+
+        Slot* victim = nullptr;
+        auto victimScore = INT_MAX;
+        for (auto& slot : bucket.slots) {
+            const auto slotData = slot.data.load(std::memory_order_relaxed);
+            const auto slotCheck = slot.check.load(std::memory_order_relaxed);
+            if (slotData == 0) {
+                if (victimScore != INT_MIN) {
+                    victim = &slot;
+                    victimScore = INT_MIN;
+                }
+                continue;
+            }
+
+            if ((slotCheck ^ slotData) == key) {
+                if (unpack(slotData).depth <= std::min(entry.depth, MAX_DEPTH)) {
+                    m_hits.value.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+
+                victim = &slot;
+                victimScore = INT_MIN;
+                break;
+            }
+
+            // Older searches go first, then shallower entries
+            const auto staleness = (age - ageOf(slotData) + 255) % 255;
+            const auto score = unpack(slotData).depth - staleness * (MAX_DEPTH + 1);
+            if (score < victimScore) {
+                victim = &slot;
+                victimScore = score;
+            }
+        }
+
+        if (victimScore != INT_MIN) {
+            m_collisions.value.fetch_add(1, std::memory_order_relaxed);
+        }
+        m_misses.value.fetch_add(1, std::memory_order_relaxed);
+        victim->data.store(data, std::memory_order_relaxed);
+        victim->check.store(key ^ data, std::memory_order_relaxed);
+
+        return false;
+    }
+
+    bool SokobanTranspositionTable::find(const uint64_t key, TranspositionEntry& entry) const {
+        for (const auto& slot : bucketOf(key).slots) {
+            const auto slotData = slot.data.load(std::memory_order_relaxed);
+            const auto slotCheck = slot.check.load(std::memory_order_relaxed);
+            if (slotData != 0 && (slotCheck ^ slotData) == key) {
+                entry = unpack(slotData);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    size_t SokobanTranspositionTable::capacity() const {
+        return static_cast<size_t>(m_mask + 1) * BUCKET_SIZE;
+    }
+
+    TranspositionStats SokobanTranspositionTable::stats() const {
+        return { m_hits.value.load(std::memory_order_relaxed),
+                 m_misses.value.load(std::memory_order_relaxed),
+                 m_collisions.value.load(std::memory_order_relaxed) };
+    }
+
+    uint64_t SokobanTranspositionTable::pack(const TranspositionEntry& entry) const {
+        const auto depth = static_cast<uint64_t>(std::clamp(entry.depth, 0, MAX_DEPTH));
+        const auto moveCell = static_cast<uint64_t>(entry.moveCell + 1) & MOVE_CELL_MASK;
+        const auto age = static_cast<uint64_t>(m_age.load(std::memory_order_relaxed));
+        return depth << DEPTH_SHIFT | moveCell << MOVE_CELL_SHIFT |
+            static_cast<uint64_t>(entry.moveDirection) << MOVE_DIRECTION_SHIFT |
+            static_cast<uint64_t>(entry.flags) << FLAGS_SHIFT | age << AGE_SHIFT;
+    }
+
+    TranspositionEntry SokobanTranspositionTable::unpack(const uint64_t data) {
+        TranspositionEntry entry;
+        entry.depth = static_cast<int>(data >> DEPTH_SHIFT & MAX_DEPTH);
+        entry.moveCell = static_cast<int>(data >> MOVE_CELL_SHIFT & MOVE_CELL_MASK) - 1;
+        entry.moveDirection = static_cast<Direction>(data >> MOVE_DIRECTION_SHIFT & 3);
+        entry.flags = static_cast<uint8_t>(data >> FLAGS_SHIFT);
+        return entry;
+    }
+
+    int SokobanTranspositionTable::ageOf(const uint64_t data) {
+        return static_cast<int>(data >> AGE_SHIFT);
+    }
+
+    SokobanTranspositionTable::Bucket& SokobanTranspositionTable::bucketOf(const uint64_t key) const {
+        // The low bits pick the bucket; the full key is checked inside it
+        return m_buckets[key & m_mask];
+    }
+
+}  // namespace SB
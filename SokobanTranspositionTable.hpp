@@ -0,0 +1,190 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANTRANSPOSITIONTABLE_HPP
+#define SOKOBANTRANSPOSITIONTABLE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief What the transposition table keeps about a state.
+     */
+    struct TranspositionEntry {
+        /**
+         * @brief The number of pushes the state was reached with (saturates at `MAX_DEPTH`).
+         */
+        int depth = 0;
+
+        /**
+         * @brief The cell of the box moved by the push that led to the state, or -1.
+         */
+        int moveCell = -1;
+
+        /**
+         * @brief The direction of that push.
+         */
+        Direction moveDirection = Direction::Up;
+
+        /**
+         * @brief Free for the search to use, e.g. to tell which search reached the state.
+         */
+        uint8_t flags = 0;
+    };
+
+    /**
+     * @brief Counters of table accesses, summed over all threads.
+     */
+    struct TranspositionStats {
+        /**
+         * @brief Probes that found the state at no greater depth.
+         */
+        uint64_t hits = 0;
+
+        /**
+         * @brief Probes that stored the state because it was absent or found deeper.
+         */
+        uint64_t misses = 0;
+
+        /**
+         * @brief Stores that evicted a live entry of another state from a full bucket.
+         */
+        uint64_t collisions = 0;
+    };
+
+    /**
+     * @brief A lock-free set of visited states shared by search threads, keyed by the 64-bit state
+     * hash of `SokobanSearch.hpp`.
+     *
+     * The table takes a fixed memory budget and never grows. Entries sit in buckets of four that fill
+     * one cache line. Each entry is two 64-bit words, the packed payload and the key XOR the payload,
+     * written with relaxed atomics: a reader that sees halves of two different writes gets a key that
+     * doesn't match and treats the entry as absent, so no lock is needed. When a bucket is full, the
+     * entry to replace is the one from the oldest search, then the shallowest one.
+     */
+    class SokobanTranspositionTable {
+    public:
+        /**
+         * @brief The largest depth an entry can hold.
+         */
+        static constexpr int MAX_DEPTH = 0xFFFF;
+
+        /**
+         * @brief The number of entries per bucket.
+         */
+        static constexpr int BUCKET_SIZE = 4;
+
+        /**
+         * @brief Creates a table that uses at most the given number of bytes.
+         * @param budget The memory budget in bytes; at least one bucket is allocated.
+         */
+        explicit SokobanTranspositionTable(size_t budget);
+
+        SokobanTranspositionTable(const SokobanTranspositionTable&) = delete;
+        SokobanTranspositionTable& operator=(const SokobanTranspositionTable&) = delete;
+
+        /**
+         * @brief Empties the table and resets its counters. Not safe while other threads use it.
+         */
+        void clear();
+
+        /**
+         * @brief Starts a new search. Entries of earlier searches stay, but are replaced first.
+         */
+        void newSearch();
+
+        /**
+         * @brief Marks a state as visited. This is the closed set check of a search.
+         * @param key The state hash.
+         * @param entry The depth, the move that led to the state and flags.
+         * @return True if the state was already visited at the same or a smaller depth (a hit); the
+         * state should not be expanded again. False if it was stored or its depth lowered.
+         */
+        bool probe(uint64_t key, const TranspositionEntry& entry);
+
+        /**
+         * @brief Looks a state up without changing the table or its counters.
+         * @return True and the entry if the state is in the table.
+         */
+        bool find(uint64_t key, TranspositionEntry& entry) const;
+
+        /**
+         * @brief Returns the number of entries the table holds.
+         */
+        [[nodiscard]] size_t capacity() const;
+
+        /**
+         * @brief Returns the counters.
+         */
+        [[nodiscard]] TranspositionStats stats() const;
+
+    private:
+        /**
+         * @brief An entry: `check` is the key XOR `data`; both zero when empty.
+         */
+        struct Slot {
+            std::atomic<uint64_t> check;
+            std::atomic<uint64_t> data;
+        };
+
+        /**
+         * @brief A bucket of slots, one cache line.
+         */
+        struct alignas(64) Bucket {
+            Slot slots[BUCKET_SIZE];
+        };
+
+        /**
+         * @brief A counter on its own cache line, so threads don't contend on neighbors.
+         */
+        struct alignas(64) Counter {
+            std::atomic<uint64_t> value{ 0 };
+        };
+
+        /**
+         * @brief Packs an entry and the current age into a payload word. Live payloads are non-zero.
+         */
+        [[nodiscard]] uint64_t pack(const TranspositionEntry& entry) const;
+
+        /**
+         * @brief Unpacks a payload word.
+         */
+        [[nodiscard]] static TranspositionEntry unpack(uint64_t data);
+
+        /**
+         * @brief Returns the age stored in a payload word.
+         */
+        [[nodiscard]] static int ageOf(uint64_t data);
+
+        /**
+         * @brief Returns the bucket a key belongs to.
+         */
+        [[nodiscard]] Bucket& bucketOf(uint64_t key) const;
+
+        /**
+         * @brief The buckets.
+         */
+        std::unique_ptr<Bucket[]> m_buckets;
+
+        /**
+         * @brief The number of buckets minus one; the bucket count is a power of two.
+         */
+        uint64_t m_mask = 0;
+
+        /**
+         * @brief The age of the current search, from 1 to 255.
+         */
+        std::atomic<int> m_age{ 1 };
+
+        Counter m_hits;
+        Counter m_misses;
+        Counter m_collisions;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,109 @@
+// Copyright 2024 Jason Ossai
+
+#include "SokobanUndoTree.hpp"
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace SB {
+
+    SokobanUndoTree::SokobanUndoTree(std::pmr::memory_resource* resource) : m_nodes(resource) {
+        clear();
+    }
+
+    void SokobanUndoTree::clear() {
+        m_nodes.clear();
+
+        UndoNode root{};
+        root.parent = NONE;
+        root.firstChild = NONE;
+        root.nextSibling = NONE;
+        m_nodes.push_back(root);
+
+        m_current = ROOT;
+    }
+
+    void SokobanUndoTree::release() {
+        m_nodes = std::pmr::vector<UndoNode>{ m_nodes.get_allocator() };
+        m_current = ROOT;
+    }
+
+    int SokobanUndoTree::record(const UndoNode& edge) {
+        // Share the prefix: re-enter the existing child if this move has been made here before
+        auto lastChild = NONE;
+        for (auto child = m_nodes[m_current].firstChild; child != NONE;
+            child = m_nodes[child].nextSibling) {
+            if (m_nodes[child].direction == edge.direction) {
+                m_nodes[child].orientationBefore = edge.orientationBefore;
+                m_current = child;
+                return m_current;
+            }
+            lastChild = child;
+        }
+
+        UndoNode node{ edge };
+        node.parent = m_current;
+        node.firstChild = NONE;
+        node.nextSibling = NONE;
+        node.depth = m_nodes[m_current].depth + 1;
+
+        const auto id = static_cast<int>(m_nodes.size());
+        m_nodes.push_back(node);
+
+        // Append the new node to the end of the sibling list to keep branches in creation order
+        if (lastChild == NONE) {
+            m_nodes[m_current].firstChild = id;
+        }
+        else {
+            m_nodes[lastChild].nextSibling = id;
+        }
+
+        m_current = id;
+        return m_current;
+    }
+
+    int SokobanUndoTree::current() const { return m_current; }
+
+    void SokobanUndoTree::setCurrent(const int id) {
+        if (id < 0 || id >= size()) {
+            throw std::out_of_range("Invalid undo tree node: " + std::to_string(id));
+        }
+
+        m_current = id;
+    }
+
+    const UndoNode& SokobanUndoTree::node(const int id) const {
+        if (id < 0 || id >= size()) {
+            throw std::out_of_range("Invalid undo tree node: " + std::to_string(id));
+        }
+
+        return m_nodes[id];
+    }
+
+    std::vector<int> SokobanUndoTree::children(const int id) const {
+        std::vector<int> result;
+        for (auto child = node(id).firstChild; child != NONE; child = m_nodes[child].nextSibling) {
+            result.push_back(child);
+        }
+
+        return result;
+    }
+
+    int SokobanUndoTree::commonAncestor(int first, int second) const {
+        while (node(first).depth > node(second).depth) {
+            first = m_nodes[first].parent;
+        }
+        while (m_nodes[second].depth > m_nodes[first].depth) {
+            second = m_nodes[second].parent;
+        }
+        while (first != second) {
+            first = m_nodes[first].parent;
+            second = m_nodes[second].parent;
+        }
+
+        return first;
+    }
+
+    int SokobanUndoTree::size() const { return static_cast<int>(m_nodes.size()); }
+
+}  // namespace SB
@@ -0,0 +1,144 @@
+// Copyright 2024 Jason Ossai
+
+#ifndef SOKOBANUNDOTREE_HPP
+#define SOKOBANUNDOTREE_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+#include <SFML/Graphics.hpp>
+#include "SokobanConstants.hpp"
+
+namespace SB {
+
+    /**
+     * @brief A single tile change recorded on an undo tree edge.
+     */
+    struct TileDelta {
+        int index;
+        TileChar before;
+        TileChar after;
+    };
+
+    /**
+     * @brief A node of the undo tree. Every node except the root stores the edge that leads into it
+     * from its parent: the move direction, the player's state before the move and the tiles that the
+     * move changed. A move changes at most two tiles (the box's old and new cells), so nodes have a
+     * fixed size and never hold a board copy.
+     */
+    struct UndoNode {
+        int parent;
+        int firstChild;
+        int nextSibling;
+        int depth;
+        Direction direction;
+        Direction orientationBefore;
+        sf::Vector2i playerLocBefore;
+        int scoreBefore;
+        int scoreAfter;
+
+        /**
+         * @brief The game's freeze deadlock flag before and after the move, so that undoing or
+         * replaying the move restores it without looking at the board.
+         */
+        bool isFrozenBefore;
+        bool isFrozenAfter;
+
+        int deltaCount;
+        std::array<TileDelta, 2> deltas;
+    };
+
+    /**
+     * @brief A branching move history. Undoing and then making a different move starts a new branch
+     * instead of discarding the old line; making the same move again re-enters the existing child,
+     * so common prefixes are shared. Node 0 is the root, which corresponds to the initial board.
+     */
+    class SokobanUndoTree {
+    public:
+        /**
+         * @brief The id of the root node.
+         */
+        static constexpr int ROOT = 0;
+
+        /**
+         * @brief Marks the absence of a node (no parent, no child, no sibling).
+         */
+        static constexpr int NONE = -1;
+
+        /**
+         * @brief Creates an undo tree that only contains the root node.
+         * @param resource The memory resource the nodes are allocated from.
+         */
+        explicit SokobanUndoTree(
+            std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        /**
+         * @brief Removes every node except the root and moves back to the root. The node storage is
+         * kept for the next moves.
+         */
+        void clear();
+
+        /**
+         * @brief Removes every node, the root included, and frees the node storage, so that the
+         * memory resource can be released. `clear()` must be called before the tree is used again.
+         */
+        void release();
+
+        /**
+         * @brief Records a move made from the current node and makes its node current. If the current
+         * node already has a child for the same direction, that child is reused.
+         * @param edge The edge to record. Only the edge fields are read; the links are managed here.
+         * @return The id of the node the move leads to.
+         */
+        int record(const UndoNode& edge);
+
+        /**
+         * @brief Returns the id of the current node.
+         */
+        [[nodiscard]] int current() const;
+
+        /**
+         * @brief Sets the current node.
+         * @param id The id of the node.
+         * @throws std::out_of_range if the id does not name a node.
+         */
+        void setCurrent(int id);
+
+        /**
+         * @brief Returns the node with the given id.
+         * @throws std::out_of_range if the id does not name a node.
+         */
+        [[nodiscard]] const UndoNode& node(int id) const;
+
+        /**
+         * @brief Returns the ids of the children of a node, i.e. the branches leaving it, in the order
+         * they were created.
+         */
+        [[nodiscard]] std::vector<int> children(int id) const;
+
+        /**
+         * @brief Returns the deepest node that is an ancestor of (or equal to) both nodes.
+         */
+        [[nodiscard]] int commonAncestor(int first, int second) const;
+
+        /**
+         * @brief Returns the number of nodes, including the root.
+         */
+        [[nodiscard]] int size() const;
+
+    private:
+        /**
+         * @brief All nodes; a node's id is its index in this vector.
+         */
+        std::pmr::vector<UndoNode> m_nodes;
+
+        /**
+         * @brief The id of the current node.
+         */
+        int m_current = ROOT;
+    };
+
+}  // namespace SB
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright 2024 Jason Ossai
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "SokobanBatchEnv.hpp"
+#include "SokobanLevel.hpp"
+
+namespace {
+
+    /**
+     * @brief Steps every board a number of times with random actions, resetting the boards that
+     * are done, and returns the steps per second.
+     */
+    double stepsPerSecond(SB::SokobanBatchEnv& env, const int steps, const bool withObservations) {
+        const auto count = env.count();
+        std::vector<uint8_t> actions(count);
+        std::vector<float> rewards(count);
+        std::vector<uint8_t> dones(count);
+        std::vector<uint8_t> observations(withObservations ? count * env.observationSize() : 0);
+        auto* const buffer = withObservations ? observations.data() : nullptr;
+
+        env.reset();
+        uint32_t random{ 2463534242u };
+        const auto start = std::chrono::steady_clock::now();
+        for (int step{ 0 }; step < steps; ++step) {
+            for (auto& action : actions) {
+                random ^= random << 13;
+                random ^= random >> 17;
+                random ^= random << 5;
+                action = static_cast<uint8_t>(random & 3);
+            }
+            env.step(actions.data(), rewards.data(), dones.data(), buffer);
+            for (int board{ 0 }; board < count; ++board) {
+                if (dones[board]) {
+                    env.reset(board);
+                }
+            }
+        }
+
+        const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+        return static_cast<double>(count) * steps / seconds;
+    }
+
+}  // namespace
+
+/**
+ * @brief Measures the steps per second of a batch environment with random actions, with and without
+ * observations.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: the level file, optionally the number of boards
+ * (default 4096), the number of steps (default 1000) and the number of threads (default: one per
+ * core).
+ */
+int main(const int size, const char* arguments[]) {
+    if (size < 2) {
+        std::cout << "Usage: batchbench <level file> [boards] [steps] [threads]" << std::endl;
+        return 1;
+    }
+
+    SB::SokobanLevel level;
+    std::ifstream file{ arguments[1] };
+    if (!(file >> level)) {
+        std::cerr << "Can't read level: " << arguments[1] << std::endl;
+        return 1;
+    }
+    const auto boards = size >= 3 ? std::stoi(arguments[2]) : 4096;
+    const auto steps = size >= 4 ? std::stoi(arguments[3]) : 1000;
+    const auto threads = size >= 5 ? static_cast<unsigned>(std::stoul(arguments[4])) : 0u;
+
+    SB::SokobanBatchEnv env{ level, boards, threads };
+    std::cout << "Level: " << level.width() << "x" << level.height() << ", boards: " << boards
+        << ", steps: " << steps << ", threads: " << env.threadCount() << std::endl;
+    std::cout << "Steps/s without observations: " << stepsPerSecond(env, steps, false)
+        << std::endl;
+    std::cout << "Steps/s with observations: " << stepsPerSecond(env, steps, true) << std::endl;
+
+    return 0;
+}
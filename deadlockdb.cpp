@@ -0,0 +1,24 @@
+// Copyright 2024 Jason Ossai
+
+#include <iostream>
+#include <string>
+#include "SokobanConstants.hpp"
+#include "SokobanDeadlockTable.hpp"
+
+/**
+ * @brief Builds the deadlock pattern table offline.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments. The optional argument is the filename of the table
+ * to write; it defaults to `SB::DEADLOCK_TABLE_FILENAME`.
+ */
+int main(const int size, const char* arguments[]) {
+    const std::string filename{ size >= 2 ? arguments[1] : SB::DEADLOCK_TABLE_FILENAME };
+    if (!SB::SokobanDeadlockTable::saveToFile(filename)) {
+        std::cout << "Failed to write the deadlock table: " << filename << std::endl;
+        return 1;
+    }
+
+    std::cout << "Wrote " << SB::SokobanDeadlockTable::PATTERN_COUNT << " patterns to " << filename
+        << std::endl;
+    return 0;
+}
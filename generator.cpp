@@ -0,0 +1,65 @@
+// Copyright 2024 Jason Ossai
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "SokobanLevelGenerator.hpp"
+
+/**
+ * @brief Generates solvable levels in parallel. Each level is written to `level_<seed>.lvl` with its
+ * solution in `level_<seed>.sol`, and `levels.csv` lists the levels from easiest to hardest.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: the output directory, the number of levels, and
+ * optionally the first seed, the minimum size and the maximum size.
+ */
+int main(const int size, const char* arguments[]) {
+    if (size < 3) {
+        std::cout << "Usage: generator <output directory> <count> [first seed] [min size] [max size]"
+            << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path outputDir{ arguments[1] };
+    const auto count = std::stoi(arguments[2]);
+    const auto firstSeed = size >= 4 ? std::stoull(arguments[3]) : 1ull;
+
+    SB::GeneratorOptions options;
+    if (size >= 5) {
+        options.minSize = std::stoi(arguments[4]);
+    }
+    if (size >= 6) {
+        options.maxSize = std::stoi(arguments[5]);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto levels = SB::SokobanLevelGenerator{ options }.generateBatch(firstSeed, count);
+    const auto seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::filesystem::create_directories(outputDir);
+    for (const auto& level : levels) {
+        const auto name = "level_" + std::to_string(level.seed);
+        std::ofstream{ outputDir / (name + ".lvl") } << level;
+        std::ofstream{ outputDir / (name + ".sol") } << level.solution << std::endl;
+    }
+
+    // Rate difficulty by solution length: pushes first, then moves
+    std::sort(levels.begin(), levels.end(), [](const auto& first, const auto& second) {
+        return first.pushes != second.pushes ? first.pushes < second.pushes
+            : first.moves < second.moves;
+        });
+    std::ofstream csv{ outputDir / "levels.csv" };
+    csv << "file,width,height,pushes,moves" << std::endl;
+    for (const auto& level : levels) {
+        csv << "level_" << level.seed << ".lvl," << level.width << "," << level.height << ","
+            << level.pushes << "," << level.moves << std::endl;
+    }
+
+    std::cout << "Generated " << levels.size() << " of " << count << " levels in " << seconds
+        << " s (" << static_cast<int>(levels.size() / seconds * 60.0) << " levels per minute)"
+        << std::endl;
+    return 0;
+}
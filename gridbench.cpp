@@ -0,0 +1,112 @@
+// Copyright 2024 Jason Ossai
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SokobanGridView.hpp"
+
+namespace {
+
+    /**
+     * @brief The traversal the tile grid used before the grid view: a `std::function` callback and a
+     * checked lookup per tile.
+     */
+    void traverseChecked(const std::vector<SB::TileChar>& grid, const int width, const int height,
+        const std::function<bool(sf::Vector2i, SB::TileChar)>& callback) {
+        auto stopIteration = false;
+        for (int row = 0; !stopIteration && row < height; ++row) {
+            for (int col = 0; !stopIteration && col < width; ++col) {
+                const auto index = col + row * width;
+                if (index < 0 || index >= static_cast<int>(grid.size())) {
+                    throw std::out_of_range("Invalid coordinate");
+                }
+                stopIteration = callback({ col, row }, grid.at(index));
+            }
+        }
+    }
+
+    /**
+     * @brief Runs a traversal a number of times and returns the mean milliseconds per run.
+     */
+    template <typename Function>
+    double time(const int runs, Function&& function) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int run{ 0 }; run < runs; ++run) {
+            function();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+            .count() / runs;
+    }
+
+}  // namespace
+
+/**
+ * @brief Compares the `std::function` traversal with the grid view on a large grid: counting tiles
+ * as `reset()` does and writing rows as `operator<<` does.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: optionally the side of the square grid (default 1000)
+ * and the number of runs (default 20).
+ */
+int main(const int size, const char* arguments[]) {
+    const auto side = size >= 2 ? std::stoi(arguments[1]) : 1000;
+    const auto runs = size >= 3 ? std::stoi(arguments[2]) : 20;
+
+    // A deterministic mix of tiles
+    const SB::TileChar tiles[] = { SB::TileChar::Empty, SB::TileChar::Wall, SB::TileChar::Box,
+                                   SB::TileChar::Storage, SB::TileChar::Empty,
+                                   SB::TileChar::BoxStorage, SB::TileChar::Empty };
+    std::vector<SB::TileChar> grid(static_cast<size_t>(side) * side);
+    for (size_t index{ 0 }; index < grid.size(); ++index) {
+        grid[index] = tiles[(index * 2654435761u >> 7) % std::size(tiles)];
+    }
+    const SB::SokobanGridView<const SB::TileChar> view{ grid.data(), side, side };
+
+    int64_t checksum{ 0 };
+    const auto countChecked = time(runs, [&] {
+        traverseChecked(grid, side, side, [&](const sf::Vector2i, const SB::TileChar tileChar) {
+            checksum += tileChar == SB::TileChar::Box;
+            return false;
+            });
+        });
+    const auto countView = time(runs, [&] {
+        view.forEachCell([&](const sf::Vector2i, const SB::TileChar tileChar) {
+            checksum += tileChar == SB::TileChar::Box;
+            });
+        });
+
+    std::string text;
+    const auto writeChecked = time(runs, [&] {
+        text.clear();
+        traverseChecked(grid, side, side, [&](const sf::Vector2i coordinate,
+            const SB::TileChar tileChar) {
+                if (coordinate.x == 0) {
+                    text.push_back('\n');
+                }
+                text.push_back(static_cast<char>(tileChar));
+                return false;
+            });
+        });
+    const auto writeView = time(runs, [&] {
+        text.clear();
+        for (int y{ 0 }; y < view.height(); ++y) {
+            const auto row = view.row(y);
+            text.push_back('\n');
+            std::transform(row.begin(), row.end(), std::back_inserter(text),
+                [](const SB::TileChar tileChar) { return static_cast<char>(tileChar); });
+        }
+        });
+
+    std::cout << "Grid: " << side << "x" << side << ", runs: " << runs << " (checksum "
+        << checksum << ")" << std::endl;
+    std::cout << "traversal,std::function ms,view ms,speedup" << std::endl;
+    std::cout << "count tiles," << countChecked << "," << countView << ","
+        << countChecked / countView << std::endl;
+    std::cout << "write rows," << writeChecked << "," << writeView << ","
+        << writeChecked / writeView << std::endl;
+
+    return 0;
+}
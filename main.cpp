@@ -1,25 +1,155 @@
 // Copyright 2024 Jason Ossai
 
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
 #include "Sokoban.hpp"
+#include "SokobanAssets.hpp"
+#include "SokobanAudio.hpp"
+#include "SokobanCampaign.hpp"
+#include "SokobanHint.hpp"
+#include "SokobanReplay.hpp"
+#include "SokobanSolution.hpp"
+#include "SokobanTelemetry.hpp"
 
 /**
- * @brief Starts a Sokoban game.
+ * @brief Returns the name of a direction for messages.
+ */
+const char* directionName(const SB::Direction direction) {
+    switch (direction) {
+    case SB::Direction::Up:
+        return "up";
+    case SB::Direction::Down:
+        return "down";
+    case SB::Direction::Left:
+        return "left";
+    case SB::Direction::Right:
+        return "right";
+    }
+
+    return "";
+}
+
+/**
+ * @brief Controls a replay with a key: space plays or pauses, left and right step, up and down
+ * double or halve the speed, B reverses it, and Home and End seek to either end.
+ */
+void controlReplay(SB::SokobanReplay& replay, const sf::Keyboard::Key key) {
+    switch (key) {
+    case sf::Keyboard::Key::Space:
+        replay.setPlaying(!replay.isPlaying());
+        break;
+    case sf::Keyboard::Key::Left:
+        replay.stepBackward();
+        break;
+    case sf::Keyboard::Key::Right:
+        replay.stepForward();
+        break;
+    case sf::Keyboard::Key::Up:
+        replay.setSpeed(replay.speed() * 2.0);
+        break;
+    case sf::Keyboard::Key::Down:
+        replay.setSpeed(replay.speed() / 2.0);
+        break;
+    case sf::Keyboard::Key::B:
+        replay.setSpeed(-replay.speed());
+        break;
+    case sf::Keyboard::Key::Home:
+        replay.seek(0);
+        break;
+    case sf::Keyboard::Key::End:
+        replay.seek(replay.size());
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Resizes a window to a game's board, e.g. after the game moved on to another level.
+ */
+void fitWindow(sf::RenderWindow& window, const SB::Sokoban& sokoban) {
+    const auto width{ sokoban.width() * SB::TILE_WIDTH };
+    const auto height{ sokoban.height() * SB::TILE_HEIGHT };
+    window.setSize(sf::Vector2u(static_cast<unsigned>(width), static_cast<unsigned>(height)));
+    window.setView(sf::View(sf::FloatRect(0.0f, 0.0f, static_cast<float>(width),
+        static_cast<float>(height))));
+}
+
+/**
+ * @brief Starts a Sokoban game. Press H for a hint, which is searched for in the background and
+ * outlines the tile to step onto once found.
  * @param size The size of the argument list.
  * @param arguments The command line arguments. This game requires one argument, which is the
- * filename of the level file to load.
+ * filename of the level file to load, optionally followed by `--no-audio` to play in silence,
+ * `--telemetry <file>` to log every move, push, undo, reset and win to a rotating telemetry log,
+ * `--replay <file>` to watch the moves of a LURD file instead of playing (see `controlReplay`), and
+ * `--campaign` to read a level list (see `SB::readLevelList`) instead of a level and play its levels
+ * in order, each starting as soon as the one before is won.
  */
 int main(const int size, const char* arguments[]) {
+    // Startup is timed from here to the first frame on screen
+    sf::Clock startupClock;
+
     // Check arguments
     if (size < 2) {
         std::cout << "Too few arguments! Require the filename of the level file." << std::endl;
         return 1;
     }
 
-    // Create a Sokoban game object and load the level file
+    // Turn the audio off before anything opens a sound file
+    std::string telemetryFilename;
+    std::string replayFilename;
+    auto isCampaign = false;
+    for (int i{ 2 }; i < size; ++i) {
+        const std::string argument{ arguments[i] };
+        if (argument == "--no-audio") {
+            SB::SokobanAudio::instance().setEnabled(false);
+        }
+        else if (argument == "--telemetry" && i + 1 < size) {
+            telemetryFilename = arguments[++i];
+        }
+        else if (argument == "--replay" && i + 1 < size) {
+            replayFilename = arguments[++i];
+        }
+        else if (argument == "--campaign") {
+            isCampaign = true;
+        }
+    }
+
+    // The telemetry log is written on a thread of its own, so logging costs the loop no I/O
+    std::unique_ptr<SB::SokobanTelemetry> telemetry;
+    if (!telemetryFilename.empty()) {
+        telemetry = std::make_unique<SB::SokobanTelemetry>(telemetryFilename);
+    }
+
+    // Create a Sokoban game object and load the level file. A single level is a campaign of one;
+    // the levels after it are parsed in the background while the one before is played.
     const std::string levelFilename{ arguments[1] };
-    SB::Sokoban sokoban{ levelFilename };
+    SB::SokobanCampaign campaign{ isCampaign ? SB::readLevelList(levelFilename) :
+        std::vector<std::string>{ levelFilename } };
+    SB::Sokoban sokoban;
+    campaign.start(sokoban);
+    sokoban.setTelemetry(telemetry.get());
+
+    // A replay is simulated once with checkpoints, so seeking anywhere replays few moves
+    std::unique_ptr<SB::SokobanReplay> replay;
+    if (!replayFilename.empty()) {
+        std::ifstream replayFile{ replayFilename };
+        if (!replayFile.is_open()) {
+            std::cout << "File not found: " << replayFilename << std::endl;
+            return 1;
+        }
+        std::stringstream lurd;
+        lurd << replayFile.rdbuf();
+        replay = std::make_unique<SB::SokobanReplay>(sokoban.level(), SB::parseLurd(lurd.str()));
+        replay->setPlaying(true);
+    }
+    auto replayPosition{ 0 };
 
     // Create a window based on the Sokoban game width and height
     const auto windowWidth{ sokoban.width() * SB::TILE_WIDTH };
@@ -42,7 +172,20 @@ int main(const int size, const char* arguments[]) {
         { sf::Keyboard::Key::Right, SB::Direction::Right }
     };
 
+    // Hints are searched for on a worker thread; the loop only polls for them
+    SB::SokobanHintEngine hintEngine;
+    SB::Hint hint;
+    auto isHintShown = false;
+    sf::RectangleShape hintTile{ sf::Vector2f(static_cast<float>(SB::TILE_WIDTH),
+        static_cast<float>(SB::TILE_HEIGHT)) };
+    hintTile.setFillColor(sf::Color::Transparent);
+    hintTile.setOutlineColor(sf::Color::Yellow);
+    hintTile.setOutlineThickness(-3.0f);
+
     // Game loop
+    auto& assets = SB::SokobanAssets::instance();
+    auto isFirstFrame = true;
+    auto isLoading = true;
     sf::Clock clock;
     while (window.isOpen()) {
         sf::Event event{};
@@ -52,11 +195,16 @@ int main(const int size, const char* arguments[]) {
                 break;
             }
 
+            // Keys control the replay, if there is one, rather than the player
+            if (event.type == sf::Event::KeyPressed && replay) {
+                controlReplay(*replay, event.key.code);
+            }
             // Listen to keypress event
-            if (event.type == sf::Event::KeyPressed) {
+            else if (event.type == sf::Event::KeyPressed) {
                 // Move player
                 const auto itDirection = movePlayerKeyMap.find(event.key.code);
-                if (itDirection != movePlayerKeyMap.end()) {
+                const auto isMove = itDirection != movePlayerKeyMap.end();
+                if (isMove) {
                     sokoban.movePlayer(itDirection->second);
                 }
 
@@ -69,15 +217,91 @@ int main(const int size, const char* arguments[]) {
                 if (event.key.code == sf::Keyboard::U) {
                     sokoban.undo();
                 }
+
+                // Any hint is about the position before the key
+                if (isMove || event.key.code == sf::Keyboard::R ||
+                    event.key.code == sf::Keyboard::U) {
+                    hintEngine.cancel();
+                    isHintShown = false;
+                }
+
+                // Ask for a hint
+                if (event.key.code == sf::Keyboard::H && !sokoban.isWon()) {
+                    hintEngine.request(sokoban);
+                    isHintShown = false;
+                }
+            }
+        }
+
+        const auto dt = clock.restart().asMicroseconds();
+        if (replay) {
+            replay->update(dt);
+            if (replay->position() != replayPosition) {
+                replayPosition = replay->position();
+                sokoban.restore(replay->state());
             }
         }
+        sokoban.update(dt);
 
-        sokoban.update(clock.restart().asMicroseconds());
+        // A won level gives way to the next one once it is parsed; until then the result screen
+        // stays up. A level that fails to load is skipped, so that it is not tried again every
+        // frame.
+        if (sokoban.isWon() && !replay && campaign.isNextReady()) {
+            const auto next = campaign.nextIndex();
+            try {
+                campaign.advance(sokoban);
+                std::cout << "Level " << campaign.index() + 1 << " of " << campaign.size() << ": "
+                    << campaign.filename(campaign.index()) << std::endl;
+                fitWindow(window, sokoban);
+                hintEngine.cancel();
+                isHintShown = false;
+            } catch (const std::exception& exception) {
+                std::cerr << "Skipping level " << next + 1 << " of " << campaign.size() << ": "
+                    << exception.what() << std::endl;
+                campaign.skip();
+            }
+        }
+
+        if (hintEngine.poll(hint)) {
+            isHintShown = hint.isSolvable && hint.moves > 0;
+            if (!hint.isSolvable) {
+                std::cout << "Hint: no solution found from here" << std::endl;
+            }
+            else if (isHintShown) {
+                std::cout << "Hint: " << (hint.isPush ? "push " : "move ")
+                    << directionName(hint.direction) << " (" << hint.pushes << " pushes, "
+                    << hint.moves << " moves left)" << std::endl;
+            }
+        }
+
+        // Swap in the assets decoded since the last frame
+        if (isLoading) {
+            assets.update();
+        }
 
         if (window.isOpen()) {
             window.clear(sf::Color::White);
             window.draw(sokoban);
+            if (isHintShown) {
+                const auto& level = sokoban.level();
+                const auto tile = level.toCoordinate(
+                    level.toIndex(sf::Vector2i(sokoban.playerLoc())) + level.offset(hint.direction));
+                hintTile.setPosition(static_cast<float>(tile.x * SB::TILE_WIDTH),
+                    static_cast<float>(tile.y * SB::TILE_HEIGHT));
+                window.draw(hintTile);
+            }
             window.display();
         }
+
+        if (isFirstFrame) {
+            isFirstFrame = false;
+            std::cout << "Time to first frame: " << startupClock.getElapsedTime().asMilliseconds()
+                << " ms" << std::endl;
+        }
+        if (isLoading && assets.isReady()) {
+            isLoading = false;
+            std::cout << "Assets loaded: " << startupClock.getElapsedTime().asMilliseconds()
+                << " ms" << std::endl;
+        }
     }
 }
@@ -0,0 +1,136 @@
+// Copyright 2024 Jason Ossai
+
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SokobanCanonical.hpp"
+#include "SokobanOptimizer.hpp"
+#include "SokobanParallel.hpp"
+#include "SokobanSolutionCache.hpp"
+
+/**
+ * @brief Shortens solutions and prints their par scores as CSV. Each optimized solution is written
+ * next to its input as `<solution file>.opt`. With several solutions, the solutions are optimized in
+ * parallel; with one, its windows are. A level optimized before for the same objective, in any
+ * orientation, gets its solution from the solution cache instead, and new results go into it.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: optionally `--pushes` to minimize pushes instead of
+ * moves, `--window <pushes>` to set the window size, `--cache <file>` to pick the solution cache and
+ * `--no-cache` to skip it, then pairs of level and solution files.
+ */
+int main(const int size, const char* arguments[]) {
+    SB::OptimizerOptions options;
+    auto cacheFilename = SB::SOLUTION_CACHE_FILENAME;
+    std::vector<std::string> files;
+    for (int i{ 1 }; i < size; ++i) {
+        const std::string argument{ arguments[i] };
+        if (argument == "--pushes") {
+            options.objective = SB::Objective::Pushes;
+        } else if (argument == "--window" && i + 1 < size) {
+            options.windowPushes = std::stoi(arguments[++i]);
+        } else if (argument == "--cache" && i + 1 < size) {
+            cacheFilename = arguments[++i];
+        } else if (argument == "--no-cache") {
+            cacheFilename.clear();
+        } else {
+            files.push_back(argument);
+        }
+    }
+
+    if (files.empty() || files.size() % 2 != 0) {
+        std::cout << "Usage: optimizer [--pushes] [--window <pushes>] [--cache <file>] [--no-cache] "
+            "<level file> <solution file> [<level file> <solution file> ...]" << std::endl;
+        return 1;
+    }
+
+    const auto count = static_cast<int>(files.size() / 2);
+    if (count > 1) {
+        options.threads = 1;
+    }
+    const SB::SokobanOptimizer optimizer{ options };
+
+    std::unique_ptr<SB::SokobanSolutionCache> cache;
+    if (!cacheFilename.empty()) {
+        try {
+            cache = std::make_unique<SB::SokobanSolutionCache>(cacheFilename);
+        } catch (const std::runtime_error& error) {
+            std::cerr << "No solution cache: " << error.what() << std::endl;
+        }
+    }
+    const auto flag = options.objective == SB::Objective::Pushes ? SB::CACHE_OPTIMIZED_PUSHES :
+        SB::CACHE_OPTIMIZED_MOVES;
+    const auto isBetter = [&options](const int moves, const int pushes, const int otherMoves,
+        const int otherPushes) {
+        return options.objective == SB::Objective::Pushes ?
+            std::make_pair(pushes, moves) <= std::make_pair(otherPushes, otherMoves) :
+            std::make_pair(moves, pushes) <= std::make_pair(otherMoves, otherPushes);
+    };
+    std::atomic<int> hits{ 0 };
+
+    std::vector<std::string> lines(count);
+    SB::parallelFor(count, [&](const int i) {
+        const auto& levelFilename = files[2 * i];
+        const auto& solutionFilename = files[2 * i + 1];
+        try {
+            SB::SokobanLevel level;
+            std::ifstream levelFile{ levelFilename };
+            if (!levelFile.is_open()) {
+                throw std::invalid_argument("File not found: " + levelFilename);
+            }
+            levelFile >> level;
+
+            std::ifstream solutionFile{ solutionFilename };
+            if (!solutionFile.is_open()) {
+                throw std::invalid_argument("File not found: " + solutionFilename);
+            }
+            const std::string solution{ std::istreambuf_iterator<char>{ solutionFile }, {} };
+
+            // A solution the optimizer already produced for this level and objective needs no
+            // second run, unless the one given, replayed to check it, is better
+            const auto canonical = SB::canonicalize(level);
+            const auto key = SB::cacheKey(canonical.hash, flag);
+            SB::CachedSolution cached;
+            const auto isCached = cache != nullptr && cache->find(key, cached);
+            SB::OptimizerResult result;
+            const auto before = isCached ? SB::SokobanOptimizer::measure(level, solution) :
+                SB::OptimizerResult{};
+            if (isCached &&
+                isBetter(cached.moves, cached.pushes, before.movesBefore, before.pushesBefore)) {
+                result = before;
+                result.solution = SB::transform(cached.solution, canonical.symmetry, true);
+                result.moves = cached.moves;
+                result.pushes = cached.pushes;
+                ++hits;
+            } else {
+                result = optimizer.optimize(level, solution);
+                if (cache != nullptr && (!isCached ||
+                    isBetter(result.moves, result.pushes, cached.moves, cached.pushes))) {
+                    cache->store(key, { SB::transform(result.solution, canonical.symmetry),
+                        result.moves, result.pushes, 0, 0.0, flag });
+                }
+            }
+            std::ofstream{ solutionFilename + ".opt" } << result.solution << std::endl;
+            lines[i] = levelFilename + "," + std::to_string(result.movesBefore) + "," +
+                std::to_string(result.pushesBefore) + "," + std::to_string(result.moves) + "," +
+                std::to_string(result.pushes);
+        } catch (const std::exception& exception) {
+            lines[i] = levelFilename + ",error," + exception.what();
+        }
+        }, count > 1 ? 0 : 1);
+
+    std::cout << "level,moves before,pushes before,moves,pushes" << std::endl;
+    for (const auto& line : lines) {
+        std::cout << line << std::endl;
+    }
+    if (cache != nullptr) {
+        std::cerr << "Cache hits: " << hits << " of " << count << std::endl;
+    }
+
+    return 0;
+}
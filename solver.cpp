@@ -0,0 +1,207 @@
+// Copyright 2024 Jason Ossai
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "Sokoban.hpp"
+#include "SokobanAudio.hpp"
+#include "SokobanCanonical.hpp"
+#include "SokobanSolution.hpp"
+#include "SokobanSolutionCache.hpp"
+#include "SokobanSolver.hpp"
+
+namespace {
+
+    /**
+     * @brief Returns the strategy with a name, as `strategyName` writes it.
+     * @throws std::invalid_argument if no strategy has that name.
+     */
+    SB::Strategy parseStrategy(const std::string& name) {
+        for (const auto strategy : { SB::Strategy::AStar, SB::Strategy::BreadthFirst,
+                                     SB::Strategy::GreedyBestFirst, SB::Strategy::IdaStar }) {
+            if (name == SB::strategyName(strategy)) {
+                return strategy;
+            }
+        }
+
+        throw std::invalid_argument("Unknown strategy: " + name);
+    }
+
+    /**
+     * @brief Prints the command line the solver takes.
+     */
+    void printUsage() {
+        std::cout << "Usage: solver <level file> [--no-macros] [--threads <count>] [--bidirectional] "
+            "[--external <MiB>] [--spill-dir <directory>] [--strategy <name>] "
+            "[--portfolio <name>,<name>...] [--cache <file>] [--no-cache]" << std::endl;
+    }
+
+}  // namespace
+
+/**
+ * @brief Solves a level and verifies the solution by replaying it through `Sokoban::movePlayer`.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: the filename of the level file, and optionally
+ * `--no-macros` to disable tunnel and goal room macros and `--threads <count>` to search on several
+ * threads sharing a transposition table, or `--bidirectional` to search from both ends at once, or
+ * `--external <MiB>` to search breadth-first within a memory budget with the visited states on disk,
+ * in the directory given by `--spill-dir <directory>`. `--strategy <name>` searches with astar
+ * (the default), bfs, greedy or ida; `--portfolio <name>,<name>...` races several strategies on
+ * threads of their own and takes the first solution. A level solved before, in any orientation, is
+ * taken from the solution cache instead of searched, whatever search options are given;
+ * `--cache <file>` picks the cache and `--no-cache` skips it.
+ */
+int main(const int size, const char* arguments[]) {
+    if (size < 2) {
+        printUsage();
+        return 1;
+    }
+
+    const std::string levelFilename{ arguments[1] };
+    std::ifstream ifstream{ levelFilename };
+    if (!ifstream.is_open()) {
+        std::cout << "File not found: " << levelFilename << std::endl;
+        return 1;
+    }
+
+    SB::SokobanLevel level;
+    ifstream >> level;
+
+    SB::SolverOptions options;
+    auto cacheFilename = SB::SOLUTION_CACHE_FILENAME;
+    // A bad strategy name or number ends the run with the usage, not an uncaught exception
+    int i{ 2 };
+    try {
+        for (; i < size; ++i) {
+            const std::string argument{ arguments[i] };
+            if (argument == "--no-macros") {
+                options.useMacros = false;
+            } else if (argument == "--bidirectional") {
+                options.bidirectional = true;
+            } else if (argument == "--threads" && i + 1 < size) {
+                options.threads = std::stoi(arguments[++i]);
+            } else if (argument == "--external" && i + 1 < size) {
+                options.externalMemory = true;
+                options.memoryBytes = std::stoull(arguments[++i]) << 20;
+            } else if (argument == "--spill-dir" && i + 1 < size) {
+                options.spillDirectory = arguments[++i];
+            } else if (argument == "--strategy" && i + 1 < size) {
+                options.strategy = parseStrategy(arguments[++i]);
+            } else if (argument == "--portfolio" && i + 1 < size) {
+                std::istringstream names{ arguments[++i] };
+                for (std::string name; std::getline(names, name, ',');) {
+                    options.portfolio.push_back(parseStrategy(name));
+                }
+            } else if (argument == "--cache" && i + 1 < size) {
+                cacheFilename = arguments[++i];
+            } else if (argument == "--no-cache") {
+                cacheFilename.clear();
+            }
+        }
+    } catch (const std::logic_error&) {
+        std::cout << "Invalid argument: " << arguments[i] << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    // Without a cache, the level is just searched
+    const auto canonical = SB::canonicalize(level);
+    std::unique_ptr<SB::SokobanSolutionCache> cache;
+    if (!cacheFilename.empty()) {
+        try {
+            cache = std::make_unique<SB::SokobanSolutionCache>(cacheFilename);
+        } catch (const std::runtime_error& error) {
+            std::cout << "No solution cache: " << error.what() << std::endl;
+        }
+    }
+
+    SB::SolverResult result;
+    SB::CachedSolution cached;
+    const auto key = SB::cacheKey(canonical.hash, 0);
+    const auto isCached = cache != nullptr && cache->find(key, cached);
+    if (isCached) {
+        result.isSolved = true;
+        result.solution = SB::transform(cached.solution, canonical.symmetry, true);
+        result.moves = cached.moves;
+        result.pushes = cached.pushes;
+        std::cout << "Cached: " << cached.expandedNodes << " expanded nodes, " << cached.seconds
+            << " s saved" << std::endl;
+        const SB::SolverOptions defaults;
+        if (options.strategy != defaults.strategy || !options.portfolio.empty() ||
+            options.externalMemory || options.bidirectional || options.threads != defaults.threads ||
+            options.useMacros != defaults.useMacros) {
+            std::cout << "Search options ignored for a cached solution; --no-cache searches"
+                << std::endl;
+        }
+    } else {
+        SB::SokobanDeadlockTable deadlockTable;
+        SB::SokobanSolver solver{ level, options };
+        if (deadlockTable.loadFromFile(SB::DEADLOCK_TABLE_FILENAME)) {
+            solver.setDeadlockTable(&deadlockTable);
+        }
+
+        result = solver.solve();
+        std::cout << "Goal rooms: " << solver.macros().goalRoomCount() << std::endl;
+        std::cout << "Expanded nodes: " << result.expandedNodes << std::endl;
+        std::cout << "Generated nodes: " << result.generatedNodes << std::endl;
+        std::cout << "Time: " << result.seconds << " s" << std::endl;
+        const auto& visited = result.visited;
+        if (visited.states > 0) {
+            std::cout << "Visited: " << visited.states << " states in " << (visited.bytes >> 10)
+                << " KiB, " << static_cast<double>(visited.bytes) / visited.states
+                << " bytes per state, " << visited.recordBytes << " bytes packed" << std::endl;
+        }
+        if (options.threads > 1 || options.bidirectional) {
+            std::cout << "Table hits: " << result.transpositions.hits
+                << ", misses: " << result.transpositions.misses
+                << ", collisions: " << result.transpositions.collisions << std::endl;
+        }
+        for (const auto& strategy : result.strategies) {
+            std::cout << "Strategy " << SB::strategyName(strategy.strategy) << ": "
+                << (strategy.isWinner ? "won" : strategy.isSolved ? "solved" : "stopped")
+                << " after " << strategy.seconds << " s, " << strategy.expandedNodes
+                << " expanded nodes" << std::endl;
+        }
+        if (options.externalMemory) {
+            const auto& external = result.external;
+            const auto megabytes = static_cast<double>(external.bytesRead + external.bytesWritten) /
+                (1 << 20);
+            std::cout << "Layers: " << external.layers << ", states: " << external.statesWritten
+                << ", peak buffer: " << (external.peakBufferBytes >> 10) << " KiB" << std::endl;
+            std::cout << "I/O: " << (external.bytesRead >> 10) << " KiB read, "
+                << (external.bytesWritten >> 10) << " KiB written, "
+                << (result.seconds > 0.0 ? megabytes / result.seconds : 0.0) << " MiB/s"
+                << std::endl;
+            std::cout << "Merge: " << external.statesMerged << " states in "
+                << external.mergeSeconds << " s, " << (external.mergeSeconds > 0.0 ?
+                    static_cast<double>(external.statesMerged) / external.mergeSeconds : 0.0)
+                << " states/s" << std::endl;
+        }
+    }
+    if (!result.isSolved) {
+        std::cout << "No solution found" << std::endl;
+        return 2;
+    }
+
+    std::cout << "Pushes: " << result.pushes << ", moves: " << result.moves << std::endl;
+    std::cout << result.solution << std::endl;
+
+    // Replay the solution, macros included, through the game itself, in silence
+    SB::SokobanAudio::instance().setEnabled(false);
+    SB::Sokoban sokoban{ levelFilename };
+    for (const auto direction : SB::parseLurd(result.solution)) {
+        sokoban.movePlayer(direction);
+    }
+    std::cout << "Verified: " << (sokoban.isWon() ? "yes" : "no") << std::endl;
+
+    // Keep a verified solution for the next time the level, or an image of it, comes up
+    if (sokoban.isWon() && cache != nullptr && !isCached) {
+        cache->store(key, { SB::transform(result.solution, canonical.symmetry),
+            result.moves, result.pushes, result.expandedNodes, result.seconds, 0 });
+    }
+
+    return sokoban.isWon() ? 0 : 3;
+}
@@ -0,0 +1,46 @@
+// Copyright 2024 Jason Ossai
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "SokobanSolution.hpp"
+#include "SokobanTelemetry.hpp"
+
+/**
+ * @brief Converts a telemetry log to CSV on the standard output, one row per event, oldest first.
+ * The rotated files of the log are read before the current one. Directions are written in LURD
+ * notation.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: the filename of the current log file.
+ */
+int main(const int size, const char* arguments[]) {
+    if (size < 2) {
+        std::cout << "Usage: telemetrycsv <log file>" << std::endl;
+        return 1;
+    }
+
+    const auto files = SB::telemetryFiles(arguments[1]);
+    if (files.empty()) {
+        std::cout << "File not found: " << arguments[1] << std::endl;
+        return 1;
+    }
+
+    try {
+        std::cout << "sequence,time_us,elapsed_us,event,direction,x,y,score\n";
+        for (const auto& file : files) {
+            SB::SokobanTelemetryReader reader{ file };
+            SB::TelemetryEvent event;
+            while (reader.next(event)) {
+                std::cout << event.sequence << ',' << event.timeMicroseconds << ','
+                    << event.elapsedMicroseconds << ',' << SB::telemetryEventName(event.type) << ','
+                    << SB::toLurd(event.direction, false) << ',' << event.x << ',' << event.y << ','
+                    << event.score << '\n';
+            }
+        }
+    } catch (const std::runtime_error& error) {
+        std::cout << error.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
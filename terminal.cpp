@@ -0,0 +1,159 @@
+// Copyright 2024 Jason Ossai
+
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "Sokoban.hpp"
+#include "SokobanAssets.hpp"
+#include "SokobanAudio.hpp"
+#include "SokobanTerminal.hpp"
+
+namespace {
+
+    /**
+     * @brief Puts the terminal in raw mode while alive: keys arrive one by one, without echo.
+     */
+    class RawMode {
+    public:
+        RawMode() : m_isRaw(tcgetattr(STDIN_FILENO, &m_saved) == 0) {
+            if (m_isRaw) {
+                auto raw = m_saved;
+                raw.c_lflag &= ~(ICANON | ECHO);
+                raw.c_cc[VMIN] = 1;
+                raw.c_cc[VTIME] = 0;
+                tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+            }
+        }
+
+        RawMode(const RawMode&) = delete;
+        RawMode& operator=(const RawMode&) = delete;
+
+        ~RawMode() {
+            if (m_isRaw) {
+                tcsetattr(STDIN_FILENO, TCSANOW, &m_saved);
+            }
+        }
+
+    private:
+        termios m_saved{};
+        bool m_isRaw;
+    };
+
+    /**
+     * @brief Reads the terminal size; 80x24 if it is not a terminal.
+     */
+    void terminalSize(int& columns, int& rows) {
+        winsize size{};
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_col > 0 && size.ws_row > 0) {
+            columns = size.ws_col;
+            rows = size.ws_row;
+        }
+        else {
+            columns = 80;
+            rows = 24;
+        }
+    }
+
+    /**
+     * @brief Reads a key, turning the arrow key sequences into WASD. Returns 0 at the end of input.
+     */
+    char readKey() {
+        char key{ 0 };
+        if (read(STDIN_FILENO, &key, 1) != 1) {
+            return 0;
+        }
+        if (key != '\x1b') {
+            return key;
+        }
+
+        char sequence[2]{};
+        if (read(STDIN_FILENO, sequence, 2) != 2 || sequence[0] != '[') {
+            return key;
+        }
+        switch (sequence[1]) {
+        case 'A':
+            return 'w';
+        case 'B':
+            return 's';
+        case 'C':
+            return 'd';
+        case 'D':
+            return 'a';
+        default:
+            return key;
+        }
+    }
+
+}  // namespace
+
+/**
+ * @brief Plays a Sokoban level in the terminal, without a window. The keys are those of the game:
+ * WASD or the arrows to move, R to reset and U to undo; Q quits. Only the tiles that change are sent
+ * to the terminal, so it stays usable over slow links.
+ * @param size The size of the argument list.
+ * @param arguments The command line arguments: the level file.
+ */
+int main(const int size, const char* arguments[]) {
+    if (size < 2) {
+        std::cout << "Usage: terminal <level file>" << std::endl;
+        return 1;
+    }
+
+    // Nothing here draws through SFML or plays sound
+    SB::SokobanAudio::instance().setEnabled(false);
+    SB::SokobanAssets::instance().setEnabled(false);
+    SB::Sokoban sokoban{ std::string{ arguments[1] } };
+
+    int columns{ 0 };
+    int rows{ 0 };
+    terminalSize(columns, rows);
+    SB::SokobanTerminal terminal{ std::cout, columns, rows };
+
+    const RawMode rawMode;
+    size_t bytes{ terminal.render(sokoban) };
+    for (auto key = readKey(); key != 0 && key != 'q' && key != 'Q'; key = readKey()) {
+        switch (key) {
+        case 'w':
+        case 'W':
+            sokoban.movePlayer(SB::Direction::Up);
+            break;
+        case 'a':
+        case 'A':
+            sokoban.movePlayer(SB::Direction::Left);
+            break;
+        case 's':
+        case 'S':
+            sokoban.movePlayer(SB::Direction::Down);
+            break;
+        case 'd':
+        case 'D':
+            sokoban.movePlayer(SB::Direction::Right);
+            break;
+        case 'r':
+        case 'R':
+            sokoban.reset();
+            break;
+        case 'u':
+        case 'U':
+            sokoban.undo();
+            break;
+        case '\x0c':
+            // Ctrl+L redraws everything, at the current size
+            terminalSize(columns, rows);
+            terminal.invalidate(columns, rows);
+            break;
+        default:
+            break;
+        }
+
+        bytes += terminal.render(sokoban);
+    }
+
+    // Show the cursor again below the board
+    std::cout << "\x1b[?25h\x1b[" << rows << ";1H" << std::endl;
+    std::cout << "Bytes sent: " << bytes << std::endl;
+    return 0;
+}
@@ -3,12 +3,106 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE Main
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <new>
+#include <random>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 #include <boost/test/unit_test.hpp>
+#include "InvalidCoordinateException.hpp"
 #include "Sokoban.hpp"
+#include "SokobanAssets.hpp"
+#include "SokobanAudio.hpp"
+#include "SokobanBatchEnv.hpp"
+#include "SokobanCampaign.hpp"
+#include "SokobanCanonical.hpp"
+#include "SokobanGridView.hpp"
+#include "SokobanHint.hpp"
+#include "SokobanLevelGenerator.hpp"
+#include "SokobanOptimizer.hpp"
+#include "SokobanPushGraph.hpp"
+#include "SokobanReachability.hpp"
+#include "SokobanReplay.hpp"
+#include "SokobanSolution.hpp"
+#include "SokobanSolutionCache.hpp"
+#include "SokobanSolver.hpp"
+#include "SokobanStateFile.hpp"
+#include "SokobanStateSet.hpp"
+#include "SokobanTelemetry.hpp"
+#include "SokobanTerminal.hpp"
+#include "SokobanTranspositionTable.hpp"
+
+/**
+ * @brief Heap allocations are counted while this is set.
+ */
+std::atomic<bool> isCountingAllocations{ false };
+
+/**
+ * @brief The number of heap allocations counted.
+ */
+std::atomic<int> allocationCount{ 0 };
+
+// Replacements that count, and the operator delete replacements that free what they return
+
+void* operator new(const std::size_t size) {
+    if (isCountingAllocations.load(std::memory_order_relaxed)) {
+        ++allocationCount;
+    }
+    if (const auto pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment) {
+    if (isCountingAllocations.load(std::memory_order_relaxed)) {
+        ++allocationCount;
+    }
+    const auto align = static_cast<std::size_t>(alignment);
+    if (const auto pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+// GCC pairs `new` with `delete` even when both are replaced, and takes the free for a mismatch
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* const pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* const pointer, std::size_t) noexcept { std::free(pointer); }
+
+void operator delete(void* const pointer, std::align_val_t) noexcept { std::free(pointer); }
+
+void operator delete(void* const pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * @brief Runs the tests without audio.
+ */
+struct SilentAudio {
+    SilentAudio() { SB::SokobanAudio::instance().setEnabled(false); }
+};
+
+BOOST_TEST_GLOBAL_FIXTURE(SilentAudio);
 
 /**
  * @brief Checks if two coordinates are the same.
@@ -21,6 +115,78 @@ bool isCoordinateEqual(const sf::Vector2u& first, const sf::Vector2u& second) no
     return first.x == second.x && first.y == second.y;
 }
 
+/**
+ * @brief A file in a directory of its own under the system's temporary directory, so that test
+ * runs at the same time never share it. The directory, and whatever was written into it, is removed
+ * with the object, even when a check fails.
+ */
+class TempFile {
+public:
+    explicit TempFile(const std::string& name, const std::string& text = "") {
+        auto directory = (std::filesystem::temp_directory_path() / "sokoban_test_XXXXXX").string();
+        if (mkdtemp(directory.data()) == nullptr) {
+            throw std::runtime_error("Can't create a temporary directory");
+        }
+        m_directory = directory;
+        m_path = (m_directory / name).string();
+        if (!text.empty()) {
+            std::ofstream{ m_path } << text;
+        }
+    }
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    ~TempFile() {
+        std::error_code error;
+        std::filesystem::remove_all(m_directory, error);
+    }
+
+    [[nodiscard]] const std::string& path() const { return m_path; }
+
+    // Removes the file and every file next to it, e.g. an index or rotated logs
+    void clear() const {
+        for (const auto& entry : std::filesystem::directory_iterator{ m_directory }) {
+            std::filesystem::remove(entry.path());
+        }
+    }
+
+private:
+    std::filesystem::path m_directory;
+    std::string m_path;
+};
+
+/**
+ * @brief A level whose two boxes cross a room to a goal room beyond a one-cell entrance.
+ */
+const std::string GOAL_ROOM_LEVEL{ "7 10\n"
+    "##########\n"
+    "#@.......#\n"
+    "#..A..A..#\n"
+    "#####.####\n"
+    "###.....##\n"
+    "###.aa..##\n"
+    "##########\n" };
+
+// Solves a level written to a file and replays the solution through `movePlayer(SB::Direction)`.
+// Returns the search result; `isWon` tells if the replay won the level.
+SB::SolverResult solveAndReplay(const std::string& levelText, const SB::SolverOptions& options,
+    bool& isWon) {
+    const TempFile file{ "solver.lvl", levelText };
+
+    SB::SokobanLevel level;
+    std::ifstream{ file.path() } >> level;
+    const auto result = SB::SokobanSolver{ level, options }.solve();
+
+    SB::Sokoban sokoban{ file.path() };
+    for (const auto direction : SB::parseLurd(result.solution)) {
+        sokoban.movePlayer(direction);
+    }
+    isWon = sokoban.isWon();
+
+    return result;
+}
+
 // Tests if `height()` and `width()` returns the height and width of a map correctly.
 BOOST_AUTO_TEST_CASE(testHeightWidth) {
     const SB::Sokoban sokoban{ "assets/level/level2.lvl" };
@@ -181,3 +347,1130 @@ BOOST_AUTO_TEST_CASE(testIsWonTooManyStorages) {
 
     BOOST_REQUIRE(sokoban.isWon());
 }
+
+// Tests if `undo()` keeps the undone line: making a different move after an undo should create a
+// second branch, and `jumpTo(int)` should be able to return to the first one.
+BOOST_AUTO_TEST_CASE(testUndoTreeBranches) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+    sokoban.movePlayer(SB::Direction::Right);
+    const auto firstBranch = sokoban.undoTree().current();
+    sokoban.undo();
+    sokoban.movePlayer(SB::Direction::Left);
+
+    BOOST_REQUIRE_EQUAL(sokoban.undoTree().children(SB::SokobanUndoTree::ROOT).size(), 2);
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 2, 6 }));
+
+    sokoban.jumpTo(firstBranch);
+
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 4, 6 }));
+}
+
+// Tests if `jumpTo(int)` restores the tiles changed by pushes when jumping back to the root.
+BOOST_AUTO_TEST_CASE(testUndoTreeJumpRestoresBoxes) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+    sokoban.movePlayer(SB::Direction::Right);
+    sokoban.movePlayer(SB::Direction::Right);
+    sokoban.movePlayer(SB::Direction::Right);
+    const auto pushed = sokoban.undoTree().current();
+
+    BOOST_REQUIRE(sokoban.getTileChar({ 7, 6 }) == SB::TileChar::Box);
+
+    sokoban.jumpTo(SB::SokobanUndoTree::ROOT);
+
+    BOOST_REQUIRE(sokoban.getTileChar({ 6, 6 }) == SB::TileChar::Box);
+    BOOST_REQUIRE(sokoban.getTileChar({ 7, 6 }) == SB::TileChar::Empty);
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 3, 6 }));
+
+    sokoban.jumpTo(pushed);
+
+    BOOST_REQUIRE(sokoban.getTileChar({ 7, 6 }) == SB::TileChar::Box);
+    BOOST_REQUIRE_EQUAL(sokoban.undoTree().node(pushed).depth, 3);
+}
+
+// Tests if `lowerBound()` returns the min-cost matching of boxes to storages and follows pushes.
+BOOST_AUTO_TEST_CASE(testLowerBound) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+
+    // One push up for the upper box; two pushes right and one down for the lower box
+    BOOST_REQUIRE_EQUAL(sokoban.lowerBound(), 4);
+
+    sokoban.movePlayer(SB::Direction::Right);
+    sokoban.movePlayer(SB::Direction::Right);
+    sokoban.movePlayer(SB::Direction::Right);
+
+    BOOST_REQUIRE_EQUAL(sokoban.lowerBound(), 3);
+
+    sokoban.undo();
+
+    BOOST_REQUIRE_EQUAL(sokoban.lowerBound(), 4);
+}
+
+// Tests if the incrementally kept reach of the player matches a flood fill after every box moves
+// anywhere, splitting and merging the areas of the level.
+BOOST_AUTO_TEST_CASE(testReachability) {
+    SB::SokobanLevel level;
+    std::istringstream{ GOAL_ROOM_LEVEL } >> level;
+    SB::SokobanReachability reachability{ level };
+    auto boxes = level.initialBoxes();
+    std::vector<int> floor;
+    for (int index{ 0 }; index < level.size(); ++index) {
+        if (!level.isWall(index)) {
+            floor.push_back(index);
+        }
+    }
+
+    std::mt19937 random{ 42 };
+    for (int move{ 0 }; move < 2000; ++move) {
+        const auto isFree = [&](const int index) {
+            return !level.isWall(index) &&
+                std::find(boxes.begin(), boxes.end(), index) == boxes.end();
+        };
+        auto target = floor[random() % floor.size()];
+        if (isFree(target) && target != reachability.player()) {
+            auto& box = boxes[random() % boxes.size()];
+            reachability.moveBox(box, target);
+            box = target;
+        }
+        target = floor[random() % floor.size()];
+        if (isFree(target)) {
+            reachability.movePlayer(target);
+        }
+
+        std::vector<char> isReached(level.size(), 0);
+        std::vector<int> queue{ reachability.player() };
+        isReached[reachability.player()] = 1;
+        for (size_t head{ 0 }; head < queue.size(); ++head) {
+            for (const auto direction : SB::SokobanLevel::DIRECTIONS) {
+                const auto next = queue[head] + level.offset(direction);
+                if (isFree(next) && !isReached[next]) {
+                    isReached[next] = 1;
+                    queue.push_back(next);
+                }
+            }
+        }
+        for (int index{ 0 }; index < level.size(); ++index) {
+            BOOST_REQUIRE_EQUAL(reachability.canReach(index), isReached[index] != 0);
+        }
+        BOOST_REQUIRE_EQUAL(reachability.normalizedPlayer(),
+            *std::min_element(queue.begin(), queue.end()));
+    }
+}
+
+// Tests if positions of a 20-box level survive packing, pack into under 16 bytes each once stored
+// in the slab set, and are found again.
+BOOST_AUTO_TEST_CASE(testStateSet) {
+    // A 12 x 10 room with 20 boxes in its top rows and 20 storages in its bottom rows
+    std::string levelText{ "12 14\n" };
+    for (int y{ 0 }; y < 12; ++y) {
+        for (int x{ 0 }; x < 14; ++x) {
+            levelText += y == 0 || y == 11 || x == 0 || x == 13 ? '#' :
+                y == 1 && x == 1 ? '@' :
+                y >= 2 && y <= 3 && x >= 2 && x <= 11 ? 'A' :
+                y >= 8 && y <= 9 && x >= 2 && x <= 11 ? 'a' : '.';
+        }
+        levelText += '\n';
+    }
+    SB::SokobanLevel level;
+    std::istringstream{ levelText } >> level;
+    const SB::SokobanLowerBound lowerBound{ level };
+    const SB::SokobanStateCodec codec{ level, SB::SokobanSolver::initialState(level),
+        &lowerBound };
+    BOOST_REQUIRE_LT(codec.bytes(), 16u);
+
+    std::vector<int> liveCells;
+    std::vector<int> floorCells;
+    for (int index{ 0 }; index < level.size(); ++index) {
+        if (!level.isWall(index)) {
+            floorCells.push_back(index);
+            if (!lowerBound.isDeadSquare(index)) {
+                liveCells.push_back(index);
+            }
+        }
+    }
+
+    std::mt19937 random{ 42 };
+    SB::SokobanStateSet set{ codec.bytes() };
+    std::vector<uint8_t> records;
+    std::vector<int> decodedBoxes;
+    auto decodedPlayer = 0;
+    for (int state{ 0 }; state < 100000; ++state) {
+        std::shuffle(liveCells.begin(), liveCells.end(), random);
+        std::vector<int> boxes(liveCells.begin(), liveCells.begin() + 20);
+        std::sort(boxes.begin(), boxes.end());
+        const auto player = floorCells[random() % floorCells.size()];
+
+        records.resize(records.size() + codec.bytes());
+        auto* const record = records.data() + records.size() - codec.bytes();
+        codec.encode(boxes, player, record);
+        codec.decode(record, decodedBoxes, decodedPlayer);
+        BOOST_REQUIRE(decodedBoxes == boxes);
+        BOOST_REQUIRE_EQUAL(decodedPlayer, player);
+        set.insert(record);
+    }
+
+    BOOST_REQUIRE_GT(set.size(), 99000u);
+    BOOST_REQUIRE_LT(static_cast<double>(set.bytes()) / set.size(), 16.0);
+    for (size_t offset{ 0 }; offset < records.size(); offset += codec.bytes()) {
+        BOOST_REQUIRE(set.contains(records.data() + offset));
+        BOOST_REQUIRE(!set.insert(records.data() + offset));
+    }
+
+    // The border is no floor
+    std::vector<int> boxes(liveCells.begin(), liveCells.begin() + 20);
+    std::sort(boxes.begin(), boxes.end());
+    boxes[0] = 0;
+    std::vector<uint8_t> record(codec.bytes());
+    BOOST_REQUIRE_THROW(codec.encode(boxes, floorCells[0], record.data()), std::invalid_argument);
+}
+
+// Tests if the deadlock table finds two boxes frozen side by side against a wall, and no deadlock
+// around a box that can still be pushed.
+BOOST_AUTO_TEST_CASE(testDeadlockTable) {
+    const TempFile file{ "deadlock.tbl" };
+    const auto& filename = file.path();
+    BOOST_REQUIRE(SB::SokobanDeadlockTable::saveToFile(filename));
+
+    SB::SokobanDeadlockTable table;
+    BOOST_REQUIRE(table.loadFromFile(filename));
+
+    // #####
+    // #.AA#
+    // #..a#
+    // #A.@#
+    // #####
+    std::vector<SB::TileChar> tileCharGrid(25, SB::TileChar::Wall);
+    for (const auto index : { 6, 11, 12, 17 }) {
+        tileCharGrid[index] = SB::TileChar::Empty;
+    }
+    tileCharGrid[7] = SB::TileChar::Box;
+    tileCharGrid[8] = SB::TileChar::Box;
+    tileCharGrid[13] = SB::TileChar::Storage;
+    tileCharGrid[16] = SB::TileChar::Box;
+    tileCharGrid[18] = SB::TileChar::Player;
+    const SB::SokobanLevel level{ 5, 5, tileCharGrid };
+    const auto isBox = [&](const int index) {
+        if (level.isWall(index)) {
+            return false;
+        }
+
+        const auto coordinate = level.toCoordinate(index);
+        const auto tileChar = tileCharGrid[coordinate.x + coordinate.y * 5];
+        return tileChar == SB::TileChar::Box;
+    };
+
+    BOOST_REQUIRE_EQUAL(table.frozenBoxCount(level, level.toIndex({ 3, 1 }), isBox), 2);
+    BOOST_REQUIRE_EQUAL(table.frozenBoxCount(level, level.toIndex({ 1, 3 }), isBox), 1);
+}
+
+// Tests if a box frozen in a corner keeps the game deadlocked while another box is pushed onto a
+// storage, and if undoing the push that froze it, or jumping back past it, clears the deadlock.
+BOOST_AUTO_TEST_CASE(testFreezeDeadlock) {
+    const TempFile table{ "deadlock.tbl" };
+    BOOST_REQUIRE(SB::SokobanDeadlockTable::saveToFile(table.path()));
+    SB::SokobanLevel level;
+    std::istringstream{ "5 6\n"
+        "######\n"
+        "#.A@a#\n"
+        "#....#\n"
+        "#..Aa#\n"
+        "######\n" } >> level;
+    SB::Sokoban sokoban;
+    BOOST_REQUIRE(sokoban.loadDeadlockTable(table.path()));
+    sokoban.load(level, SB::SokobanLowerBound{ level });
+    BOOST_REQUIRE(!sokoban.isDeadlocked());
+
+    sokoban.movePlayer(SB::Direction::Left);
+    BOOST_REQUIRE(sokoban.isDeadlocked());
+
+    sokoban.movePlayer(SB::Direction::Down);
+    sokoban.movePlayer(SB::Direction::Down);
+    sokoban.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE(sokoban.getTileChar({ 4, 3 }) == SB::TileChar::BoxStorage);
+    BOOST_REQUIRE(sokoban.isDeadlocked());
+    const auto pushed = sokoban.undoTree().current();
+
+    sokoban.jumpTo(SB::SokobanUndoTree::ROOT);
+    BOOST_REQUIRE(!sokoban.isDeadlocked());
+    sokoban.jumpTo(pushed);
+    BOOST_REQUIRE(sokoban.isDeadlocked());
+
+    sokoban.undo();
+    BOOST_REQUIRE(sokoban.isDeadlocked());
+
+    sokoban.undo();
+    sokoban.undo();
+    sokoban.undo();
+    BOOST_REQUIRE(!sokoban.isDeadlocked());
+}
+
+// Tests if a generated level can be read back by `operator>>` and is won by replaying its solution
+// through `movePlayer(SB::Direction)`, and if generation is deterministic per seed.
+BOOST_AUTO_TEST_CASE(testLevelGenerator) {
+    const SB::SokobanLevelGenerator generator;
+    const auto level = generator.generate(42);
+    BOOST_REQUIRE(level.has_value());
+    BOOST_REQUIRE_EQUAL(generator.generate(42)->solution, level->solution);
+
+    const TempFile file{ "generated.lvl" };
+    const auto& filename = file.path();
+    std::ofstream{ filename } << *level;
+    SB::Sokoban sokoban{ filename };
+
+    BOOST_REQUIRE_EQUAL(sokoban.width(), level->width);
+    BOOST_REQUIRE(!sokoban.isWon());
+
+    for (const auto direction : SB::parseLurd(level->solution)) {
+        sokoban.movePlayer(direction);
+    }
+
+    BOOST_REQUIRE(sokoban.isWon());
+}
+
+// Tests if a push through a tunnel is collapsed into one macro push, and if the expanded solution
+// still wins the level.
+BOOST_AUTO_TEST_CASE(testSolverTunnel) {
+    const std::string levelText{ "3 12\n############\n#@A.......a#\n############\n" };
+
+    auto isWon = false;
+    const auto withMacros = solveAndReplay(levelText, {}, isWon);
+    BOOST_REQUIRE(withMacros.isSolved);
+    BOOST_REQUIRE(isWon);
+    BOOST_REQUIRE_EQUAL(withMacros.pushes, 8);
+
+    SB::SolverOptions options;
+    options.useMacros = false;
+    const auto withoutMacros = solveAndReplay(levelText, options, isWon);
+    BOOST_REQUIRE(withoutMacros.isSolved);
+    BOOST_REQUIRE(isWon);
+    BOOST_REQUIRE_LT(withMacros.expandedNodes, withoutMacros.expandedNodes);
+}
+
+// Tests if a goal room behind a corridor is found and filled through its macro.
+BOOST_AUTO_TEST_CASE(testSolverGoalRoom) {
+    SB::SokobanLevel level;
+    std::istringstream{ GOAL_ROOM_LEVEL } >> level;
+    BOOST_REQUIRE_EQUAL(SB::SokobanMacros{ level }.goalRoomCount(), 1);
+
+    auto isWon = false;
+    const auto result = solveAndReplay(GOAL_ROOM_LEVEL, {}, isWon);
+    BOOST_REQUIRE(result.isSolved);
+    BOOST_REQUIRE(isWon);
+}
+
+// Tests if the transposition table reports a state visited at no greater depth as a hit, keeps its
+// payload, and counts hits, misses and collisions.
+BOOST_AUTO_TEST_CASE(testTranspositionTable) {
+    SB::SokobanTranspositionTable table{ 1 << 16 };
+    BOOST_REQUIRE_EQUAL(table.capacity(), 4096);
+
+    BOOST_REQUIRE(!table.probe(42, { 7, 13, SB::Direction::Left, 1 }));
+    BOOST_REQUIRE(table.probe(42, { 7, 0, SB::Direction::Up, 0 }));
+    BOOST_REQUIRE(table.probe(42, { 9, 0, SB::Direction::Up, 0 }));
+    BOOST_REQUIRE(!table.probe(42, { 5, 14, SB::Direction::Right, 2 }));
+
+    SB::TranspositionEntry entry;
+    BOOST_REQUIRE(table.find(42, entry));
+    BOOST_REQUIRE_EQUAL(entry.depth, 5);
+    BOOST_REQUIRE_EQUAL(entry.moveCell, 14);
+    BOOST_REQUIRE(entry.moveDirection == SB::Direction::Right);
+    BOOST_REQUIRE_EQUAL(entry.flags, 2);
+    BOOST_REQUIRE(!table.find(43, entry));
+
+    // Five keys in one bucket of four: the shallowest entry makes room
+    const uint64_t bucketStride{ 1024 };
+    for (uint64_t i{ 1 }; i <= 5; ++i) {
+        BOOST_REQUIRE(!table.probe(i * bucketStride, { static_cast<int>(10 - i), -1,
+            SB::Direction::Up, 0 }));
+    }
+    BOOST_REQUIRE(table.find(1 * bucketStride, entry));
+    BOOST_REQUIRE(!table.find(4 * bucketStride, entry));
+    BOOST_REQUIRE(table.find(5 * bucketStride, entry));
+
+    const auto stats = table.stats();
+    BOOST_REQUIRE_EQUAL(stats.hits, 2);
+    BOOST_REQUIRE_EQUAL(stats.misses, 7);
+    BOOST_REQUIRE_EQUAL(stats.collisions, 1);
+}
+
+// Tests if states stored concurrently by several threads are all found afterwards.
+BOOST_AUTO_TEST_CASE(testTranspositionTableThreads) {
+    SB::SokobanTranspositionTable table{ 1 << 20 };
+    constexpr int threadCount = 4;
+    constexpr int keysPerThread = 2000;
+
+    std::vector<std::thread> threads;
+    for (int thread{ 0 }; thread < threadCount; ++thread) {
+        threads.emplace_back([&table, thread]() {
+            for (int i{ 0 }; i < keysPerThread; ++i) {
+                const auto key = SB::boxHash(thread * keysPerThread + i);
+                table.probe(key, { i % 100, i, SB::Direction::Down, 0 });
+                table.probe(key, { i % 100, i, SB::Direction::Down, 0 });
+            }
+            });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto found = 0;
+    SB::TranspositionEntry entry;
+    for (int i{ 0 }; i < threadCount * keysPerThread; ++i) {
+        found += table.find(SB::boxHash(i), entry) && entry.moveCell == i % keysPerThread ? 1 : 0;
+    }
+    BOOST_REQUIRE_GE(found, threadCount * keysPerThread * 99 / 100);
+    BOOST_REQUIRE_EQUAL(table.stats().hits + table.stats().misses, 2u * threadCount * keysPerThread);
+}
+
+// Tests if a search on several threads sharing a transposition table finds a winning solution.
+BOOST_AUTO_TEST_CASE(testSolverThreads) {
+    SB::SolverOptions options;
+    options.threads = 4;
+    options.tableBytes = 1 << 20;
+    auto isWon = false;
+    const auto result = solveAndReplay(GOAL_ROOM_LEVEL, options, isWon);
+    BOOST_REQUIRE(result.isSolved);
+    BOOST_REQUIRE(isWon);
+    BOOST_REQUIRE_GT(result.transpositions.misses, 0u);
+}
+
+// Tests if every strategy solves a level alone, and if a portfolio of them crowns one winner and
+// stops the rest.
+BOOST_AUTO_TEST_CASE(testSolverPortfolio) {
+    const std::vector<SB::Strategy> strategies{ SB::Strategy::AStar, SB::Strategy::BreadthFirst,
+        SB::Strategy::GreedyBestFirst, SB::Strategy::IdaStar };
+
+    SB::SolverOptions options;
+    options.tableBytes = 1 << 20;
+    for (const auto strategy : strategies) {
+        options.strategy = strategy;
+        auto isWon = false;
+        const auto result = solveAndReplay(GOAL_ROOM_LEVEL, options, isWon);
+        BOOST_REQUIRE(result.isSolved);
+        BOOST_REQUIRE(isWon);
+    }
+
+    options.portfolio = strategies;
+    auto isWon = false;
+    const auto result = solveAndReplay(GOAL_ROOM_LEVEL, options, isWon);
+    BOOST_REQUIRE(result.isSolved);
+    BOOST_REQUIRE(isWon);
+    BOOST_REQUIRE_EQUAL(result.strategies.size(), strategies.size());
+    BOOST_REQUIRE_EQUAL(std::count_if(result.strategies.begin(), result.strategies.end(),
+        [](const SB::StrategyStats& stats) { return stats.isWinner; }), 1);
+}
+
+// Tests if following the hints of the background engine one step at a time wins a level, and if
+// a cancelled request never hands out a hint.
+BOOST_AUTO_TEST_CASE(testHintEngine) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+    SB::SokobanHintEngine hintEngine;
+    const auto waitForHint = [&](SB::Hint& hint) {
+        for (int wait{ 0 }; wait < 10000; ++wait) {
+            if (hintEngine.poll(hint)) {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    };
+
+    SB::Hint hint;
+    for (int step{ 0 }; step < 200 && !sokoban.isWon(); ++step) {
+        hintEngine.request(sokoban);
+        BOOST_REQUIRE(waitForHint(hint));
+        BOOST_REQUIRE(hint.isSolvable);
+        sokoban.movePlayer(hint.direction);
+    }
+    BOOST_REQUIRE(sokoban.isWon());
+
+    sokoban.reset();
+    hintEngine.request(sokoban);
+    hintEngine.cancel();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    BOOST_REQUIRE(!hintEngine.poll(hint));
+    BOOST_REQUIRE(!hintEngine.isSearching());
+}
+
+// Tests if a forward and a backward search meeting in the middle find a winning solution, with and
+// without macros in the forward half.
+BOOST_AUTO_TEST_CASE(testSolverBidirectional) {
+    SB::SolverOptions options;
+    options.bidirectional = true;
+    options.tableBytes = 1 << 20;
+    for (const auto useMacros : { true, false }) {
+        options.useMacros = useMacros;
+        auto isWon = false;
+        const auto result = solveAndReplay(GOAL_ROOM_LEVEL, options, isWon);
+        BOOST_REQUIRE(result.isSolved);
+        BOOST_REQUIRE(isWon);
+    }
+}
+
+// Tests if a state file reads back the records written to it, without the repeated ones.
+BOOST_AUTO_TEST_CASE(testStateFile) {
+    const TempFile file{ "states.bin" };
+    const auto& filename = file.path();
+    const std::vector<std::vector<int>> records{ { 3, 9, 40 }, { 3, 9, 40 }, { 3, 12, 7 },
+                                                 { 200, 300, 100000 } };
+    {
+        SB::SokobanStateFileWriter writer{ filename, 3 };
+        for (const auto& record : records) {
+            writer.write(record.data());
+        }
+        writer.close();
+        BOOST_REQUIRE_EQUAL(writer.records(), 3u);
+    }
+
+    SB::SokobanStateFileReader reader{ filename, 3 };
+    for (const auto index : { 0, 2, 3 }) {
+        BOOST_REQUIRE(reader.next());
+        BOOST_REQUIRE(std::equal(records[index].begin(), records[index].end(), reader.record()));
+    }
+    BOOST_REQUIRE(!reader.next());
+}
+
+// Tests if the external-memory search finds a winning solution with the fewest pushes when its
+// budget is so small that every successor is spilled and the runs take several merge passes.
+BOOST_AUTO_TEST_CASE(testSolverExternalMemory) {
+    SB::SolverOptions options;
+    options.externalMemory = true;
+    options.memoryBytes = 0;
+    options.useMacros = false;
+    auto isWon = false;
+    const auto result = solveAndReplay(GOAL_ROOM_LEVEL, options, isWon);
+    BOOST_REQUIRE(result.isSolved);
+    BOOST_REQUIRE(isWon);
+    BOOST_REQUIRE_EQUAL(result.external.layers, result.pushes);
+    BOOST_REQUIRE_GT(result.external.statesMerged, result.external.statesWritten);
+    BOOST_REQUIRE_GT(result.external.bytesRead, 0u);
+}
+
+// Tests if the optimizer removes detours from a solution under both objectives, and if the result
+// still wins the level.
+BOOST_AUTO_TEST_CASE(testOptimizer) {
+    const std::string levelText{ "7 7\n"
+        "#######\n"
+        "#@....#\n"
+        "#.....#\n"
+        "#..A.a#\n"
+        "#.....#\n"
+        "#.....#\n"
+        "#######\n" };
+    SB::SokobanLevel level;
+    std::istringstream{ levelText } >> level;
+
+    // Pushes the box down and back up on the way; the best solution is "ddrRR"
+    const std::string solution{ "ddrRurDlddrUluRud" };
+    SB::OptimizerOptions options;
+    options.threads = 2;
+    for (const auto objective : { SB::Objective::Moves, SB::Objective::Pushes }) {
+        options.objective = objective;
+        const auto result = SB::SokobanOptimizer{ options }.optimize(level, solution);
+        BOOST_REQUIRE_EQUAL(result.movesBefore, 17);
+        BOOST_REQUIRE_EQUAL(result.pushesBefore, 4);
+        BOOST_REQUIRE_EQUAL(result.moves, 5);
+        BOOST_REQUIRE_EQUAL(result.pushes, 2);
+
+        const TempFile file{ "optimizer.lvl" };
+        const auto& filename = file.path();
+        std::ofstream{ filename } << levelText;
+        SB::Sokoban sokoban{ filename };
+        for (const auto direction : SB::parseLurd(result.solution)) {
+            sokoban.movePlayer(direction);
+        }
+        BOOST_REQUIRE(sokoban.isWon());
+    }
+
+    BOOST_REQUIRE_THROW(SB::SokobanOptimizer{}.optimize(level, "ddrR"), std::invalid_argument);
+
+    // Measuring replays the solution, so the case of its moves doesn't change the counts
+    const auto measured = SB::SokobanOptimizer::measure(level, "ddrrurdlddruluRud");
+    BOOST_REQUIRE_EQUAL(measured.movesBefore, 17);
+    BOOST_REQUIRE_EQUAL(measured.pushesBefore, 4);
+    BOOST_REQUIRE_THROW(static_cast<void>(SB::SokobanOptimizer::measure(level, "ddrR")),
+        std::invalid_argument);
+}
+
+// Tests if moving, pushing, undoing, jumping and resetting allocate nothing from the heap once the
+// level's arena has grown to its working size, and if loading another level reuses the game.
+BOOST_AUTO_TEST_CASE(testSteadyStateAllocations) {
+    const TempFile file{ "arena.lvl" };
+    const auto& filename = file.path();
+    std::ofstream{ filename } << "6 7\n"
+        "#######\n"
+        "#@....#\n"
+        "#.A.a.#\n"
+        "#.....#\n"
+        "#.A.a.#\n"
+        "#######\n";
+    SB::Sokoban sokoban{ filename };
+
+    // Let the asset workers finish, or their allocations would be counted too
+    SB::SokobanAssets::instance().wait();
+
+    const auto moves = SB::parseLurd("drRRllddrRRu");
+    const auto branch = SB::parseLurd("uuL");
+    const auto play = [&]() {
+        for (const auto direction : moves) {
+            sokoban.movePlayer(direction);
+        }
+        for (int i{ 0 }; i < 4; ++i) {
+            sokoban.undo();
+        }
+        for (const auto direction : branch) {
+            sokoban.movePlayer(direction);
+        }
+        sokoban.jumpTo(sokoban.undoTree().size() - 1);
+        sokoban.update(1000);
+        sokoban.reset();
+    };
+
+    // The first round grows the history and the pools to their working size
+    play();
+    allocationCount = 0;
+    isCountingAllocations = true;
+    for (int round{ 0 }; round < 3; ++round) {
+        play();
+    }
+    isCountingAllocations = false;
+    BOOST_REQUIRE_EQUAL(allocationCount.load(), 0);
+
+    std::ofstream{ filename } << "3 6\n######\n#@Aa.#\n######\n";
+    std::ifstream{ filename } >> sokoban;
+    BOOST_REQUIRE_EQUAL(sokoban.width(), 6);
+    BOOST_REQUIRE_EQUAL(sokoban.undoTree().size(), 1);
+    sokoban.movePlayer(SB::Direction::Right);
+    BOOST_REQUIRE(sokoban.isWon());
+}
+
+// Tests if disabled audio loads nothing
+BOOST_AUTO_TEST_CASE(testAudioDisabled) {
+    auto& audio = SB::SokobanAudio::instance();
+    BOOST_REQUIRE(!audio.isEnabled());
+
+    isCountingAllocations = true;
+    allocationCount = 0;
+    audio.playMusic(SB::SOUND_BACKGROUND_FILENAMES);
+    audio.playEffect(SB::SOUND_WIN);
+    audio.stopMusic();
+    isCountingAllocations = false;
+    BOOST_REQUIRE_EQUAL(allocationCount.load(), 0);
+
+    audio.setEnabled(true);
+    BOOST_REQUIRE(audio.isEnabled());
+    audio.setEnabled(false);
+}
+
+// Tests if assets are handed out at once, shared, and keep their placeholders when loading fails
+BOOST_AUTO_TEST_CASE(testAssetsLoadInBackground) {
+    auto& assets = SB::SokobanAssets::instance();
+    const auto texture = assets.texture("missing_texture.png", sf::Color::Red);
+    const auto font = assets.font("missing_font.ttf");
+    BOOST_REQUIRE(texture != nullptr);
+    BOOST_REQUIRE(font != nullptr);
+    BOOST_REQUIRE(assets.texture("missing_texture.png", sf::Color::Blue) == texture);
+    BOOST_REQUIRE(assets.font("missing_font.ttf") == font);
+
+    assets.wait();
+    BOOST_REQUIRE(assets.isReady());
+    BOOST_REQUIRE_EQUAL(assets.update(), 0);
+    BOOST_REQUIRE(assets.texture("missing_texture.png", sf::Color::Red) == texture);
+}
+
+// Tests if the grid view addresses cells, rows and neighbors in row-major order
+BOOST_AUTO_TEST_CASE(testGridView) {
+    std::vector<int> cells(12);
+    for (int i{ 0 }; i < 12; ++i) {
+        cells[i] = i;
+    }
+    const SB::SokobanGridView<int> view{ cells.data(), 4, 3 };
+    BOOST_REQUIRE_EQUAL(view.size(), 12);
+    BOOST_REQUIRE_EQUAL(view[sf::Vector2i(1, 2)], 9);
+    BOOST_REQUIRE_EQUAL(view.index({ 3, 1 }), 7);
+    BOOST_REQUIRE(view.coordinate(7) == sf::Vector2i(3, 1));
+    BOOST_REQUIRE(view.contains({ 3, 2 }));
+    BOOST_REQUIRE(!view.contains({ 4, 0 }));
+    BOOST_REQUIRE(!view.contains({ 0, -1 }));
+    BOOST_REQUIRE_EQUAL(view.neighbor(5, SB::Direction::Up), 1);
+    BOOST_REQUIRE_EQUAL(view.neighbor(5, SB::Direction::Down), 9);
+    BOOST_REQUIRE_EQUAL(view.neighbor(5, SB::Direction::Left), 4);
+    BOOST_REQUIRE_EQUAL(view.neighbor(5, SB::Direction::Right), 6);
+
+    const auto row = view.row(1);
+    BOOST_REQUIRE_EQUAL(row.size(), 4u);
+    BOOST_REQUIRE_EQUAL(row.front(), 4);
+    row[0] = 40;
+    BOOST_REQUIRE_EQUAL(cells[4], 40);
+
+    int visited{ 0 };
+    view.forEachCell([&](const sf::Vector2i coordinate, const int cell) {
+        BOOST_REQUIRE_EQUAL(view.index(coordinate), visited == 4 ? 4 : cell);
+        ++visited;
+        });
+    BOOST_REQUIRE_EQUAL(visited, 12);
+}
+
+// Tests if the player and boxes stop at the edge of a level that has no walls around it
+BOOST_AUTO_TEST_CASE(testMoveAtOpenEdge) {
+    const TempFile file{ "open_edge.lvl" };
+    const auto& filename = file.path();
+    std::ofstream{ filename } << "3 3\n.@.\n.A.\n.a.\n";
+    SB::Sokoban sokoban{ filename };
+
+    sokoban.movePlayer(SB::Direction::Up);
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 1, 0 }));
+    sokoban.movePlayer(SB::Direction::Left);
+    sokoban.movePlayer(SB::Direction::Left);
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 0, 0 }));
+
+    // Push the box onto the left edge, where it can't go further
+    for (const auto direction : { SB::Direction::Right, SB::Direction::Right, SB::Direction::Down,
+                                  SB::Direction::Left, SB::Direction::Left }) {
+        sokoban.movePlayer(direction);
+    }
+    BOOST_REQUIRE(isCoordinateEqual(sokoban.playerLoc(), { 1, 1 }));
+    BOOST_REQUIRE(sokoban.getTileChar({ 0, 1 }) == SB::TileChar::Box);
+    BOOST_REQUIRE_THROW(static_cast<void>(sokoban.getTileChar({ -1, 1 })),
+        SB::InvalidCoordinateException);
+    BOOST_REQUIRE_THROW(static_cast<void>(sokoban.getTileChar({ 3, 0 })),
+        SB::InvalidCoordinateException);
+
+    // Undo the push and push the box down onto the storage instead
+    sokoban.undo();
+    BOOST_REQUIRE(sokoban.getTileChar({ 1, 1 }) == SB::TileChar::Box);
+    for (const auto direction : { SB::Direction::Up, SB::Direction::Left, SB::Direction::Down }) {
+        sokoban.movePlayer(direction);
+    }
+    BOOST_REQUIRE(sokoban.isWon());
+}
+
+// Tests if the terminal renderer sends the whole screen once, then only the tiles that change
+BOOST_AUTO_TEST_CASE(testTerminalDiffRedraw) {
+    const TempFile file{ "terminal.lvl" };
+    const auto& filename = file.path();
+    std::ofstream{ filename } << "3 5\n#####\n#@Aa#\n#####\n";
+    SB::Sokoban sokoban{ filename };
+
+    std::ostringstream output;
+    SB::SokobanTerminal terminal{ output, 20, 5 };
+    const auto first = terminal.render(sokoban);
+    BOOST_REQUIRE(output.str().find("\x1b[2J") != std::string::npos);
+    BOOST_REQUIRE(output.str().find("#@A") != std::string::npos);
+
+    // Nothing changed: nothing is sent
+    BOOST_REQUIRE_EQUAL(terminal.render(sokoban), 0u);
+
+    // The push changes three cells in one run, and the status line
+    output.str("");
+    sokoban.movePlayer(SB::Direction::Right);
+    const auto second = terminal.render(sokoban);
+    BOOST_REQUIRE_LT(second, first);
+    BOOST_REQUIRE_EQUAL(output.str().substr(0, 9), "\x1b[2;2H @1");
+    BOOST_REQUIRE(output.str().find("Solved!") != std::string::npos);
+
+    // The window follows the player across a board larger than the screen
+    std::ofstream{ filename } << "1 40\n@.....................................Aa\n";
+    SB::Sokoban wide{ filename };
+    SB::SokobanTerminal narrow{ output, 10, 3 };
+    static_cast<void>(narrow.render(wide));
+    for (int i{ 0 }; i < 30; ++i) {
+        wide.movePlayer(SB::Direction::Right);
+        static_cast<void>(narrow.render(wide));
+    }
+    BOOST_REQUIRE_GT(narrow.origin().x, 20);
+    BOOST_REQUIRE_LE(narrow.origin().x, 30);
+}
+
+// Tests if boards stepped in a batch follow the same rules and score as the game, and if the
+// observations written one change at a time match those written in full.
+BOOST_AUTO_TEST_CASE(testBatchEnv) {
+    const TempFile file{ "batch.lvl" };
+    const auto& filename = file.path();
+    std::ofstream{ filename } << "5 7\n#######\n#@.A.a#\n#.A...#\n#..a..#\n#######\n";
+    SB::SokobanLevel level;
+    std::ifstream{ filename } >> level;
+    SB::Sokoban sokoban{ filename };
+
+    // Every board takes the same actions as the game, the boards split between two threads
+    constexpr int count = 3;
+    SB::SokobanBatchEnv env{ level, count, 2, 1 };
+    BOOST_REQUIRE_EQUAL(env.threadCount(), 2u);
+    std::vector<uint8_t> actions(count);
+    std::vector<float> rewards(count);
+    std::vector<uint8_t> dones(count);
+    std::vector<uint8_t> observations(count * env.observationSize());
+    std::vector<uint8_t> expected(observations.size());
+    env.observe(observations.data());
+
+    // The game's score is the number of boxes on storages
+    const auto score = [&sokoban] {
+        auto boxStorageCount = 0;
+        sokoban.tileCharView().forEachCell([&](const sf::Vector2i, const SB::TileChar tileChar) {
+            boxStorageCount += tileChar == SB::TileChar::BoxStorage;
+            });
+        return boxStorageCount;
+    };
+
+    const std::string moves{ "ulrRRlllldRurDr" };
+    for (const auto direction : SB::parseLurd(moves)) {
+        const auto scoreBefore = score();
+        sokoban.movePlayer(direction);
+        std::fill(actions.begin(), actions.end(), static_cast<uint8_t>(direction));
+        env.step(actions.data(), rewards.data(), dones.data(), observations.data());
+
+        for (int board{ 0 }; board < count; ++board) {
+            BOOST_REQUIRE_EQUAL(env.player(board), level.toIndex(sf::Vector2i(sokoban.playerLoc())));
+            BOOST_REQUIRE_EQUAL(rewards[board], static_cast<float>(score() - scoreBefore));
+            BOOST_REQUIRE_EQUAL(dones[board] != 0, sokoban.isWon());
+        }
+        env.observe(expected.data());
+        BOOST_REQUIRE(observations == expected);
+        env.step(std::vector<uint8_t>(count, 4).data(), rewards.data(), dones.data(),
+            observations.data());
+    }
+    BOOST_REQUIRE(sokoban.isWon());
+    BOOST_REQUIRE(env.isDone(0));
+
+    env.reset(1);
+    BOOST_REQUIRE(!env.isDone(1));
+    BOOST_REQUIRE_EQUAL(env.player(1), level.initialPlayer());
+}
+
+// Tests if the mirrored and rotated images of a level, padded with floor the player can't reach,
+// share a canonical hash, and if a solution of the canonical level plays each image.
+BOOST_AUTO_TEST_CASE(testCanonicalLevel) {
+    const std::vector<std::string> images{
+        "4 6\n######\n#@A.a#\n#....#\n######\n",
+        // Mirrored left to right, with unreachable floor around it
+        "6 8\n........\n.######.\n.#a.A@#.\n.#....#.\n.######.\n........\n",
+        // Turned a quarter clockwise
+        "6 4\n####\n#.@#\n#.A#\n#..#\n#.a#\n####\n",
+    };
+    const std::string solution{ "RR" };
+
+    std::vector<SB::CanonicalLevel> canonicals;
+    for (const auto& text : images) {
+        SB::SokobanLevel level;
+        std::istringstream{ text } >> level;
+        canonicals.push_back(SB::canonicalize(level));
+    }
+    for (size_t i{ 1 }; i < canonicals.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(canonicals[i].hash, canonicals[0].hash);
+        BOOST_REQUIRE(canonicals[i].tileCharGrid == canonicals[0].tileCharGrid);
+    }
+
+    // Map the first image's solution into the canonical frame, then out into every image
+    const auto canonicalSolution = SB::transform(solution, canonicals[0].symmetry);
+    const TempFile file{ "canonical.lvl" };
+    const auto& filename = file.path();
+    for (size_t i{ 0 }; i < images.size(); ++i) {
+        std::ofstream{ filename } << images[i];
+        SB::Sokoban sokoban{ filename };
+        for (const auto direction :
+            SB::parseLurd(SB::transform(canonicalSolution, canonicals[i].symmetry, true))) {
+            sokoban.movePlayer(direction);
+        }
+        BOOST_REQUIRE(sokoban.isWon());
+    }
+}
+
+// Tests if the solution cache finds what was stored after reopening, through a grown index, a
+// deleted index and a record cut short, and if each kind of solution of a level has its own record.
+BOOST_AUTO_TEST_CASE(testSolutionCache) {
+    const TempFile file{ "cache.bin" };
+    const auto& filename = file.path();
+
+    constexpr uint64_t count = 1500;
+    {
+        SB::SokobanSolutionCache cache{ filename };
+        for (uint64_t hash{ 0 }; hash < count; ++hash) {
+            cache.store(hash * 0x9E3779B97F4A7C15ull, { std::string(hash % 7 + 1, 'r'),
+                static_cast<int>(hash % 7 + 1), 0, static_cast<int64_t>(hash), 0.5, 0 });
+        }
+        cache.store(0, { "RR", 2, 2, 9, 1.0, SB::CACHE_OPTIMIZED_MOVES });
+        BOOST_REQUIRE_EQUAL(cache.size(), count);
+    }
+
+    SB::CachedSolution cached;
+    for (const auto isIndexDeleted : { false, true }) {
+        if (isIndexDeleted) {
+            std::remove((filename + ".idx").c_str());
+        }
+        SB::SokobanSolutionCache cache{ filename };
+        BOOST_REQUIRE_EQUAL(cache.size(), count);
+        BOOST_REQUIRE(cache.find(5 * 0x9E3779B97F4A7C15ull, cached));
+        BOOST_REQUIRE_EQUAL(cached.solution, "rrrrrr");
+        BOOST_REQUIRE_EQUAL(cached.expandedNodes, 5);
+        BOOST_REQUIRE(cache.find(0, cached));
+        BOOST_REQUIRE_EQUAL(cached.solution, "RR");
+        BOOST_REQUIRE_EQUAL(cached.flags, SB::CACHE_OPTIMIZED_MOVES);
+        BOOST_REQUIRE(!cache.find(12345, cached));
+    }
+
+    // A store cut short by a crash is dropped, and the next store takes its place
+    {
+        std::ofstream{ filename, std::ios::binary | std::ios::app } << "partial";
+        std::remove((filename + ".idx").c_str());
+        SB::SokobanSolutionCache cache{ filename };
+        BOOST_REQUIRE_EQUAL(cache.size(), count);
+        cache.store(12345, { "u", 1, 0, 0, 0.0, 0 });
+    }
+    SB::SokobanSolutionCache cache{ filename };
+    BOOST_REQUIRE(cache.find(12345, cached));
+    BOOST_REQUIRE_EQUAL(cached.solution, "u");
+
+    // The optimizer's record of a level is kept apart from the solver's
+    cache.store(SB::cacheKey(12345, SB::CACHE_OPTIMIZED_MOVES),
+        { "r", 1, 0, 0, 0.0, SB::CACHE_OPTIMIZED_MOVES });
+    BOOST_REQUIRE(cache.find(SB::cacheKey(12345, 0), cached));
+    BOOST_REQUIRE_EQUAL(cached.solution, "u");
+    BOOST_REQUIRE(cache.find(SB::cacheKey(12345, SB::CACHE_OPTIMIZED_MOVES), cached));
+    BOOST_REQUIRE_EQUAL(cached.solution, "r");
+}
+
+// Tests if game events reach a telemetry log in order, and if a log rotated past its file count
+// keeps the newest events.
+BOOST_AUTO_TEST_CASE(testTelemetry) {
+    const TempFile file{ "telemetry.log" };
+    const auto& filename = file.path();
+    const auto readLog = [&] {
+        std::vector<SB::TelemetryEvent> events;
+        for (const auto& file : SB::telemetryFiles(filename)) {
+            SB::SokobanTelemetryReader reader{ file };
+            SB::TelemetryEvent event;
+            while (reader.next(event)) {
+                events.push_back(event);
+            }
+        }
+        return events;
+    };
+
+    {
+        SB::SokobanTelemetry telemetry{ filename };
+        SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+        sokoban.setTelemetry(&telemetry);
+        sokoban.movePlayer(SB::Direction::Up);
+        sokoban.undo();
+        sokoban.reset();
+        BOOST_REQUIRE_EQUAL(telemetry.recorded(), 3u);
+    }
+    auto events = readLog();
+    BOOST_REQUIRE_EQUAL(events.size(), 3u);
+    BOOST_REQUIRE(events[0].type == SB::TelemetryEventType::Move ||
+        events[0].type == SB::TelemetryEventType::Push);
+    BOOST_REQUIRE(events[1].type == SB::TelemetryEventType::Undo);
+    BOOST_REQUIRE(events[2].type == SB::TelemetryEventType::Reset);
+    BOOST_REQUIRE(events[0].direction == SB::Direction::Up);
+    file.clear();
+
+    // Ten events fit in a file and three files are kept, so the first ten of forty are lost
+    {
+        SB::SokobanTelemetry telemetry{ filename, 8 + 10 * sizeof(SB::TelemetryEvent), 3, 64 };
+        for (int i{ 0 }; i < 40; ++i) {
+            SB::TelemetryEvent event;
+            event.score = static_cast<int16_t>(i);
+            BOOST_REQUIRE(telemetry.record(event));
+            if (i % 8 == 7) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+    }
+    events = readLog();
+    BOOST_REQUIRE_EQUAL(SB::telemetryFiles(filename).size(), 3u);
+    BOOST_REQUIRE_EQUAL(events.size(), 30u);
+    for (size_t i{ 0 }; i < events.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(events[i].sequence, i + 10);
+        BOOST_REQUIRE_EQUAL(events[i].score, static_cast<int>(i + 10));
+    }
+    file.clear();
+
+    // A directory in the place of the log fails the reopen after the first event, and the events
+    // taken from the buffer after that count as dropped
+    {
+        SB::SokobanTelemetry telemetry{ filename, 8 + sizeof(SB::TelemetryEvent), 1, 64 };
+        std::filesystem::remove(filename);
+        std::filesystem::create_directories(filename + "/full");
+        for (int i{ 0 }; i < 5; ++i) {
+            BOOST_REQUIRE(telemetry.record({}));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        BOOST_REQUIRE_EQUAL(telemetry.written(), 1u);
+        BOOST_REQUIRE_EQUAL(telemetry.dropped(), 4u);
+    }
+    std::filesystem::remove_all(filename);
+
+    std::ofstream{ filename } << "not a log";
+    BOOST_REQUIRE_THROW(SB::SokobanTelemetry{ filename }, std::runtime_error);
+    BOOST_REQUIRE_THROW(SB::SokobanTelemetryReader{ filename }, std::runtime_error);
+    file.clear();
+}
+
+// Tests if a replay seeks, steps and plays to the same positions as playing its moves in order, and
+// if a game restored to those positions matches the game that played them.
+BOOST_AUTO_TEST_CASE(testReplay) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+    std::mt19937 random{ 48 };
+
+    // Wander, taking back any push the level can't be solved after, then solve it from there,
+    // remembering every position. The moves go on past the win, and the replay must drop them as
+    // the game does.
+    const SB::SokobanSolver solver{ sokoban.level() };
+    std::vector<SB::Direction> moves;
+    std::vector<SB::SearchState> states{ sokoban.searchState() };
+    for (int i{ 0 }; i < 2000 && !sokoban.isWon(); ++i) {
+        const auto direction = static_cast<SB::Direction>(random() % 4);
+        sokoban.movePlayer(direction);
+        const auto state = sokoban.searchState();
+        if (state.boxes != states.back().boxes && !solver.solve(state).isSolved) {
+            sokoban.undo();
+            continue;
+        }
+        moves.push_back(direction);
+        states.push_back(state);
+    }
+    const auto result = solver.solve(sokoban.searchState());
+    BOOST_REQUIRE(result.isSolved);
+    for (const auto direction : SB::parseLurd(result.solution)) {
+        moves.push_back(direction);
+        sokoban.movePlayer(direction);
+        states.push_back(sokoban.searchState());
+    }
+    BOOST_REQUIRE(sokoban.isWon());
+    for (int i{ 0 }; i < 100; ++i) {
+        moves.push_back(static_cast<SB::Direction>(random() % 4));
+    }
+
+    SB::SokobanReplay replay{ sokoban.level(), moves, 64 };
+    BOOST_REQUIRE_EQUAL(replay.size(), static_cast<int>(states.size()) - 1);
+    const auto requireAt = [&](const int position) {
+        BOOST_REQUIRE_EQUAL(replay.position(), position);
+        const auto state = replay.state();
+        BOOST_REQUIRE(state.boxes == states[position].boxes);
+        BOOST_REQUIRE_EQUAL(state.player, states[position].player);
+    };
+
+    for (int i{ 0 }; i < 500; ++i) {
+        const auto position = static_cast<int>(random() % states.size());
+        replay.seek(position);
+        requireAt(position);
+    }
+    replay.seek(replay.size());
+    for (auto position{ replay.size() }; position > 0; --position) {
+        replay.stepBackward();
+        requireAt(position - 1);
+    }
+    replay.stepBackward();
+    requireAt(0);
+
+    // 100 moves per second for half a second, then back at twice the speed until the start
+    replay.setSpeed(100.0);
+    replay.setPlaying(true);
+    replay.update(500000);
+    requireAt(std::min(50, replay.size()));
+    replay.setSpeed(-200.0);
+    replay.update(1000000);
+    requireAt(0);
+    BOOST_REQUIRE(!replay.isPlaying());
+
+    const auto position = replay.size() / 2;
+    replay.seek(position);
+    sokoban.restore(replay.state());
+    const auto restored = sokoban.searchState();
+    BOOST_REQUIRE(restored.boxes == states[position].boxes);
+    BOOST_REQUIRE_EQUAL(restored.player, states[position].player);
+
+    BOOST_REQUIRE_THROW(SB::SokobanReplay(sokoban.level(), moves, 0), std::invalid_argument);
+}
+
+// Tests if a campaign plays its levels in order in one game, and if a level that fails to load
+// throws, without being read again, until it is skipped.
+BOOST_AUTO_TEST_CASE(testCampaign) {
+    // Levels are listed by absolute path or relative to the list, as the missing ones are
+    const TempFile levelFile{ "corridor.lvl", "3 5\n#####\n#@Aa#\n#####\n" };
+    const TempFile list{ "campaign.txt", "# A campaign\n\n" + levelFile.path() +
+        "\nmissing.lvl\n  " + std::filesystem::absolute("assets/level/level1.lvl").string() +
+        "\nmissing.lvl\n" };
+
+    SB::SokobanCampaign campaign{ SB::readLevelList(list.path()) };
+    BOOST_REQUIRE_EQUAL(campaign.size(), 4);
+    BOOST_REQUIRE_EQUAL(campaign.index(), -1);
+
+    SB::Sokoban sokoban;
+    campaign.start(sokoban);
+    BOOST_REQUIRE_EQUAL(campaign.index(), 0);
+    BOOST_REQUIRE_EQUAL(sokoban.width(), 5);
+    sokoban.movePlayer(SB::Direction::Right);
+    sokoban.update(0);
+    BOOST_REQUIRE(sokoban.isWon());
+
+    BOOST_REQUIRE_THROW(campaign.advance(sokoban), std::invalid_argument);
+    BOOST_REQUIRE_THROW(campaign.advance(sokoban), std::invalid_argument);
+    BOOST_REQUIRE_EQUAL(campaign.index(), 0);
+    BOOST_REQUIRE_EQUAL(campaign.nextIndex(), 1);
+    BOOST_REQUIRE(campaign.isNextReady());
+    BOOST_REQUIRE(sokoban.isWon());
+
+    BOOST_REQUIRE(campaign.skip());
+    BOOST_REQUIRE(campaign.advance(sokoban));
+    BOOST_REQUIRE_EQUAL(campaign.index(), 2);
+    BOOST_REQUIRE_EQUAL(sokoban.width(), 10);
+    BOOST_REQUIRE(!sokoban.isWon());
+    BOOST_REQUIRE(sokoban.searchState().boxes == sokoban.level().initialBoxes());
+
+    BOOST_REQUIRE_THROW(campaign.advance(sokoban), std::invalid_argument);
+    BOOST_REQUIRE(!campaign.skip());
+    BOOST_REQUIRE(!campaign.isNextReady());
+    BOOST_REQUIRE(!campaign.advance(sokoban));
+    BOOST_REQUIRE_EQUAL(campaign.index(), 2);
+    BOOST_REQUIRE_EQUAL(sokoban.width(), 10);
+
+    BOOST_REQUIRE_THROW(SB::SokobanCampaign{ {} }, std::invalid_argument);
+    BOOST_REQUIRE_THROW(SB::readLevelList(list.path() + ".missing"), std::invalid_argument);
+}
+
+// Tests if every push the push graph lists can be walked to and made in the game, landing on the
+// position the graph says it does, and if pushes not listed are refused.
+BOOST_AUTO_TEST_CASE(testPushGraph) {
+    SB::Sokoban sokoban{ "assets/level/level1.lvl" };
+    SB::SokobanPushGraph graph{ sokoban.level() };
+    std::mt19937 random{ 50 };
+
+    auto state = sokoban.searchState();
+    for (int step{ 0 }; step < 200 && !graph.isSolved(state); ++step) {
+        const auto pushes = graph.pushes(state);
+        if (pushes.empty()) {
+            sokoban.reset();
+            state = sokoban.searchState();
+            continue;
+        }
+
+        // Pushes from the same area of the player are the same whatever cell the player is on
+        const auto normalizedPlayer = graph.normalizedPlayer(state);
+        BOOST_REQUIRE(graph.pushes({ state.boxes, normalizedPlayer }).size() == pushes.size());
+
+        const auto& push = pushes[random() % pushes.size()];
+        for (const auto direction : graph.walk(state, push)) {
+            sokoban.movePlayer(direction);
+        }
+        state = graph.apply(state, push);
+        const auto played = sokoban.searchState();
+        BOOST_REQUIRE(played.boxes == state.boxes);
+        BOOST_REQUIRE_EQUAL(played.player, state.player);
+    }
+
+    const auto& level = sokoban.level();
+    const auto box = state.boxes.front();
+    const auto up = level.offset(SB::Direction::Up);
+    for (const auto direction : SB::SokobanLevel::DIRECTIONS) {
+        const SB::Push push{ box, direction, box + level.offset(direction) };
+        const auto pushes = graph.pushes(state);
+        const auto isListed = std::any_of(pushes.begin(), pushes.end(), [&](const SB::Push& other) {
+            return other.box == push.box && other.direction == push.direction;
+        });
+        if (!isListed) {
+            BOOST_REQUIRE_THROW(static_cast<void>(graph.walk(state, push)), std::invalid_argument);
+        }
+    }
+    BOOST_REQUIRE_THROW(static_cast<void>(graph.apply(state, { box + up, SB::Direction::Up,
+        box })), std::invalid_argument);
+}